@@ -0,0 +1,101 @@
+#include <Actuator.h>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+
+/*
+ * Measures the time the planner thread spends handing clicks to the actuator, compared with sending them itself as
+ * the planner used to, and how long the commands wait in the queue before their batch is sent. SendInput is stood in
+ * for by a recording actuator that takes a fixed time per batch.
+ *
+ * Usage: ActuatorBench [batch microseconds]
+ */
+
+static const int NUM_TICKS = 2000;
+// The planner used to send a move, a button down and a button up with one SendInput call each, then poll the cursor
+static const int CALLS_PER_BLOCKING_CLICK = 3;
+static const int64_t CURSOR_POLL_NANOS = 10000000;
+
+/**
+ * @internal
+ * Returns the current steady clock time in nanoseconds.
+ */
+static int64_t NowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char **argv) {
+    int64_t batchNanos = argc > 1 ? std::stoll(argv[1]) * 1000 : 300000;
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<int> burst(1, 3);
+    std::uniform_int_distribution<int> position(0, 1920);
+    RecordingActuator actuator(batchNanos);
+    LatencyHistogram submitTime;
+    actuator.Start();
+
+    // The game takes a clicked item off the conveyor a little after the click reaches it
+    std::atomic<bool> confirming{true};
+    size_t confirmed = 0;
+    std::thread game([&]() {
+        size_t next = 0;
+        bool last = false;
+        while (!last) {
+            last = !confirming.load();
+            std::vector<RecordingActuator::Record> records = actuator.GetRecords();
+            for (; next < records.size(); next++) {
+                confirmed += actuator.Confirm(records[next].command.item);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    // Ticks come faster than the game's frames so batches form; each tick submits a few clicks on conveyor items
+    DWORD nextItem = 0x100000;
+    int dropped = 0;
+    for (int tick = 0; tick < NUM_TICKS; tick++) {
+        int count = burst(rng);
+        for (int i = 0; i < count; i++) {
+            int64_t start = NowNanos();
+            if (actuator.Submit(ActuatorCommandType::Click, position(rng), position(rng), nextItem) == 0) {
+                dropped++;
+                continue;
+            }
+            submitTime.Record(NowNanos() - start);
+            nextItem += 0x40;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    if (!actuator.WaitIdle(1000000000)) {
+        std::cout << "Error: The actuator did not send every command." << std::endl;
+        return 1;
+    }
+    confirming = false;
+    game.join();
+    actuator.Stop();
+
+    std::vector<RecordingActuator::Record> records = actuator.GetRecords();
+    bool valid = records.size() == actuator.GetSubmittedCount() && dropped == 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        valid &= records[i].command.sequence == i + 1;
+    }
+    valid &= confirmed + actuator.GetUnconfirmedCount() == records.size();
+
+    double blockingNanos = CALLS_PER_BLOCKING_CLICK * batchNanos + CURSOR_POLL_NANOS;
+    std::cout << records.size() << " clicks in " << actuator.GetBatchCount() << " batches, "
+              << std::fixed << std::setprecision(2) << (double) records.size() / actuator.GetBatchCount()
+              << " clicks per batch, " << dropped << " dropped" << std::endl;
+    std::cout << "planner time per click: blocking " << std::setprecision(1) << blockingNanos / 1e3
+              << " us, actuator " << submitTime.GetMeanNanos() / 1e3 << " us" << std::endl;
+    submitTime.Print(std::cout, "Submit time");
+    actuator.GetSendLatency().Print(std::cout, "Send latency");
+    actuator.GetConfirmLatency().Print(std::cout, "Confirm latency");
+    std::cout << "confirmed " << confirmed << ", unconfirmed " << actuator.GetUnconfirmedCount() << std::endl;
+    if (!valid) {
+        std::cout << "Error: Commands were lost, reordered or not confirmed." << std::endl;
+    }
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+#include <Bench.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+/**
+ * @internal
+ * Parses an address in decimal or 0x-hex.
+ * @param text The address.
+ * @param address (out) The address, if it is one.
+ * @return Whether the whole text is an address that fits a DWORD.
+ */
+static bool ParseAddress(const std::string &text, DWORD &address) {
+    char *end = nullptr;
+    errno = 0;
+    unsigned long long value = std::strtoull(text.c_str(), &end, 0);
+    if (end == text.c_str() || *end != '\0' || errno == ERANGE || value > 0xFFFFFFFFULL) {
+        return false;
+    }
+    address = (DWORD) value;
+    return true;
+}
+
+/**
+ * Loads a recorded trace. Malformed lines are skipped.
+ * @param path The path of the trace.
+ * @param trace (out) The trace.
+ * @return Whether the trace could be read and has at least one point.
+ */
+bool LoadTrace(const char *path, std::vector<TracePoint> &trace) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cout << "Error: Could not open trace " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream fields(line);
+        TracePoint point;
+        std::string address;
+        if (!(fields >> point.timeNanos >> address >> point.x >> point.y) || !ParseAddress(address, point.address)) {
+            continue;
+        }
+        trace.push_back(point);
+    }
+    return !trace.empty();
+}
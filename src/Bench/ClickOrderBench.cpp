@@ -0,0 +1,159 @@
+#include <Bench.h>
+#include <ClickOrder.h>
+#include <MotionPredictor.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/*
+ * Compares clicking the ingredients of an order in recipe order, as the planner used to, with the click order
+ * optimizer, on conveyor layouts: the simulated time per order, the cursor travel and the items lost off the screen.
+ *
+ * Usage: ClickOrderBench [trace.csv]
+ * The trace has the format of MotionBench, "timeNanos,address,x,y" per item per snapshot (see TracePoint). Without a trace, layouts
+ * are generated: a belt running left to right across the screen, with items spread along it.
+ */
+
+static const int ORDERS_PER_LAYOUT = 4;
+
+/**
+ * Generates a trace of items moving right along a belt, one snapshot every 17 ms.
+ * @param trace (out) The trace.
+ */
+static void GenerateTrace(std::vector<TracePoint> &trace) {
+    std::mt19937 rng(16);
+    std::uniform_real_distribution<float> lane(-30.0f, 30.0f);
+    const float speed = 120.0f;
+    const int64_t spawnNanos = 250000000;
+    std::vector<float> lanes;
+    for (int frame = 0; frame < 2000; frame++) {
+        int64_t time = frame * 17000000LL;
+        for (int64_t spawn = time - time % spawnNanos; spawn >= 0; spawn -= spawnNanos) {
+            int index = spawn / spawnNanos;
+            while ((int) lanes.size() <= index) {
+                lanes.push_back(lane(rng));
+            }
+            float x = -20.0f + speed * (time - spawn) / 1e9f;
+            if (x > 820.0f) {
+                break;
+            }
+            trace.push_back({time, (DWORD) (0x100000 + index * 0x40), x, 480.0f + lanes[index]});
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    std::vector<TracePoint> trace;
+    if (argc > 1) {
+        if (!LoadTrace(argv[1], trace)) {
+            return 1;
+        }
+    } else {
+        GenerateTrace(trace);
+    }
+    std::stable_sort(trace.begin(), trace.end(), [](const TracePoint &a, const TracePoint &b) {
+        return a.timeNanos < b.timeNanos;
+    });
+
+    std::mt19937 rng(1);
+    MotionPredictor motion;
+    ClickOrder clickOrder;
+    ConveyorTable conveyor;
+    std::vector<ClickTarget> targets;
+    std::vector<int> sequence(ClickOrder::MAX_TARGETS);
+    std::vector<int> rows;
+    ClickCost recipeTotal = {0, 0, 0.0f};
+    ClickCost optimizedTotal = {0, 0, 0.0f};
+    int numSnapshots = 0;
+    int orders = 0;
+    int numClicks = 0;
+    double planNanos = 0;
+    bool valid = true;
+
+    for (size_t first = 0; first < trace.size();) {
+        // One snapshot of the trace is one layout
+        size_t last = first;
+        conveyor.Clear();
+        while (last < trace.size() && trace[last].timeNanos == trace[first].timeNanos) {
+            size_t row = conveyor.Size();
+            conveyor.Resize(row + 1);
+            conveyor.address[row] = trace[last].address;
+            conveyor.x[row] = trace[last].x;
+            conveyor.y[row] = trace[last].y;
+            last++;
+        }
+        int64_t time = trace[first].timeNanos;
+        first = last;
+        motion.Update(conveyor, time);
+        // Layouts change little from frame to frame, so only every tenth one is used
+        if (++numSnapshots % 10 != 0 || conveyor.Size() < 8) {
+            continue;
+        }
+        rows.resize(conveyor.Size());
+        for (size_t i = 0; i < rows.size(); i++) {
+            rows[i] = i;
+        }
+        for (int order = 0; order < ORDERS_PER_LAYOUT; order++) {
+            // A recipe stacks a base, some fillings and sometimes a top, on distinct items of the layout
+            std::shuffle(rows.begin(), rows.end(), rng);
+            int count = std::uniform_int_distribution<int>(3, std::min<int>(8, rows.size()))(rng);
+            bool hasTop = std::uniform_int_distribution<int>(0, 1)(rng) == 1;
+            targets.resize(count);
+            for (int i = 0; i < count; i++) {
+                ClickTarget &target = targets[i];
+                int row = rows[i];
+                target.ingredient = i;
+                target.layer = i == 0 ? StackingLayer::Base : hasTop && i == count - 1 ? StackingLayer::Top
+                                                                                       : StackingLayer::Filling;
+                target.available = true;
+                target.x = conveyor.x[row];
+                target.y = conveyor.y[row];
+                float vx = 0.0f, vy = 0.0f;
+                motion.GetVelocity(conveyor.address[row], vx, vy);
+                target.vx = vx * 1e-9f;
+                target.vy = vy * 1e-9f;
+            }
+            float cursorX = std::uniform_real_distribution<float>(0.0f, ClickOrder::SCREEN_WIDTH)(rng);
+            float cursorY = std::uniform_real_distribution<float>(0.0f, ClickOrder::SCREEN_HEIGHT)(rng);
+
+            int length = ClickOrder::RecipeOrder(targets.data(), count, sequence.data());
+            ClickCost recipe = ClickOrder::Evaluate(targets.data(), sequence.data(), length, cursorX, cursorY);
+            auto start = std::chrono::steady_clock::now();
+            length = clickOrder.Plan(targets.data(), count, cursorX, cursorY, sequence.data());
+            planNanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            ClickCost optimized = ClickOrder::Evaluate(targets.data(), sequence.data(), length, cursorX, cursorY);
+
+            // The optimized order must click everything, keep the layers and be no worse than the recipe order
+            uint32_t clicked = 0;
+            for (int i = 0; i < length; i++) {
+                valid &= ClickOrder::IsAllowed(targets.data(), count, clicked, sequence[i]);
+                clicked |= 1u << sequence[i];
+            }
+            valid &= length == count && !(recipe < optimized);
+            recipeTotal.lost += recipe.lost;
+            recipeTotal.nanos += recipe.nanos;
+            recipeTotal.travel += recipe.travel;
+            optimizedTotal.lost += optimized.lost;
+            optimizedTotal.nanos += optimized.nanos;
+            optimizedTotal.travel += optimized.travel;
+            numClicks += count;
+            orders++;
+        }
+    }
+    if (orders == 0) {
+        std::cout << "Error: The trace has no layout with enough items" << std::endl;
+        return 1;
+    }
+    std::cout << orders << " orders, " << numClicks << " clicks" << std::endl;
+    std::cout << "              ms/order  travel/order  lost items" << std::endl;
+    std::cout << "recipe    " << std::fixed << std::setprecision(1)
+              << std::setw(12) << recipeTotal.nanos / 1e6 / orders
+              << std::setw(14) << recipeTotal.travel / orders << std::setw(12) << recipeTotal.lost << std::endl;
+    std::cout << "optimized " << std::setw(12) << optimizedTotal.nanos / 1e6 / orders
+              << std::setw(14) << optimizedTotal.travel / orders << std::setw(12) << optimizedTotal.lost << std::endl;
+    std::cout << "plan time " << std::setw(12) << planNanos / 1e3 / orders << " us/order" << std::endl;
+    return valid ? 0 : 1;
+}
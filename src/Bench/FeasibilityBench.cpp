@@ -0,0 +1,236 @@
+#include <Feasibility.h>
+#include <Scheduler.h>
+#include <World.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/*
+ * Compares the order feasibility check the planner used to run (matching every ingredient of every order pairwise
+ * against the conveyor) with the per-tick ingredient histogram, and the scalar multi-order kernel with its SIMD
+ * variants. All variants run on the same synthetic snapshots and must agree on every order.
+ * Also compares how many orders the scheduler fits onto the conveyor with taking feasible orders first come, first
+ * served.
+ */
+
+static const int ITERATIONS = 20000;
+
+/**
+ * Fills a snapshot with random conveyor items and orders.
+ * @param world (out) The snapshot.
+ * @param rng The random number generator.
+ * @param conveyorSize The number of conveyor items.
+ * @param numOrders The number of orders.
+ * @param ingredientsPerOrder The number of ingredients of each order.
+ */
+static void BuildWorld(WorldSnapshot &world, std::mt19937 &rng, int conveyorSize, int numOrders,
+                       int ingredientsPerOrder) {
+    // Few distinct ingredients make feasible orders likely, like on a real level
+    std::uniform_int_distribution<int> ingredient(0, 15);
+    world.conveyor.Clear();
+    world.conveyor.Resize(conveyorSize);
+    for (int i = 0; i < conveyorSize; i++) {
+        world.conveyor.address[i] = 0x1000 + i * 0x100;
+        world.conveyor.kind[i] = i % 8 == 7 ? ObjectKind::Complex : ObjectKind::Simple;
+        world.conveyor.ingredientId[i] = world.conveyor.kind[i] == ObjectKind::Simple ? ingredient(rng) : -1;
+    }
+    world.orders.clear();
+    world.ingredients.clear();
+    world.requirements.clear();
+    for (int i = 0; i < numOrders; i++) {
+        OrderEntry order = OrderEntry();
+        order.info.mNumCopies = 1;
+        order.info.mItem = 0x100 + i;
+        order.firstIngredient = world.ingredients.size();
+        order.ingredientCount = ingredientsPerOrder;
+        order.customer = 0x8000 + i * 0x100;
+        for (int j = 0; j < ingredientsPerOrder; j++) {
+            world.ingredients.push_back(ingredient(rng));
+        }
+        world.orders.push_back(order);
+    }
+}
+
+/**
+ * The pairwise check, as the planner ran it before the histogram.
+ */
+static bool PairwiseFeasible(const WorldSnapshot &world, const OrderEntry &order, std::vector<int> &ingredients) {
+    Feasibility::CollectIngredients(world, order, ingredients);
+    std::vector<bool> foundIngredients(ingredients.size(), false);
+    for (size_t c = 0; c < world.conveyor.Size(); c++) {
+        if (world.conveyor.kind[c] != ObjectKind::Simple) {
+            continue;
+        }
+        for (size_t j = 0; j < ingredients.size(); j++) {
+            if (ingredients[j] == world.conveyor.ingredientId[c] && !foundIngredients[j]) {
+                foundIngredients[j] = true;
+                break;
+            }
+        }
+    }
+    for (bool foundIngredient: foundIngredients) {
+        if (!foundIngredient) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Runs one scenario and prints the time per tick of both checks.
+ * @return Whether both checks agreed on every order.
+ */
+static bool RunScenario(int conveyorSize, int numOrders, int ingredientsPerOrder) {
+    std::mt19937 rng(conveyorSize * 1000 + numOrders);
+    WorldSnapshot world;
+    BuildWorld(world, rng, conveyorSize, numOrders, ingredientsPerOrder);
+    std::vector<int> ingredients;
+
+    int pairwiseFeasible = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        for (const OrderEntry &order: world.orders) {
+            pairwiseFeasible += PairwiseFeasible(world, order, ingredients);
+        }
+    }
+    double pairwiseNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // The histogram variant does all of its per-tick work inside the loop: counting the conveyor and compiling the
+    // orders, which the world reader does once per snapshot
+    int histogramFeasible = 0;
+    start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        Feasibility::CountConveyor(world.conveyor, world.conveyorCounts);
+        world.requirements.resize(world.orders.size());
+        for (size_t i = 0; i < world.orders.size(); i++) {
+            Feasibility::CollectIngredients(world, world.orders[i], ingredients);
+            Feasibility::CountIngredients(ingredients, world.requirements[i]);
+        }
+        for (size_t i = 0; i < world.orders.size(); i++) {
+            histogramFeasible += Feasibility::IsFeasible(world.conveyorCounts, world.requirements[i]);
+        }
+    }
+    double histogramNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    bool agree = pairwiseFeasible == histogramFeasible;
+    for (size_t i = 0; i < world.orders.size(); i++) {
+        agree &= PairwiseFeasible(world, world.orders[i], ingredients) ==
+                 Feasibility::IsFeasible(world.conveyorCounts, world.requirements[i]);
+    }
+    std::cout << std::setw(8) << conveyorSize << std::setw(8) << numOrders << std::setw(8) << ingredientsPerOrder
+              << std::setw(14) << std::fixed << std::setprecision(0) << pairwiseNanos / ITERATIONS
+              << std::setw(14) << histogramNanos / ITERATIONS
+              << std::setw(10) << histogramFeasible / ITERATIONS << (agree ? "" : "  MISMATCH") << std::endl;
+    return agree;
+}
+
+/**
+ * Runs every supported multi-order kernel on the same orders and prints the time per call.
+ * @return Whether all kernels agreed with the scalar kernel.
+ */
+static bool RunKernels(int numOrders) {
+    std::mt19937 rng(numOrders);
+    WorldSnapshot world;
+    BuildWorld(world, rng, 48, numOrders, 8);
+    std::vector<int> ingredients;
+    Feasibility::CountConveyor(world.conveyor, world.conveyorCounts);
+    world.requirements.resize(world.orders.size());
+    for (size_t i = 0; i < world.orders.size(); i++) {
+        Feasibility::CollectIngredients(world, world.orders[i], ingredients);
+        Feasibility::CountIngredients(ingredients, world.requirements[i]);
+    }
+
+    std::vector<int> expected(numOrders);
+    Feasibility::CheckAll(FeasibilityKernel::Scalar, world.conveyorCounts, world.requirements.data(), numOrders,
+                          expected.data());
+    bool agree = true;
+    std::cout << std::setw(8) << numOrders;
+    for (FeasibilityKernel kernel: {FeasibilityKernel::Scalar, FeasibilityKernel::SSE2, FeasibilityKernel::AVX2}) {
+        if (!Feasibility::IsSupported(kernel)) {
+            std::cout << std::setw(12) << "n/a";
+            continue;
+        }
+        std::vector<int> missing(numOrders);
+        int numFeasible = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+            numFeasible += Feasibility::CheckAll(kernel, world.conveyorCounts, world.requirements.data(), numOrders,
+                                                 missing.data());
+        }
+        double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        agree &= missing == expected && numFeasible >= 0;
+        std::cout << std::setw(12) << std::fixed << std::setprecision(0) << nanos / ITERATIONS;
+    }
+    std::cout << (agree ? "" : "  MISMATCH") << std::endl;
+    return agree;
+}
+
+/**
+ * Plans the same snapshot with the scheduler and with first come, first served, and prints the number of orders each
+ * completes from the conveyor.
+ * @return Whether the scheduler completed at least as many orders and reserved a distinct item for every ingredient.
+ */
+static bool RunScheduler(int conveyorSize, int numOrders, int ingredientsPerOrder) {
+    std::mt19937 rng(conveyorSize * 7 + numOrders);
+    WorldSnapshot world;
+    BuildWorld(world, rng, conveyorSize, numOrders, ingredientsPerOrder);
+    std::vector<int> ingredients;
+    Feasibility::CountConveyor(world.conveyor, world.conveyorCounts);
+    world.requirements.resize(world.orders.size());
+    for (size_t i = 0; i < world.orders.size(); i++) {
+        Feasibility::CollectIngredients(world, world.orders[i], ingredients);
+        Feasibility::CountIngredients(ingredients, world.requirements[i]);
+    }
+    world.version++;
+
+    IngredientCounts available = world.conveyorCounts;
+    int greedyOrders = 0;
+    for (const IngredientCounts &required: world.requirements) {
+        if (Feasibility::IsFeasible(available, required)) {
+            for (int i = 0; i < IngredientCounts::MAX_INGREDIENTS; i++) {
+                available.counts[i] -= required.counts[i];
+            }
+            greedyOrders++;
+        }
+    }
+
+    OrderScheduler scheduler;
+    scheduler.Update(world, nullptr, ingredients);
+    const SchedulePlan &plan = scheduler.GetPlan();
+    std::vector<DWORD> items = plan.items;
+    std::sort(items.begin(), items.end());
+    bool valid = std::adjacent_find(items.begin(), items.end()) == items.end() &&
+                 std::find(items.begin(), items.end(), 0) == items.end() &&
+                 (int) plan.orders.size() >= greedyOrders;
+    // A second update of the same snapshot must keep the plan
+    valid &= !scheduler.Update(world, nullptr, ingredients);
+    std::cout << std::setw(8) << conveyorSize << std::setw(8) << numOrders << std::setw(8) << ingredientsPerOrder
+              << std::setw(10) << greedyOrders << std::setw(10) << plan.orders.size()
+              << std::setw(10) << scheduler.GetLastPlanNanos() / 1000 << (valid ? "" : "  INVALID") << std::endl;
+    return valid;
+}
+
+int main() {
+    std::cout << "conveyor  orders  ingred  pairwise ns  histogram ns  feasible" << std::endl;
+    bool agree = true;
+    int scenarios[][3] = {{8, 1, 4}, {16, 4, 6}, {32, 8, 6}, {32, 16, 8}, {64, 32, 8}, {64, 64, 10}};
+    for (auto &scenario: scenarios) {
+        agree &= RunScenario(scenario[0], scenario[1], scenario[2]);
+    }
+    std::cout << std::endl << "Multi-order kernel (best: " << Feasibility::GetKernelName(Feasibility::GetBestKernel())
+              << "), ns per call" << std::endl;
+    std::cout << "  orders      Scalar        SSE2        AVX2" << std::endl;
+    for (int numOrders: {1, 8, 64}) {
+        agree &= RunKernels(numOrders);
+    }
+    std::cout << std::endl << "Scheduler, orders completed from the conveyor" << std::endl;
+    std::cout << "conveyor  orders  ingred     FCFS  schedule   plan us" << std::endl;
+    int schedulerScenarios[][3] = {{16, 8, 3}, {32, 16, 4}, {48, 32, 5}, {64, 64, 6}};
+    for (auto &scenario: schedulerScenarios) {
+        agree &= RunScheduler(scenario[0], scenario[1], scenario[2]);
+    }
+    return agree ? 0 : 1;
+}
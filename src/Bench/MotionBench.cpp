@@ -0,0 +1,172 @@
+#include <Bench.h>
+#include <MotionPredictor.h>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+/*
+ * Replays conveyor position traces through the motion predictor and compares, for several input latencies, how far
+ * the click would land from the item when aiming at the captured position and when aiming at the predicted one.
+ *
+ * Usage: MotionBench [trace.csv]
+ * A trace has one line per item per snapshot, "timeNanos,address,x,y", with the address in decimal or 0x-hex. Without
+ * a trace, a synthetic one is generated: items riding a straight belt into a curve, captured every 17 ms with timing
+ * jitter and rounding noise.
+ */
+
+// Items are about this far from their center to their edge, so a click further off misses
+static const float HIT_RADIUS = 12.0f;
+
+/**
+ * Returns the position on the synthetic belt after travelling a distance.
+ */
+static void BeltPosition(float distance, float &x, float &y) {
+    const float straight = 600.0f;
+    const float radius = 60.0f;
+    const float arc = 3.14159265f / 2 * radius;
+    if (distance < straight) {
+        x = 100.0f + distance;
+        y = 450.0f;
+    } else if (distance < straight + arc) {
+        float angle = (distance - straight) / radius;
+        x = 700.0f + radius * std::sin(angle);
+        y = 390.0f + radius * std::cos(angle);
+    } else {
+        x = 760.0f;
+        y = 390.0f - (distance - straight - arc);
+    }
+}
+
+/**
+ * Generates a synthetic trace.
+ * @param trace (out) The trace.
+ */
+static void GenerateTrace(std::vector<TracePoint> &trace) {
+    std::mt19937 rng(15);
+    std::uniform_int_distribution<int> jitter(0, 4000000);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    const float speed = 150.0f;
+    const int64_t spawnNanos = 400000000;
+    const int64_t lifetimeNanos = 9000000000;
+    int64_t time = 0;
+    for (int frame = 0; frame < 3000; frame++) {
+        time += 17000000 + jitter(rng);
+        for (int64_t spawn = time - time % spawnNanos; spawn >= 0 && spawn > time - lifetimeNanos;
+             spawn -= spawnNanos) {
+            float x, y;
+            BeltPosition(speed * (time - spawn) / 1e9f, x, y);
+            trace.push_back({time, (DWORD) (0x100000 + spawn / spawnNanos * 0x40), x + noise(rng), y + noise(rng)});
+        }
+    }
+}
+
+/**
+ * Interpolates the position of an item between its trace points.
+ * @return Whether the time is within the item's trace.
+ */
+static bool Interpolate(const std::vector<TracePoint> &points, int64_t timeNanos, float &x, float &y) {
+    auto after = std::lower_bound(points.begin(), points.end(), timeNanos,
+                                  [](const TracePoint &point, int64_t time) {
+                                      return point.timeNanos < time;
+                                  });
+    if (after == points.end() || after == points.begin()) {
+        return false;
+    }
+    auto before = after - 1;
+    float fraction = (float) (timeNanos - before->timeNanos) / (float) (after->timeNanos - before->timeNanos);
+    x = before->x + (after->x - before->x) * fraction;
+    y = before->y + (after->y - before->y) * fraction;
+    return true;
+}
+
+/**
+ * Prints the mean, 99th percentile and miss rate of a set of click errors.
+ */
+static void PrintErrors(std::vector<float> &errors) {
+    std::sort(errors.begin(), errors.end());
+    double sum = 0;
+    size_t misses = 0;
+    for (float error: errors) {
+        sum += error;
+        misses += error > HIT_RADIUS;
+    }
+    size_t count = std::max<size_t>(errors.size(), 1);
+    std::cout << std::setw(9) << std::fixed << std::setprecision(2) << sum / count
+              << std::setw(9) << (errors.empty() ? 0.0f : errors[errors.size() * 99 / 100])
+              << std::setw(8) << std::setprecision(1) << 100.0 * misses / count;
+}
+
+int main(int argc, char **argv) {
+    std::vector<TracePoint> trace;
+    if (argc > 1) {
+        if (!LoadTrace(argv[1], trace)) {
+            return 1;
+        }
+    } else {
+        GenerateTrace(trace);
+    }
+    std::stable_sort(trace.begin(), trace.end(), [](const TracePoint &a, const TracePoint &b) {
+        return a.timeNanos < b.timeNanos;
+    });
+    std::map<DWORD, std::vector<TracePoint>> items;
+    for (const TracePoint &point: trace) {
+        items[point.address].push_back(point);
+    }
+    // Group the trace into snapshots
+    std::vector<std::pair<int64_t, ConveyorTable>> snapshots;
+    for (const TracePoint &point: trace) {
+        if (snapshots.empty() || snapshots.back().first != point.timeNanos) {
+            snapshots.emplace_back(point.timeNanos, ConveyorTable());
+        }
+        ConveyorTable &conveyor = snapshots.back().second;
+        size_t row = conveyor.Size();
+        conveyor.Resize(row + 1);
+        conveyor.address[row] = point.address;
+        conveyor.x[row] = point.x;
+        conveyor.y[row] = point.y;
+    }
+    std::cout << trace.size() << " positions of " << items.size() << " items in " << snapshots.size()
+              << " snapshots" << std::endl;
+    std::cout << "latency ms   captured: mean      p99  miss %   predicted: mean      p99  miss %" << std::endl;
+
+    bool better = true;
+    for (int latencyMillis: {0, 17, 33, 50, 100}) {
+        int64_t latencyNanos = latencyMillis * 1000000LL;
+        MotionPredictor motion;
+        std::vector<float> capturedErrors;
+        std::vector<float> predictedErrors;
+        for (const auto &snapshot: snapshots) {
+            const ConveyorTable &conveyor = snapshot.second;
+            motion.Update(conveyor, snapshot.first);
+            for (size_t i = 0; i < conveyor.Size(); i++) {
+                float trueX, trueY;
+                if (!Interpolate(items[conveyor.address[i]], snapshot.first + latencyNanos, trueX, trueY)) {
+                    continue;
+                }
+                float x = conveyor.x[i];
+                float y = conveyor.y[i];
+                capturedErrors.push_back(std::hypot(x - trueX, y - trueY));
+                motion.Predict(conveyor.address[i], snapshot.first + latencyNanos, x, y);
+                predictedErrors.push_back(std::hypot(x - trueX, y - trueY));
+            }
+        }
+        double capturedSum = 0, predictedSum = 0;
+        for (size_t i = 0; i < capturedErrors.size(); i++) {
+            capturedSum += capturedErrors[i];
+            predictedSum += predictedErrors[i];
+        }
+        if (latencyMillis >= 33) {
+            better &= predictedSum <= capturedSum;
+        }
+        std::cout << std::setw(10) << latencyMillis << "          ";
+        PrintErrors(capturedErrors);
+        std::cout << "           ";
+        PrintErrors(predictedErrors);
+        std::cout << std::endl;
+    }
+    return better ? 0 : 1;
+}
@@ -0,0 +1,306 @@
+#include <Bench.h>
+#include <ChangeSignal.h>
+#include <Simulator.h>
+#include <Managers.h>
+#include <World.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+/*
+ * Measures the planner per tick while it plays the simulated game, from an empty shop up to a 40-item conveyor with 8
+ * customers: how long GameState::PerformActions takes to decide, how much it allocates, how many reads reach the game's
+ * memory, and the orders per minute it serves. Every tick captures a snapshot if the game changed or a frame passed and
+ * runs the planner once, as the bot's main loop does; only the planner's side is measured, not the simulated game. Of
+ * the captures, only those that found the game state changed advance its version and make the planner re-plan.
+ *
+ * Arguments: --json prints the results as one JSON document instead of a table, so that runs can be diffed. An optional
+ * path is the item catalog to draw the menus from, resources/food.xml by default.
+ */
+
+// Spawns nothing within the bench
+static const int NEVER_FRAMES = 1 << 30;
+
+static std::atomic<uint64_t> allocations{0};
+
+/**
+ * Counts every allocation of the bench, including the planner's and its coroutine frames.
+ */
+void *operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void *memory = std::malloc(size > 0 ? size : 1);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+/**
+ * Discards the planner's output without allocating, so that it does not count against the planner.
+ */
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override {
+        return c;
+    }
+};
+
+/**
+ * A load to run the planner under. The conveyor holds about conveyorEndX / conveyorSpeed / spawnFrames items.
+ */
+struct Scenario {
+    const char *name;
+    int spawnFrames;
+    int numSlots;
+    int arrivalFrames;
+};
+
+/**
+ * The percentiles of a set of samples.
+ */
+struct Percentiles {
+    int64_t p50 = 0;
+    int64_t p99 = 0;
+    int64_t max = 0;
+};
+
+/**
+ * The measurements of one scenario.
+ */
+struct Result {
+    const Scenario *scenario = nullptr;
+    uint64_t ticks = 0;
+    uint64_t captures = 0;
+    // The captures that found the game state changed
+    uint64_t changes = 0;
+    double conveyorItems = 0.0;
+    double customers = 0.0;
+    Percentiles decisionNanos;
+    Percentiles captureNanos;
+    double allocationsPerTick = 0.0;
+    double remoteReadsPerTick = 0.0;
+    double remoteBytesPerTick = 0.0;
+    double ordersPerMinute = 0.0;
+    SimulatorStats stats;
+};
+
+/**
+ * Returns the nearest-rank percentiles of samples.
+ * @param samples The samples, which are sorted in place.
+ * @return The percentiles, all 0 if there are no samples.
+ */
+static Percentiles GetPercentiles(std::vector<int64_t> &samples) {
+    Percentiles percentiles;
+    if (samples.empty()) {
+        return percentiles;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto rank = [&samples](double p) {
+        return samples[std::min(samples.size() - 1, (size_t) (p * (double) samples.size()))];
+    };
+    percentiles.p50 = rank(0.50);
+    percentiles.p99 = rank(0.99);
+    percentiles.max = samples.back();
+    return percentiles;
+}
+
+/**
+ * Plays a scenario and measures every planner tick.
+ * @param scenario The load to play.
+ * @param result Receives the measurements.
+ * @return Whether the simulator could be attached.
+ */
+static bool Measure(const Scenario &scenario, Result &result) {
+    SimulatorConfig config;
+    config.spawnFrames = scenario.spawnFrames;
+    config.numSlots = scenario.numSlots;
+    config.arrivalFrames = scenario.arrivalFrames;
+    // Customers wait long enough that the slots stay full
+    config.patienceFrames = 3600;
+    Simulator simulator(config);
+    if (!simulator.Attach()) {
+        return false;
+    }
+    ProcessMemory &remote = GameState::GetDirectMemory();
+    std::vector<int64_t> decisions;
+    std::vector<int64_t> captures;
+    uint64_t allocated = 0;
+    uint64_t reads = 0;
+    uint64_t bytes = 0;
+    uint64_t conveyorItems = 0;
+    uint64_t customers = 0;
+    uint64_t changes = 0;
+    uint64_t version = GameState::GetStateVersion();
+    int64_t endNanos = simulator.GetNowNanos() + PLAY_NANOS;
+    while (simulator.GetNowNanos() < endNanos) {
+        uint64_t allocationsBefore = allocations.load(std::memory_order_relaxed);
+        uint64_t readsBefore = remote.GetReadCount();
+        uint64_t bytesBefore = remote.GetBytesRead();
+        int64_t start = ChangeSignal::SteadyNanos();
+        bool stale = WorldReader::PublishIfStale();
+        int64_t captured = ChangeSignal::SteadyNanos();
+        int64_t deadlineNanos = GameState::PerformActions();
+        int64_t decided = ChangeSignal::SteadyNanos();
+        allocated += allocations.load(std::memory_order_relaxed) - allocationsBefore;
+        reads += remote.GetReadCount() - readsBefore;
+        bytes += remote.GetBytesRead() - bytesBefore;
+        if (stale) {
+            captures.push_back(captured - start);
+        }
+        decisions.push_back(decided - captured);
+        std::shared_ptr<const WorldSnapshot> world = WorldReader::GetSnapshot();
+        changes += world->version != version;
+        version = world->version;
+        conveyorItems += world->conveyor.Size();
+        customers += world->customers.size();
+        world.reset();
+        GameState::GetActuator().Flush();
+        int64_t next = std::min(std::min(deadlineNanos, simulator.GetNextEventNanos()), endNanos);
+        simulator.AdvanceTo(std::max(next, simulator.GetNowNanos() + 1));
+    }
+    double ticks = (double) std::max<size_t>(decisions.size(), 1);
+    result.scenario = &scenario;
+    result.ticks = decisions.size();
+    result.captures = captures.size();
+    result.changes = changes;
+    result.conveyorItems = (double) conveyorItems / ticks;
+    result.customers = (double) customers / ticks;
+    result.decisionNanos = GetPercentiles(decisions);
+    result.captureNanos = GetPercentiles(captures);
+    result.allocationsPerTick = (double) allocated / ticks;
+    result.remoteReadsPerTick = (double) reads / ticks;
+    result.remoteBytesPerTick = (double) bytes / ticks;
+    result.stats = simulator.GetStats();
+    result.ordersPerMinute = result.stats.GetOrdersPerMinute(PLAY_NANOS);
+    return true;
+}
+
+/**
+ * Writes percentiles as a JSON object.
+ */
+static void PrintJson(std::ostream &out, const Percentiles &percentiles) {
+    out << "{\"p50\": " << percentiles.p50 << ", \"p99\": " << percentiles.p99 << ", \"max\": " << percentiles.max
+        << "}";
+}
+
+/**
+ * Writes the results as one JSON document.
+ */
+static void PrintJson(std::ostream &out, const std::vector<Result> &results) {
+    out << std::fixed << std::setprecision(2);
+    out << "{\"bench\": \"PlannerBench\", \"playNanos\": " << PLAY_NANOS << ", \"scenarios\": [" << std::endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &result = results[i];
+        out << "  {\"name\": \"" << result.scenario->name << "\", \"ticks\": " << result.ticks
+            << ", \"captures\": " << result.captures << ", \"changes\": " << result.changes
+            << ", \"conveyorItems\": " << result.conveyorItems << ", \"customers\": " << result.customers << ","
+            << std::endl;
+        out << "   \"decisionNanos\": ";
+        PrintJson(out, result.decisionNanos);
+        out << ", \"captureNanos\": ";
+        PrintJson(out, result.captureNanos);
+        out << "," << std::endl;
+        out << "   \"allocationsPerTick\": " << result.allocationsPerTick << ", \"remoteReadsPerTick\": "
+            << result.remoteReadsPerTick << ", \"remoteBytesPerTick\": " << result.remoteBytesPerTick
+            << ", \"ordersPerMinute\": " << result.ordersPerMinute << ", \"customersLost\": "
+            << result.stats.customersLost << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    out << "]}" << std::endl;
+}
+
+/**
+ * Writes the results as a table.
+ */
+static void PrintTable(std::ostream &out, const std::vector<Result> &results) {
+    out << "The planner per tick over " << PLAY_NANOS / 60000000000LL << " simulated minutes per scenario" << std::endl;
+    out << "scenario  items  customers   ticks  changes  decide p50/p99/max us  capture p50/p99/max us  allocs  reads"
+           "  orders/min" << std::endl;
+    for (const Result &result: results) {
+        out << std::left << std::setw(8) << result.scenario->name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(7) << result.conveyorItems << std::setw(11) << result.customers
+            << std::setw(8) << result.ticks << std::setw(9) << result.changes
+            << std::setw(9) << result.decisionNanos.p50 / 1000.0 << "/" << std::setw(6)
+            << result.decisionNanos.p99 / 1000.0 << "/" << std::setw(7) << result.decisionNanos.max / 1000.0
+            << std::setw(10) << result.captureNanos.p50 / 1000.0 << "/" << std::setw(6)
+            << result.captureNanos.p99 / 1000.0 << "/" << std::setw(7) << result.captureNanos.max / 1000.0
+            << std::setw(8) << result.allocationsPerTick << std::setw(7) << result.remoteReadsPerTick
+            << std::setw(12) << result.ordersPerMinute << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    bool json = false;
+    std::string catalog = "resources/food.xml";
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else {
+            catalog = argv[i];
+        }
+    }
+    if (!ItemManager::LoadItems(catalog)) {
+        std::cout << "Error: Could not load the item catalog " << catalog << std::endl;
+        return 1;
+    }
+    // About 533 frames from spawn to the end of the conveyor
+    const Scenario scenarios[] = {
+            {"empty", NEVER_FRAMES, 0, 20},
+            {"small", 32, 2, 20},
+            {"medium", 12, 4, 20},
+            {"full", 7, 8, 20},
+    };
+    std::vector<Result> results;
+    NullBuffer discard;
+    for (const Scenario &scenario: scenarios) {
+        Result result;
+        std::streambuf *out = std::cout.rdbuf(&discard);
+        bool attached = Measure(scenario, result);
+        std::cout.rdbuf(out);
+        if (!attached) {
+            std::cout << "Error: Could not attach the simulator." << std::endl;
+            return 1;
+        }
+        results.push_back(result);
+    }
+    if (json) {
+        PrintJson(std::cout, results);
+    } else {
+        PrintTable(std::cout, results);
+    }
+    // Every scenario must have run the planner, and the shop with customers must have been served
+    bool valid = true;
+    for (const Result &result: results) {
+        valid &= result.ticks > 0;
+    }
+    valid &= results.front().stats.ordersServed == 0 && results.back().stats.ordersServed > 0;
+    if (!valid) {
+        std::cout << "Error: The planner did not run as expected." << std::endl;
+    }
+    return valid ? 0 : 1;
+}
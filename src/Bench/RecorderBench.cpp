@@ -0,0 +1,238 @@
+#include <Bench.h>
+#include <ChangeSignal.h>
+#include <Recorder.h>
+#include <Simulator.h>
+#include <Managers.h>
+#include <World.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Measures what recording a session costs. First the cost of one record, then the planner's time per tick while it
+ * plays the simulated game, with and without recording the pages it fetches, its other memory reads, snapshots, runs
+ * and commands. The recording is read back and checked against what was recorded.
+ * The planner's time is the CPU time of its thread, so the flush thread, which compares the reads and snapshots and
+ * writes the file, is measured on its own even where both share a core. Where they do, the flush thread still evicts
+ * the planner's data from the cache. Plays with and without recording alternate, and the lowest time of each is
+ * reported, being the one least disturbed by the rest of the machine.
+ * Reads of the simulated game cost next to nothing, unlike reads of the live game, so the cost relative to the
+ * planner's own time is far higher here than in the bot.
+ *
+ * The optional argument is the item catalog to draw the menus from, resources/food.xml by default.
+ */
+
+static const int NUM_RECORDS = 1 << 20;
+// Fits the ring, so the flush thread can keep up between batches
+static const int BATCH_SIZE = 4096;
+static const int NUM_PLAYS = 15;
+
+/**
+ * Returns the CPU time of the calling thread. Windows only counts it at the scheduler's tick, so the wall clock stands
+ * in for it there.
+ * @return The time in nanoseconds.
+ */
+static int64_t ThreadNanos() {
+#ifdef _WIN32
+    return ChangeSignal::SteadyNanos();
+#else
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return time.tv_sec * 1000000000LL + time.tv_nsec;
+#endif
+}
+
+/**
+ * Returns the CPU time of all threads of the process.
+ * @return The time in nanoseconds.
+ */
+static int64_t ProcessNanos() {
+    return (int64_t) ((double) std::clock() * 1e9 / CLOCKS_PER_SEC);
+}
+
+/**
+ * Returns the lowest of a few values.
+ * @param values The values.
+ * @return The lowest value.
+ */
+static double Lowest(const std::vector<double> &values) {
+    return *std::min_element(values.begin(), values.end());
+}
+
+/**
+ * Waits until the flush thread has written every record made so far.
+ */
+static void WaitForFlush() {
+    while (Recorder::GetWrittenCount() + Recorder::GetDroppedCount() < Recorder::GetRecordCount()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+/**
+ * Measures the time to make one record, in batches the flush thread keeps up with.
+ * @param filename The file to record to.
+ * @return The mean time per record in nanoseconds, or a negative number if recording failed.
+ */
+static double MeasureRecord(const std::string &filename) {
+    if (!Recorder::Start(filename)) {
+        return -1.0;
+    }
+    ActuatorCommand command = {ActuatorCommandType::Click, 100, 200, 0x2000000, 0, 0};
+    int64_t busyNanos = 0;
+    for (int done = 0; done < NUM_RECORDS; done += BATCH_SIZE) {
+        int64_t start = ChangeSignal::SteadyNanos();
+        for (int i = 0; i < BATCH_SIZE; i++) {
+            command.sequence = done + i;
+            Recorder::RecordAction(command);
+        }
+        busyNanos += ChangeSignal::SteadyNanos() - start;
+        WaitForFlush();
+    }
+    Recorder::Stop();
+    bool complete = Recorder::GetWrittenCount() == (uint64_t) NUM_RECORDS && Recorder::GetDroppedCount() == 0;
+    return complete ? (double) busyNanos / NUM_RECORDS : -1.0;
+}
+
+/**
+ * Plays the simulated game and measures the planner's side of every tick: capturing a snapshot and running the
+ * planner, which is where the recorder hooks in.
+ * @param ticks (out) The number of ticks.
+ * @param stats (out) What happened in the game.
+ * @param submitted (out) The number of commands the planner submitted.
+ * @param otherNanos (out) The CPU time the other threads of the process spent during the play.
+ * @return The total CPU time of the ticks in nanoseconds, or a negative number if the simulator could not be attached.
+ */
+static int64_t MeasurePlay(uint64_t &ticks, SimulatorStats &stats, uint64_t &submitted, int64_t &otherNanos) {
+    SimulatorConfig config;
+    config.numSlots = 8;
+    config.arrivalFrames = 20;
+    config.patienceFrames = 3600;
+    config.spawnFrames = 7;
+    Simulator simulator(config);
+    if (!simulator.Attach()) {
+        return -1;
+    }
+    int64_t busyNanos = 0;
+    ticks = 0;
+    int64_t processStart = ProcessNanos();
+    int64_t threadStart = ThreadNanos();
+    int64_t endNanos = simulator.GetNowNanos() + PLAY_NANOS;
+    while (simulator.GetNowNanos() < endNanos) {
+        int64_t start = ThreadNanos();
+        WorldReader::PublishIfStale();
+        int64_t deadlineNanos = GameState::PerformActions();
+        busyNanos += ThreadNanos() - start;
+        ticks++;
+        GameState::GetActuator().Flush();
+        int64_t next = std::min(std::min(deadlineNanos, simulator.GetNextEventNanos()), endNanos);
+        simulator.AdvanceTo(std::max(next, simulator.GetNowNanos() + 1));
+    }
+    otherNanos = ProcessNanos() - processStart - (ThreadNanos() - threadStart);
+    stats = simulator.GetStats();
+    submitted = GameState::GetActuator().GetSubmittedCount();
+    return busyNanos;
+}
+
+int main(int argc, char **argv) {
+    std::string catalog = argc > 1 ? argv[1] : "resources/food.xml";
+    if (!ItemManager::LoadItems(catalog)) {
+        std::cout << "Error: Could not load the item catalog " << catalog << std::endl;
+        return 1;
+    }
+    std::string filename = (std::filesystem::temp_directory_path() / "RecorderBench.bs3r").string();
+    double recordNanos = MeasureRecord(filename);
+    if (recordNanos < 0.0) {
+        std::cout << "Error: Could not record to " << filename << "." << std::endl;
+        return 1;
+    }
+    std::cout << std::fixed << std::setprecision(1) << "One record takes " << recordNanos << " ns" << std::endl;
+
+    // The planner's output is silenced while it plays
+    std::ostringstream silenced;
+    std::streambuf *out = std::cout.rdbuf(silenced.rdbuf());
+    uint64_t plainTicks = 0;
+    uint64_t recordedTicks = 0;
+    SimulatorStats plainStats;
+    SimulatorStats recordedStats;
+    uint64_t submitted = 0;
+    std::vector<double> plainTicksNanos;
+    std::vector<double> recordedTicksNanos;
+    std::vector<double> flushTicksNanos;
+    bool played = true;
+    for (int play = 0; play < NUM_PLAYS && played; play++) {
+        int64_t otherNanos = 0;
+        int64_t plainNanos = MeasurePlay(plainTicks, plainStats, submitted, otherNanos);
+        bool started = Recorder::Start(filename);
+        int64_t recordedNanos = started ? MeasurePlay(recordedTicks, recordedStats, submitted, otherNanos) : -1;
+        // The flush thread's last drain is part of its cost
+        int64_t stopStart = ProcessNanos();
+        Recorder::Stop();
+        otherNanos += ProcessNanos() - stopStart;
+        played = plainNanos >= 0 && recordedNanos >= 0;
+        if (played) {
+            plainTicksNanos.push_back((double) plainNanos / plainTicks);
+            recordedTicksNanos.push_back((double) recordedNanos / recordedTicks);
+            flushTicksNanos.push_back((double) otherNanos / recordedTicks);
+        }
+    }
+    std::cout.rdbuf(out);
+    if (!played) {
+        std::cout << silenced.str();
+        return 1;
+    }
+
+    std::vector<SessionRecord> records;
+    if (!Recorder::Load(filename, records)) {
+        return 1;
+    }
+    std::remove(filename.c_str());
+    uint64_t counts[static_cast<size_t>(RecordKind::Tick) + 1] = {};
+    uint64_t memoryBytes = 0;
+    for (const SessionRecord &record: records) {
+        counts[static_cast<size_t>(record.kind)]++;
+        if (record.kind == RecordKind::Memory) {
+            memoryBytes += record.size;
+        }
+    }
+    double plainTick = Lowest(plainTicksNanos);
+    double recordedTick = Lowest(recordedTicksNanos);
+    double flushTick = Lowest(flushTicksNanos);
+    std::cout << "The planner playing " << PLAY_NANOS / 60000000000LL << " simulated minutes, " << recordedTicks
+              << " ticks, lowest of " << NUM_PLAYS << " plays" << std::endl;
+    std::cout << std::setprecision(2) << "Mean tick " << plainTick / 1000.0 << " us without recording, "
+              << recordedTick / 1000.0 << " us recording: " << (recordedTick - plainTick) / 1000.0 << " us, "
+              << 100.0 * (recordedTick - plainTick) / plainTick << "% of the tick" << std::endl;
+    std::cout << "Flush thread " << flushTick / 1000.0 << " us per tick, " << 100.0 * flushTick / plainTick
+              << "% of the tick" << std::endl;
+    std::cout << std::setprecision(1) << "Recorded " << records.size() << " records, "
+              << (double) records.size() / recordedTicks << " per tick, "
+              << records.size() * sizeof(SessionRecord) / 1024.0 / (PLAY_NANOS / 1e9) << " KiB per second"
+              << std::endl;
+    std::cout << "  breakpoints " << counts[static_cast<size_t>(RecordKind::Breakpoint)] << ", memory "
+              << counts[static_cast<size_t>(RecordKind::Memory)] << " (" << memoryBytes << " bytes), items "
+              << counts[static_cast<size_t>(RecordKind::Item)] << ", customers "
+              << counts[static_cast<size_t>(RecordKind::Customer)] << ", actions "
+              << counts[static_cast<size_t>(RecordKind::Action)] << ", ticks "
+              << counts[static_cast<size_t>(RecordKind::Tick)] << std::endl;
+    // Recording must not change what the planner does, and the file must hold every record made
+    bool valid = records.size() == Recorder::GetRecordCount() && Recorder::GetDroppedCount() == 0 &&
+                 plainStats.ordersServed == recordedStats.ordersServed &&
+                 counts[static_cast<size_t>(RecordKind::Tick)] == recordedTicks &&
+                 counts[static_cast<size_t>(RecordKind::Action)] == submitted &&
+                 counts[static_cast<size_t>(RecordKind::Breakpoint)] > 0 &&
+                 counts[static_cast<size_t>(RecordKind::Memory)] > 0 &&
+                 counts[static_cast<size_t>(RecordKind::Item)] > 0 &&
+                 counts[static_cast<size_t>(RecordKind::Customer)] > 0;
+    if (!valid) {
+        std::cout << "Error: The recording does not match the session." << std::endl;
+    }
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+#include <Bench.h>
+#include <Replayer.h>
+#include <Recorder.h>
+#include <Simulator.h>
+#include <Managers.h>
+#include <World.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Replays a recorded session through the planner and reports whether it did what it did in the recording, and how
+ * fast the replay runs. Without a session, it records the planner playing the simulated game and replays that twice:
+ * both replays must match the recording command for command.
+ *
+ * Arguments: --session <file> replays a recording of the bot instead, --speed <factor> replays at a multiple of the
+ * recorded pace rather than as fast as possible. An optional path is the item catalog, resources/food.xml by default.
+ */
+
+/**
+ * Records the planner playing the simulated game.
+ * @param filename The file to record to.
+ * @param stats (out) What happened in the game.
+ * @return The number of planner runs, or 0 if the game could not be recorded.
+ */
+static uint64_t RecordPlay(const std::string &filename, SimulatorStats &stats) {
+    if (!Recorder::Start(filename)) {
+        return 0;
+    }
+    SimulatorConfig config;
+    config.numSlots = 8;
+    config.arrivalFrames = 20;
+    config.patienceFrames = 3600;
+    config.spawnFrames = 7;
+    uint64_t ticks = 0;
+    {
+        Simulator simulator(config);
+        if (simulator.Attach()) {
+            int64_t endNanos = simulator.GetNowNanos() + PLAY_NANOS;
+            while (simulator.GetNowNanos() < endNanos) {
+                WorldReader::PublishIfStale();
+                int64_t deadlineNanos = GameState::PerformActions();
+                ticks++;
+                GameState::GetActuator().Flush();
+                int64_t next = std::min(std::min(deadlineNanos, simulator.GetNextEventNanos()), endNanos);
+                simulator.AdvanceTo(std::max(next, simulator.GetNowNanos() + 1));
+            }
+            stats = simulator.GetStats();
+        }
+    }
+    Recorder::Stop();
+    return Recorder::GetDroppedCount() == 0 ? ticks : 0;
+}
+
+/**
+ * Replays a session as fast as possible or at a multiple of its pace.
+ * @param records The records of the session.
+ * @param speed The pace, 0 for as fast as possible.
+ * @param replayer (out) The replayer, detached, with its stats.
+ * @return Whether the replay could be attached.
+ */
+static bool Replay(const std::vector<SessionRecord> &records, double speed, std::unique_ptr<Replayer> &replayer) {
+    replayer = std::make_unique<Replayer>(records);
+    if (!replayer->Attach()) {
+        return false;
+    }
+    replayer->Run(speed);
+    replayer->Detach();
+    return true;
+}
+
+/**
+ * Writes the results of a replay.
+ */
+static void Print(std::ostream &out, const ReplayStats &stats, int64_t recordedNanos) {
+    out << std::fixed << std::setprecision(1);
+    out << "Replayed " << stats.ticks << " planner runs, " << stats.breakpoints << " breakpoints and "
+        << stats.memoryRecords << " memory records in " << stats.wallNanos / 1e6 << " ms, "
+        << (stats.wallNanos > 0 ? (double) recordedNanos / stats.wallNanos : 0.0) << "x the recorded pace" << std::endl;
+    out << "  commands " << stats.matchedActions << " of " << stats.recordedActions << " recorded matched, "
+        << stats.replayedActions << " replayed; " << stats.divergentTicks << " runs diverged";
+    if (stats.firstDivergentTick >= 0) {
+        out << ", first run " << stats.firstDivergentTick << " at " << stats.firstDivergenceNanos << " ns";
+    }
+    out << std::endl;
+    out << "  planner run p50 " << stats.tickLatency.GetPercentileNanos(0.50) / 1000.0 << " us, p99 "
+        << stats.tickLatency.GetPercentileNanos(0.99) / 1000.0 << " us, max "
+        << stats.tickLatency.GetMaxNanos() / 1000.0 << " us" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    std::string catalog = "resources/food.xml";
+    std::string session;
+    double speed = 0.0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--session") == 0 && i + 1 < argc) {
+            session = argv[++i];
+        } else if (std::strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            speed = std::atof(argv[++i]);
+        } else {
+            catalog = argv[i];
+        }
+    }
+    if (!ItemManager::LoadItems(catalog)) {
+        std::cout << "Error: Could not load the item catalog " << catalog << std::endl;
+        return 1;
+    }
+
+    // The planner's output is silenced while it plays
+    std::ostringstream silenced;
+    std::streambuf *out = std::cout.rdbuf(silenced.rdbuf());
+    uint64_t recordedTicks = 0;
+    SimulatorStats simulated;
+    bool recorded = true;
+    if (session.empty()) {
+        session = (std::filesystem::temp_directory_path() / "ReplayBench.bs3r").string();
+        recordedTicks = RecordPlay(session, simulated);
+        recorded = recordedTicks > 0;
+    }
+    std::vector<SessionRecord> records;
+    bool loaded = recorded && Recorder::Load(session, records);
+    std::unique_ptr<Replayer> first;
+    std::unique_ptr<Replayer> second;
+    bool replayed = loaded && Replay(records, speed, first) && (recordedTicks == 0 || Replay(records, 0.0, second));
+    std::cout.rdbuf(out);
+    if (!replayed) {
+        std::cout << silenced.str();
+        std::cout << "Error: Could not replay " << session << "." << std::endl;
+        return 1;
+    }
+
+    int64_t recordedNanos = records.empty() ? 0 : records.back().timeNanos - records.front().timeNanos;
+    std::cout << "Session of " << records.size() << " records, " << recordedNanos / 1e9 << " s" << std::endl;
+    Print(std::cout, first->GetStats(), recordedNanos);
+    if (recordedTicks == 0) {
+        return first->GetStats().divergentTicks == 0 ? 0 : 1;
+    }
+    std::remove(session.c_str());
+    std::cout << "Replayed again:" << std::endl;
+    Print(std::cout, second->GetStats(), recordedNanos);
+
+    // The planner must have done in both replays exactly what it did while it played
+    bool valid = true;
+    for (const Replayer *replayer: {first.get(), second.get()}) {
+        const ReplayStats &stats = replayer->GetStats();
+        valid &= stats.ticks == recordedTicks && stats.breakpoints > 0 && stats.recordedActions > 0 &&
+                 stats.divergentTicks == 0 && stats.matchedActions == stats.recordedActions &&
+                 stats.replayedActions == stats.recordedActions;
+    }
+    if (!valid) {
+        std::cout << "Error: The replay does not match the recording." << std::endl;
+    }
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,344 @@
+#include <Feasibility.h>
+#include <Patience.h>
+#include <Scheduler.h>
+#include <World.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/*
+ * Plays a simulated stream of customers against two planners and counts the customers served and lost: the planner
+ * before deadlines (first feasible order in memory order, any matching conveyor item) and the order scheduler with
+ * deadlines learned by the patience tracker. Both planners see the same customers and conveyor spawns; only the
+ * timing of arrivals differs, as a customer arrives a while after the previous customer in its slot left.
+ * The stream is cut into levels, and the patience is learned anew in each one.
+ */
+
+static const int NUM_SLOTS = 4;
+static const int NUM_INGREDIENTS = 12;
+static const int CONVEYOR_CAPACITY = 20;
+static const int SPAWN_FRAMES = 12;
+static const uint64_t SIMULATED_FRAMES = 54000;
+// A level ends every few minutes; its customers leave with it, served or not
+static const uint64_t LEVEL_FRAMES = 12000;
+static const int NUM_SEEDS = 4;
+
+enum class Policy {
+    FirstFeasible,
+    Scheduler
+};
+
+struct SimCustomer {
+    int id;
+    uint64_t arrivalFrame;
+    uint64_t patienceFrames;
+    std::vector<std::vector<int>> orders;
+    std::vector<bool> done;
+    // Served customers stay for a frame, like the game shows the delivery before they walk off
+    bool served;
+    uint64_t servedFrame;
+};
+
+struct SimSlot {
+    bool occupied;
+    uint64_t nextArrival;
+    SimCustomer customer;
+};
+
+struct SimItem {
+    DWORD address;
+    int ingredient;
+};
+
+struct SimResult {
+    int arrived = 0;
+    int served = 0;
+    int lost = 0;
+    uint64_t learnedPatience = 0;
+};
+
+/**
+ * Generates the next customer of the stream.
+ * @param rng The random number generator of the customer stream.
+ * @param id The id of the customer.
+ * @param frame The frame the customer arrives.
+ * @param patienceFrames The mean patience.
+ * @return The customer.
+ */
+static SimCustomer NextCustomer(std::mt19937 &rng, int id, uint64_t frame, uint64_t patienceFrames) {
+    std::uniform_int_distribution<int> numOrders(1, 2);
+    std::uniform_int_distribution<int> numIngredients(2, 5);
+    std::uniform_int_distribution<int> ingredient(0, NUM_INGREDIENTS - 1);
+    std::uniform_int_distribution<int> patience(-20, 20);
+    SimCustomer customer;
+    customer.id = id;
+    customer.arrivalFrame = frame;
+    customer.patienceFrames = patienceFrames + (int64_t) patienceFrames * patience(rng) / 100;
+    customer.orders.resize(numOrders(rng));
+    for (std::vector<int> &order: customer.orders) {
+        order.resize(numIngredients(rng));
+        for (int &i: order) {
+            i = ingredient(rng);
+        }
+    }
+    customer.done.assign(customer.orders.size(), false);
+    customer.served = false;
+    customer.servedFrame = 0;
+    return customer;
+}
+
+/**
+ * Builds the snapshot the planner sees at a frame.
+ */
+static void BuildSnapshot(WorldSnapshot &world, uint64_t frame, const std::vector<SimSlot> &slots,
+                          const std::vector<SimItem> &conveyor) {
+    world.frame = frame;
+    world.conveyor.Clear();
+    world.conveyor.Resize(conveyor.size());
+    for (size_t i = 0; i < conveyor.size(); i++) {
+        world.conveyor.address[i] = conveyor[i].address;
+        world.conveyor.kind[i] = ObjectKind::Simple;
+        world.conveyor.ingredientId[i] = conveyor[i].ingredient;
+    }
+    world.customers.clear();
+    world.orders.clear();
+    world.ingredients.clear();
+    for (int s = 0; s < NUM_SLOTS; s++) {
+        if (!slots[s].occupied) {
+            continue;
+        }
+        const SimCustomer &customer = slots[s].customer;
+        DWORD address = 0x9000 + s * 0x1000;
+        CustomerEntry entry = {address, customer.id, (int) world.orders.size(), 0, 0, 0};
+        for (size_t o = 0; o < customer.orders.size(); o++) {
+            OrderEntry order = OrderEntry();
+            order.info.mNumCopies = 1;
+            order.info.mNumComplete = customer.done[o] ? 1 : 0;
+            order.info.mItem = customer.id * 16 + o;
+            order.firstIngredient = world.ingredients.size();
+            order.ingredientCount = customer.orders[o].size();
+            order.customer = address;
+            world.ingredients.insert(world.ingredients.end(), customer.orders[o].begin(), customer.orders[o].end());
+            world.orders.push_back(order);
+        }
+        entry.orderCount = world.orders.size() - entry.firstOrder;
+        world.customers.push_back(entry);
+    }
+    static std::vector<int> ingredients;
+    Feasibility::CountConveyor(world.conveyor, world.conveyorCounts);
+    world.requirements.resize(world.orders.size());
+    for (size_t i = 0; i < world.orders.size(); i++) {
+        Feasibility::CollectIngredients(world, world.orders[i], ingredients);
+        Feasibility::CountIngredients(ingredients, world.requirements[i]);
+    }
+    Feasibility::CheckAll(world.conveyorCounts, world.requirements, world.missingIngredients);
+}
+
+/**
+ * Takes an item off the conveyor.
+ * @return Whether the item was on the conveyor.
+ */
+static bool TakeItem(std::vector<SimItem> &conveyor, DWORD address) {
+    for (size_t i = 0; i < conveyor.size(); i++) {
+        if (conveyor[i].address == address) {
+            conveyor.erase(conveyor.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Runs the stream against one planner.
+ * @param policy The planner.
+ * @param meanGapFrames The mean number of frames until an empty slot gets a new customer.
+ * @param patienceFrames The mean patience of a customer.
+ * @param seed The seed of the stream.
+ * @param result (in, out) Adds the customers arrived, served and lost.
+ */
+static void Simulate(Policy policy, int meanGapFrames, uint64_t patienceFrames, int seed, SimResult &result) {
+    std::mt19937 customerRng(seed * 3 + 1);
+    std::mt19937 conveyorRng(seed * 3 + 2);
+    std::mt19937 gapRng(seed * 3 + 3);
+    std::uniform_int_distribution<int> gap(meanGapFrames / 2, meanGapFrames * 3 / 2);
+    std::uniform_int_distribution<int> ingredient(0, NUM_INGREDIENTS - 1);
+    std::vector<SimSlot> slots(NUM_SLOTS);
+    for (int s = 0; s < NUM_SLOTS; s++) {
+        slots[s].occupied = false;
+        slots[s].nextArrival = gap(gapRng);
+    }
+    std::vector<SimItem> conveyor;
+    DWORD nextAddress = 0x100000;
+    int nextId = 1;
+
+    WorldSnapshot world;
+    PatienceTracker patience;
+    OrderScheduler scheduler;
+    bool building = false;
+    OrderKey key;
+    std::vector<int> ingredientsLeft;
+    uint64_t nextAction = 0;
+
+    for (uint64_t frame = 1; frame <= SIMULATED_FRAMES; frame++) {
+        bool changed = false;
+        if (frame % LEVEL_FRAMES == 0) {
+            // A new level starts empty, and the reader forgets the customers of the last one like after GameState::Reset
+            for (SimSlot &slot: slots) {
+                // Customers cut off by the end of the level count neither as served nor as lost
+                result.arrived -= slot.occupied;
+                slot.occupied = false;
+                slot.nextArrival = frame + gap(gapRng);
+            }
+            conveyor.clear();
+            building = false;
+            ingredientsLeft.clear();
+            patience.Reset();
+            changed = true;
+        }
+        // Customers come and go
+        for (SimSlot &slot: slots) {
+            if (slot.occupied) {
+                SimCustomer &customer = slot.customer;
+                bool lost = frame >= customer.arrivalFrame + customer.patienceFrames;
+                if ((customer.served && frame > customer.servedFrame + 1) || (!customer.served && lost)) {
+                    result.served += customer.served;
+                    result.lost += !customer.served;
+                    slot.occupied = false;
+                    slot.nextArrival = frame + gap(gapRng);
+                    changed = true;
+                }
+            } else if (frame >= slot.nextArrival) {
+                slot.customer = NextCustomer(customerRng, nextId++, frame, patienceFrames);
+                slot.occupied = true;
+                result.arrived++;
+                changed = true;
+            }
+        }
+        // The conveyor brings a new ingredient and drops the oldest one when full
+        if (frame % SPAWN_FRAMES == 0) {
+            if (conveyor.size() == CONVEYOR_CAPACITY) {
+                conveyor.erase(conveyor.begin());
+            }
+            conveyor.push_back({nextAddress++, ingredient(conveyorRng)});
+            changed = true;
+        }
+        BuildSnapshot(world, frame, slots, conveyor);
+        patience.Observe(frame, world.customers, world.orders);
+        world.version += changed;
+
+        if (frame < nextAction) {
+            continue;
+        }
+        // The order being built is abandoned once its customer has left
+        int target = -1;
+        for (size_t i = 0; building && i < world.orders.size(); i++) {
+            if (OrderScheduler::GetKey(world.orders[i]) == key) {
+                target = i;
+            }
+        }
+        if (building && target == -1) {
+            building = false;
+        }
+        if (!building) {
+            if (policy == Policy::Scheduler) {
+                scheduler.Update(world, nullptr, ingredientsLeft);
+                const SchedulePlan &plan = scheduler.GetPlan();
+                if (!plan.orders.empty()) {
+                    const ScheduledOrder &next = plan.orders[0];
+                    key = next.key;
+                    ingredientsLeft.assign(plan.ingredients.begin() + next.firstItem,
+                                           plan.ingredients.begin() + next.firstItem + next.itemCount);
+                    building = true;
+                }
+            } else {
+                for (size_t i = 0; i < world.orders.size(); i++) {
+                    const ItemInfo &info = world.orders[i].info;
+                    if (info.mNumComplete == info.mNumCopies || world.missingIngredients[i] != 0) {
+                        continue;
+                    }
+                    key = OrderScheduler::GetKey(world.orders[i]);
+                    Feasibility::CollectIngredients(world, world.orders[i], ingredientsLeft);
+                    building = true;
+                    break;
+                }
+            }
+            nextAction = frame + 1;
+            continue;
+        }
+        if (ingredientsLeft.empty()) {
+            // Deliver
+            for (SimSlot &slot: slots) {
+                DWORD address = 0x9000 + (&slot - slots.data()) * 0x1000;
+                if (slot.occupied && address == key.customer) {
+                    SimCustomer &customer = slot.customer;
+                    customer.done[key.item - customer.id * 16] = true;
+                    customer.served = std::all_of(customer.done.begin(), customer.done.end(), [](bool d) {
+                        return d;
+                    });
+                    customer.servedFrame = frame;
+                }
+            }
+            building = false;
+            world.version++;
+            nextAction = frame + OrderScheduler::DELIVERY_FRAMES;
+            continue;
+        }
+        // Click an ingredient
+        DWORD item = 0;
+        size_t clicked = 0;
+        if (policy == Policy::Scheduler) {
+            scheduler.Update(world, &key, ingredientsLeft);
+            const SchedulePlan &plan = scheduler.GetPlan();
+            for (size_t i = 0; i < ingredientsLeft.size() && item == 0; i++) {
+                item = plan.items[plan.orders[0].firstItem + i];
+                clicked = i;
+            }
+        } else {
+            for (size_t i = 0; i < ingredientsLeft.size() && item == 0; i++) {
+                for (const SimItem &candidate: conveyor) {
+                    if (candidate.ingredient == ingredientsLeft[i]) {
+                        item = candidate.address;
+                        clicked = i;
+                        break;
+                    }
+                }
+            }
+        }
+        if (item == 0 || !TakeItem(conveyor, item)) {
+            // Give up, like the planner does when nothing it needs is on the conveyor
+            building = false;
+            ingredientsLeft.clear();
+            nextAction = frame + 1;
+            continue;
+        }
+        ingredientsLeft.erase(ingredientsLeft.begin() + clicked);
+        world.version++;
+        nextAction = frame + OrderScheduler::FRAMES_PER_INGREDIENT;
+    }
+    result.learnedPatience = patience.HasLearned() ? patience.GetPatienceFrames() : 0;
+}
+
+int main() {
+    const uint64_t patienceFrames = 900;
+    std::cout << "Simulated customers over " << NUM_SEEDS << " streams of " << SIMULATED_FRAMES
+              << " frames, mean patience " << patienceFrames << " frames" << std::endl;
+    std::cout << "     gap    first: served    lost   lost %    schedule: served    lost   lost %  learned" << std::endl;
+    bool valid = true;
+    for (int meanGap: {600, 300, 120, 30}) {
+        SimResult first;
+        SimResult scheduled;
+        for (int seed = 0; seed < NUM_SEEDS; seed++) {
+            Simulate(Policy::FirstFeasible, meanGap, patienceFrames, seed, first);
+            Simulate(Policy::Scheduler, meanGap, patienceFrames, seed, scheduled);
+        }
+        std::cout << std::setw(8) << meanGap << std::setw(17) << first.served << std::setw(8) << first.lost
+                  << std::setw(9) << std::fixed << std::setprecision(1) << 100.0 * first.lost / first.arrived
+                  << std::setw(20) << scheduled.served << std::setw(8) << scheduled.lost
+                  << std::setw(9) << 100.0 * scheduled.lost / scheduled.arrived
+                  << std::setw(9) << scheduled.learnedPatience << std::endl;
+        valid &= scheduled.served + scheduled.lost <= scheduled.arrived;
+    }
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#include <Sequence.h>
+#include <LatencyHistogram.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/*
+ * Compares how late waits end when the planner acts on a fixed 2-frame tick, as the item-building state machine did,
+ * with sequences resumed at their exact deadline or as soon as their condition holds. Several building, delivering and
+ * discarding sequences are in flight at once, as in the bot.
+ * Time is simulated, so the bench runs instantly and the results do not depend on the machine.
+ */
+
+static const int64_t FRAME_NANOS = 16666667;
+static const int64_t TICK_NANOS = 2 * FRAME_NANOS;
+static const int NUM_SEQUENCES = 200;
+
+/**
+ * A condition that becomes true at a point in simulated time, e.g. the game taking a clicked item.
+ */
+struct Event {
+    int64_t timeNanos;
+};
+
+static int64_t now = 0;
+static LatencyHistogram lateness;
+
+/**
+ * Waits for a few events and durations, recording how late each wait ends.
+ * @param events The events to wait for, in order.
+ * @param durations The durations to wait between them.
+ * @return The sequence.
+ */
+static Sequence Worker(const std::vector<Event> *events, std::vector<int64_t> durations) {
+    for (size_t i = 0; i < events->size(); i++) {
+        int64_t eventNanos = (*events)[i].timeNanos;
+        co_await WaitUntil([eventNanos] { return now >= eventNanos; });
+        lateness.Record(now - eventNanos);
+        int64_t until = now + durations[i];
+        co_await WaitFor(durations[i]);
+        lateness.Record(now - until);
+    }
+}
+
+/**
+ * Generates the events and durations of the sequences.
+ */
+static void Generate(std::vector<std::vector<Event>> &events, std::vector<std::vector<int64_t>> &durations) {
+    std::mt19937 rng(20);
+    std::uniform_int_distribution<int64_t> start(0, 2000000000);
+    std::uniform_int_distribution<int64_t> gap(1000000, 100000000);
+    events.resize(NUM_SEQUENCES);
+    durations.resize(NUM_SEQUENCES);
+    for (int s = 0; s < NUM_SEQUENCES; s++) {
+        int64_t time = start(rng);
+        for (int i = 0; i < 8; i++) {
+            time += gap(rng);
+            events[s].push_back({time});
+            durations[s].push_back(gap(rng));
+            time += durations[s].back();
+        }
+    }
+}
+
+/**
+ * Runs the sequences to completion, waking the runner at the given times.
+ * @param exact Whether to wake at the deadlines and events, or on a fixed tick.
+ * @return The peak number of sequences in flight.
+ */
+static size_t Simulate(bool exact, const std::vector<std::vector<Event>> &events,
+                       const std::vector<std::vector<int64_t>> &durations) {
+    SequenceRunner runner;
+    lateness.Reset();
+    now = 0;
+    for (int s = 0; s < NUM_SEQUENCES; s++) {
+        runner.Spawn(Worker(&events[s], durations[s]));
+    }
+    // The events the runner is woken by, as the bot is by snapshots
+    std::vector<int64_t> wakeups;
+    for (const std::vector<Event> &list: events) {
+        for (const Event &event: list) {
+            wakeups.push_back(event.timeNanos);
+        }
+    }
+    std::sort(wakeups.begin(), wakeups.end());
+    size_t nextWakeup = 0;
+    size_t peak = 0;
+    while (runner.GetActiveCount() > 0) {
+        peak = std::max(peak, runner.GetActiveCount());
+        int64_t deadline = runner.Run(now);
+        if (exact) {
+            while (nextWakeup < wakeups.size() && wakeups[nextWakeup] <= now) {
+                nextWakeup++;
+            }
+            int64_t event = nextWakeup < wakeups.size() ? wakeups[nextWakeup] : SequenceRunner::NO_DEADLINE;
+            now = std::min(deadline, event);
+        } else {
+            now += TICK_NANOS;
+        }
+    }
+    return peak;
+}
+
+int main() {
+    std::vector<std::vector<Event>> events;
+    std::vector<std::vector<int64_t>> durations;
+    Generate(events, durations);
+    size_t ticked = Simulate(false, events, durations);
+    double tickedMean = lateness.GetMeanNanos();
+    std::cout << "Fixed 2-frame tick, " << ticked << " sequences in flight" << std::endl;
+    lateness.Print(std::cout, "Wait lateness");
+    size_t exact = Simulate(true, events, durations);
+    double exactMean = lateness.GetMeanNanos();
+    std::cout << "Exact waits, " << exact << " sequences in flight" << std::endl;
+    lateness.Print(std::cout, "Wait lateness");
+    std::cout << std::fixed << std::setprecision(2) << "Mean lateness " << tickedMean / 1e6 << " ms ticked, "
+              << exactMean / 1e6 << " ms exact" << std::endl;
+    // Exact waits must end on time, and every sequence must have run
+    bool valid = lateness.GetMaxNanos() == 0 && lateness.GetCount() == 2 * 8 * NUM_SEQUENCES && exact == ticked;
+    if (!valid) {
+        std::cout << "Error: The sequences did not wait exactly." << std::endl;
+    }
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+#include <Simulator.h>
+#include <Managers.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+/*
+ * Plays the bot's planner against the simulated game and scores it: orders served per minute, customers lost, and
+ * how its clicks fared. Each scenario is a few minutes of simulated play from several seeds, from a calm shop to a
+ * rush with impatient customers. The planner's output is silenced while it plays.
+ *
+ * The optional argument is the item catalog to draw the menus from, resources/food.xml by default.
+ */
+
+static const int64_t PLAY_NANOS = 5LL * 60 * 1000000000;
+static const int NUM_SEEDS = 3;
+
+/**
+ * A kind of game to score the planner on.
+ */
+struct Scenario {
+    const char *name;
+    int numSlots;
+    int arrivalFrames;
+    int patienceFrames;
+    int spawnFrames;
+};
+
+int main(int argc, char **argv) {
+    std::string catalog = argc > 1 ? argv[1] : "resources/food.xml";
+    if (!ItemManager::LoadItems(catalog)) {
+        std::cout << "Error: Could not load the item catalog " << catalog << std::endl;
+        return 1;
+    }
+    const Scenario scenarios[] = {
+            {"calm", 4, 600, 2400, 30},
+            {"steady", 4, 300, 1800, 30},
+            {"busy", 6, 150, 1800, 20},
+            {"rush", 6, 60, 1200, 15},
+    };
+    std::cout << "The planner against " << NUM_SEEDS << " simulated games of " << PLAY_NANOS / 60000000000LL
+              << " minutes per scenario" << std::endl;
+    std::cout << "scenario  orders/min  arrived  served  lost  lost %  clicks  missed  rejected  wrong  discards"
+                 "  speed-up" << std::endl;
+    bool valid = true;
+    uint64_t ordersServed = 0;
+    for (const Scenario &scenario: scenarios) {
+        SimulatorStats total;
+        double wallNanos = 0.0;
+        for (int seed = 1; seed <= NUM_SEEDS; seed++) {
+            SimulatorConfig config;
+            config.seed = seed;
+            config.numSlots = scenario.numSlots;
+            config.arrivalFrames = scenario.arrivalFrames;
+            config.patienceFrames = scenario.patienceFrames;
+            config.spawnFrames = scenario.spawnFrames;
+            std::ostringstream silenced;
+            std::streambuf *out = std::cout.rdbuf(silenced.rdbuf());
+            auto start = std::chrono::steady_clock::now();
+            bool attached;
+            {
+                Simulator simulator(config);
+                attached = simulator.Attach();
+                if (attached) {
+                    simulator.Run(PLAY_NANOS);
+                }
+                const SimulatorStats &stats = simulator.GetStats();
+                total.customersArrived += stats.customersArrived;
+                total.customersServed += stats.customersServed;
+                total.customersLost += stats.customersLost;
+                total.ordersServed += stats.ordersServed;
+                total.clicks += stats.clicks;
+                total.missedClicks += stats.missedClicks;
+                total.rejectedClicks += stats.rejectedClicks;
+                total.wrongDeliveries += stats.wrongDeliveries;
+                total.discards += stats.discards;
+            }
+            wallNanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            std::cout.rdbuf(out);
+            if (!attached) {
+                std::cout << silenced.str();
+                return 1;
+            }
+        }
+        double speedUp = NUM_SEEDS * (double) PLAY_NANOS / wallNanos;
+        std::cout << std::left << std::setw(8) << scenario.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << total.GetOrdersPerMinute(NUM_SEEDS * PLAY_NANOS)
+                  << std::setw(9) << total.customersArrived << std::setw(8) << total.customersServed
+                  << std::setw(6) << total.customersLost
+                  << std::setw(8) << 100.0 * total.customersLost / std::max<uint64_t>(total.customersArrived, 1)
+                  << std::setw(8) << total.clicks << std::setw(8) << total.missedClicks
+                  << std::setw(10) << total.rejectedClicks << std::setw(7) << total.wrongDeliveries
+                  << std::setw(10) << total.discards << std::setw(9) << std::setprecision(0) << speedUp << "x"
+                  << std::endl;
+        valid &= total.customersServed + total.customersLost <= total.customersArrived && speedUp > 1.0;
+        ordersServed += total.ordersServed;
+    }
+    // The planner must actually serve customers, faster than the game would run
+    valid &= ordersServed > 0;
+    if (!valid) {
+        std::cout << "Error: The simulated games did not run as expected." << std::endl;
+    }
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+#include <TickClock.h>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/*
+ * Compares waking the world reader on a fixed 17 ms cadence, as it used to, with waking it from the tick clock, on
+ * simulated game frame streams: faster and slower games, jitter, drift, missed breakpoint hits and stalls.
+ * Time is simulated, so the bench runs instantly and the results do not depend on the machine.
+ *
+ * For each way of waking: the share of frames handled by a wakeup before the next frame, the wakeups that found no
+ * new frame, and the mean delay from a frame to the wakeup handling it. For the tick clock, also the measured period
+ * and jitter against the true ones.
+ */
+
+static const int64_t FIXED_PERIOD_NANOS = 17000000;
+
+/**
+ * A frame of the game, and whether its breakpoint hit was seen.
+ */
+struct Frame {
+    int64_t timeNanos;
+    bool observed;
+};
+
+/**
+ * A frame stream to simulate.
+ */
+struct Scenario {
+    const char *name;
+    double startFps;
+    double endFps;
+    int64_t jitterNanos;
+    double missedShare;
+    int numStalls;
+};
+
+/**
+ * The counts of one way of waking the reader.
+ */
+struct WakeupStats {
+    uint64_t wakeups = 0;
+    uint64_t wasted = 0;
+    uint64_t handled = 0;
+    double delayNanos = 0.0;
+};
+
+/**
+ * Generates the frames of a scenario, about 20 seconds of play.
+ * @param scenario The scenario.
+ * @param frames (out) The frames.
+ * @param truePeriod (out) The period of the game at the last frame.
+ */
+static void Generate(const Scenario &scenario, std::vector<Frame> &frames, double &truePeriod) {
+    std::mt19937 rng(19);
+    std::normal_distribution<double> jitter(0.0, (double) scenario.jitterNanos);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    const double duration = 20e9;
+    double time = 0.0;
+    std::vector<double> stalls;
+    for (int i = 0; i < scenario.numStalls; i++) {
+        stalls.push_back(duration * (i + 1) / (scenario.numStalls + 1));
+    }
+    size_t nextStall = 0;
+    frames.clear();
+    while (time < duration) {
+        double progress = time / duration;
+        double period = 1e9 / (scenario.startFps + (scenario.endFps - scenario.startFps) * progress);
+        time += period;
+        if (nextStall < stalls.size() && time > stalls[nextStall]) {
+            time += 1e9;
+            nextStall++;
+        }
+        truePeriod = period;
+        int64_t observedTime = (int64_t) (time + std::max(jitter(rng), -period / 2));
+        frames.push_back({observedTime, chance(rng) >= scenario.missedShare});
+    }
+}
+
+/**
+ * Counts a wakeup: the frames that happened since the previous one are handled by it.
+ * @param frames The frames.
+ * @param next (in, out) The first frame not handled yet.
+ * @param now The time of the wakeup.
+ * @param stats (in, out) The counts.
+ */
+static void Wake(const std::vector<Frame> &frames, size_t &next, int64_t now, WakeupStats &stats) {
+    stats.wakeups++;
+    if (next >= frames.size() || frames[next].timeNanos > now) {
+        stats.wasted++;
+        return;
+    }
+    while (next < frames.size() && frames[next].timeNanos <= now) {
+        next++;
+    }
+    // Only the latest frame is handled; the ones before it were superseded without being acted on
+    stats.handled++;
+    stats.delayNanos += now - frames[next - 1].timeNanos;
+}
+
+/**
+ * Wakes the reader on a fixed cadence.
+ */
+static void RunFixed(const std::vector<Frame> &frames, WakeupStats &stats) {
+    size_t next = 0;
+    for (int64_t now = FIXED_PERIOD_NANOS; now <= frames.back().timeNanos; now += FIXED_PERIOD_NANOS) {
+        Wake(frames, next, now, stats);
+    }
+}
+
+/**
+ * Wakes the reader on the frames the tick clock acts on, or at its deadline when a frame is missed or late.
+ */
+static void RunClock(const std::vector<Frame> &frames, TickClock &clock, WakeupStats &stats) {
+    size_t next = 0;
+    int64_t now = 0;
+    size_t i = 0;
+    while (i < frames.size()) {
+        int64_t deadline = clock.GetDeadlineNanos(now);
+        while (i < frames.size() && !frames[i].observed) {
+            i++;
+        }
+        if (i < frames.size() && frames[i].timeNanos <= deadline) {
+            now = frames[i].timeNanos;
+            bool tick = clock.OnFrame(now);
+            i++;
+            if (tick) {
+                Wake(frames, next, now, stats);
+            }
+        } else if (i < frames.size()) {
+            now = deadline;
+            Wake(frames, next, now, stats);
+        }
+    }
+}
+
+/**
+ * Prints the counts of one way of waking the reader.
+ */
+static void PrintStats(const char *name, const WakeupStats &stats, size_t numFrames) {
+    std::cout << "  " << std::left << std::setw(11) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(9) << 100.0 * stats.handled / numFrames
+              << std::setw(9) << stats.wakeups
+              << std::setw(9) << stats.wasted
+              << std::setw(11) << std::setprecision(2) << stats.delayNanos / std::max<uint64_t>(stats.handled, 1) / 1e6
+              << std::endl;
+}
+
+int main() {
+    const Scenario scenarios[] = {
+            {"60 fps", 60.0, 60.0, 1000000, 0.0, 0},
+            {"144 fps", 144.0, 144.0, 500000, 0.0, 0},
+            {"30 fps", 30.0, 30.0, 2000000, 0.0, 0},
+            {"60 to 45 fps drift", 60.0, 45.0, 1000000, 0.0, 0},
+            {"60 fps, 5% missed hits", 60.0, 60.0, 1000000, 0.05, 0},
+            {"60 fps, 3 stalls of 1 s", 60.0, 60.0, 1000000, 0.0, 3},
+    };
+    bool valid = true;
+    std::vector<Frame> frames;
+    for (const Scenario &scenario: scenarios) {
+        double truePeriod = 0.0;
+        Generate(scenario, frames, truePeriod);
+        WakeupStats fixed;
+        WakeupStats clocked;
+        TickClock clock;
+        RunFixed(frames, fixed);
+        RunClock(frames, clock, clocked);
+
+        std::cout << scenario.name << ": " << frames.size() << " frames, period " << std::fixed
+                  << std::setprecision(2) << truePeriod / 1e6 << " ms, measured " << clock.GetFramePeriodNanos() / 1e6
+                  << " ms, jitter " << clock.GetJitterNanos() / 1e6 << " ms, " << clock.GetStallCount() << " stalls"
+                  << std::endl;
+        std::cout << "               handled %  wakeups   wasted   delay ms" << std::endl;
+        PrintStats("fixed", fixed, frames.size());
+        PrintStats("tick clock", clocked, frames.size());
+        // The clock must handle more frames with fewer wasted wakeups, and measure the period to within 5%
+        valid &= clocked.handled >= fixed.handled && clocked.wasted <= fixed.wasted;
+        valid &= std::abs(clock.GetFramePeriodNanos() - truePeriod) < truePeriod * 0.05;
+    }
+    if (!valid) {
+        std::cout << "Error: The tick clock did worse than the fixed cadence." << std::endl;
+    }
+    return valid ? 0 : 1;
+}
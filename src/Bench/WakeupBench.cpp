@@ -0,0 +1,110 @@
+#include <ChangeSignal.h>
+#include <LatencyHistogram.h>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+
+/*
+ * Compares how fast the planner notices a change of the game state, and how much CPU it burns meanwhile, when it
+ * spins on a 17 ms tick as the main loop used to and when it waits on the state's change signal.
+ * The changes come from a thread standing in for the breakpoint handlers, at random intervals.
+ *
+ * Usage: WakeupBench [number of changes]
+ */
+
+static const int64_t FRAME_NANOS = 17000000;
+static const int64_t MEAN_GAP_NANOS = 20000000;
+// The planner asks to run again after a few frames even when nothing changes
+static const int64_t POLL_NANOS = 3 * FRAME_NANOS;
+
+/**
+ * The reaction latency and CPU use of one way of waking the planner.
+ */
+struct WakeupResult {
+    LatencyHistogram latency;
+    double cpuPercent = 0.0;
+    uint64_t wakeups = 0;
+};
+
+/**
+ * Runs the change source and a planner loop until every change has been made.
+ * @param numChanges The number of changes to make.
+ * @param eventDriven Whether the planner waits on the signal instead of spinning on the tick.
+ * @param result (out) The measurements.
+ */
+static void Run(int numChanges, bool eventDriven, WakeupResult &result) {
+    ChangeSignal signal;
+    std::atomic<bool> done{false};
+    std::thread source([&signal, &done, numChanges]() {
+        std::mt19937 rng(18);
+        std::exponential_distribution<double> gap(1.0 / MEAN_GAP_NANOS);
+        for (int i = 0; i < numChanges; i++) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds((int64_t) gap(rng)));
+            signal.Notify();
+        }
+        std::this_thread::sleep_for(std::chrono::nanoseconds(2 * FRAME_NANOS));
+        done = true;
+    });
+
+    std::clock_t cpuStart = std::clock();
+    int64_t start = ChangeSignal::NowNanos();
+    uint64_t seen = 0;
+    int64_t lastTick = 0;
+    while (!done) {
+        uint64_t version;
+        if (eventDriven) {
+            version = signal.Wait(seen, ChangeSignal::NowNanos() + POLL_NANOS);
+        } else {
+            int64_t now = ChangeSignal::NowNanos();
+            if (now - lastTick <= FRAME_NANOS) {
+                continue;
+            }
+            lastTick = now;
+            version = signal.GetVersion();
+        }
+        result.wakeups++;
+        if (version != seen) {
+            result.latency.Record(ChangeSignal::NowNanos() - signal.GetChangeNanos());
+            seen = version;
+        }
+    }
+    double cpuNanos = (double) (std::clock() - cpuStart) / CLOCKS_PER_SEC * 1e9;
+    result.cpuPercent = 100.0 * cpuNanos / (ChangeSignal::NowNanos() - start);
+    source.join();
+}
+
+/**
+ * Prints the measurements of one way of waking the planner.
+ */
+static void PrintResult(const char *name, const WakeupResult &result) {
+    std::cout << std::left << std::setw(14) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << result.latency.GetMeanNanos() / 1e6
+              << std::setw(10) << result.latency.GetPercentileNanos(0.5) / 1e6
+              << std::setw(10) << result.latency.GetPercentileNanos(0.99) / 1e6
+              << std::setw(10) << result.latency.GetMaxNanos() / 1e6
+              << std::setw(8) << std::setprecision(1) << result.cpuPercent
+              << std::setw(12) << result.wakeups << std::endl;
+}
+
+int main(int argc, char **argv) {
+    int numChanges = argc > 1 ? std::stoi(argv[1]) : 200;
+    WakeupResult polling;
+    WakeupResult eventDriven;
+    Run(numChanges, false, polling);
+    Run(numChanges, true, eventDriven);
+
+    std::cout << numChanges << " changes, one every " << MEAN_GAP_NANOS / 1000000 << " ms on average" << std::endl;
+    std::cout << "latency ms         mean       p50       p99       max   cpu %     wakeups" << std::endl;
+    PrintResult("polling", polling);
+    PrintResult("event-driven", eventDriven);
+    bool better = eventDriven.latency.GetMeanNanos() < polling.latency.GetMeanNanos() &&
+                  eventDriven.cpuPercent < polling.cpuPercent;
+    if (!better) {
+        std::cout << "Error: Waiting on the signal was not faster and cheaper than polling." << std::endl;
+    }
+    return better ? 0 : 1;
+}
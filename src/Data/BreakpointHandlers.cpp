@@ -0,0 +1,98 @@
+#include <BreakpointHandlers.h>
+#include <Content.h>
+#include <Managers.h>
+#include <Recorder.h>
+
+/**
+ * @internal
+ * Records a game frame and reads the BB percentage through the pointer in ECX.
+ */
+static void OnBBPercent(const BreakpointEvent &event, ProcessMemory &memory) {
+    // The game reads the BB percentage once per update, so the hits mark its frames
+    GameState::OnFrame(event.timestamp);
+    float value;
+    if (!memory.Read(event.ecx, &value, sizeof(value))) {
+        return;
+    }
+    GameState::SetBBPercent(value);
+}
+
+/**
+ * @internal
+ * Reads the number of conveyor items from the conveyor in EDI.
+ */
+static void OnConveyorSize(const BreakpointEvent &event, ProcessMemory &memory) {
+    int value;
+    if (!memory.Read(event.edi + BreakpointHandlers::CONVEYOR_SIZE_OFFSET, &value, sizeof(value))) {
+        return;
+    }
+    GameState::SetNumConveyorItems(value);
+}
+
+/**
+ * @internal
+ * Adds the item of the list node in EAX to the conveyor.
+ */
+static void OnAddToConveyor(const BreakpointEvent &event, ProcessMemory &memory) {
+    Node node;
+    if (!memory.Read(event.eax, &node, sizeof(node))) {
+        return;
+    }
+    GameState::AddItemFromAddress(node.content);
+}
+
+/**
+ * @internal
+ * Removes the item of the list node in ESI from the conveyor.
+ */
+static void OnRemoveFromConveyor(const BreakpointEvent &event, ProcessMemory &memory) {
+    Node node;
+    if (!memory.Read(event.esi, &node, sizeof(node))) {
+        return;
+    }
+    GameState::RemoveItemFromAddress(node.content);
+}
+
+/**
+ * @internal
+ * Adds the customer in EBX.
+ */
+static void OnAddCustomer(const BreakpointEvent &event, ProcessMemory &memory) {
+    Customer customer(event.ebx);
+    if (customer.isValid(memory)) {
+        GameState::AddCustomer(customer);
+    }
+}
+
+/**
+ * @internal
+ * Resets the game state when a new level starts.
+ */
+static void OnReset(const BreakpointEvent &, ProcessMemory &) {
+    GameState::Reset();
+}
+
+// Indexed by BreakpointId
+static const BreakpointHandler handlers[] = {
+        OnBBPercent,
+        OnConveyorSize,
+        OnAddToConveyor,
+        OnRemoveFromConveyor,
+        OnAddCustomer,
+        OnReset,
+};
+static_assert(sizeof(handlers) / sizeof(handlers[0]) == static_cast<size_t>(BreakpointId::Count),
+              "Every breakpoint needs a handler");
+
+/**
+ * Records a breakpoint event and runs its handler.
+ * @param event The event. Events with an unknown id, e.g. from a damaged recording, are ignored.
+ * @param memory The memory to read what the registers point to from.
+ */
+void BreakpointHandlers::Dispatch(const BreakpointEvent &event, ProcessMemory &memory) {
+    if (event.id >= BreakpointId::Count) {
+        return;
+    }
+    Recorder::RecordBreakpoint(event);
+    handlers[static_cast<size_t>(event.id)](event, memory);
+}
@@ -1,20 +1,31 @@
 #include <list>
 #include <iostream>
+#include <cstring>
 #include <Content.h>
 #include <Managers.h>
-#include <Utils.h>
+#include <TypeCache.h>
+#include <Hash.h>
 
 DWORD MemoryProbe::GetAddress() {
     return address;
 }
 
+/**
+ * Returns how often HasChanged has seen this object change.
+ * @return The generation.
+ */
+uint64_t MemoryProbe::GetGeneration() {
+    return generation;
+}
+
 /**
  * Prints the integer values starting at the address of this MemoryProbe.
+ * @param memory The memory of the game process.
  * @param length The number of integers to print.
  */
-void MemoryProbe::PrintInts(int length) {
+void MemoryProbe::PrintInts(ProcessMemory &memory, int length) {
     std::vector<int> values(length);
-	if (!Utils::ReadMemoryToBuffer(GameState::GetHandle(), address, values.data(), values.size() * sizeof(int))) {
+	if (!memory.Read(address, values.data(), values.size() * sizeof(int))) {
         std::cout << "Error: Could not read from process memory. Line: " << __LINE__ << std::endl;
         return;
     }
@@ -26,11 +37,12 @@ void MemoryProbe::PrintInts(int length) {
 
 /**
  * Prints the byte values starting at the address of this MemoryProbe.
+ * @param memory The memory of the game process.
  * @param length The number of bytes to print.
  */
-void MemoryProbe::PrintBytes(int length) {
+void MemoryProbe::PrintBytes(ProcessMemory &memory, int length) {
     std::vector<BYTE> values(length);
-	if (!Utils::ReadMemoryToBuffer(GameState::GetHandle(), address, values.data(), values.size() * sizeof(BYTE))) {
+	if (!memory.Read(address, values.data(), values.size() * sizeof(BYTE))) {
         std::cout << "Error: Could not read from process memory. Line: " << __LINE__ << std::endl;
         return;
     }
@@ -42,11 +54,12 @@ void MemoryProbe::PrintBytes(int length) {
 
 /**
  * Prints the float values starting at the address of this MemoryProbe.
+ * @param memory The memory of the game process.
  * @param length The number of floats to print.
  */
-void MemoryProbe::PrintFloats(int length) {
+void MemoryProbe::PrintFloats(ProcessMemory &memory, int length) {
 	std::vector<float> values(length);
-	if (!Utils::ReadMemoryToBuffer(GameState::GetHandle(), address, values.data(), values.size() * sizeof(float))) {
+	if (!memory.Read(address, values.data(), values.size() * sizeof(float))) {
         std::cout << "Error: Could not read from process memory. Line: " << __LINE__ << std::endl;
         return;
     }
@@ -57,266 +70,296 @@ void MemoryProbe::PrintFloats(int length) {
 }
 
 /**
- * Checks if the address still points to a valid simple item.
- * @param hProcess The handle to the process.
+ * @internal
+ * Reads a field of type @c T at the given offset of a raw object block.
  */
-bool SimpleItem::isValid(HANDLE hProcess) {
+template<typename T>
+static T ReadField(const BYTE *raw, SIZE_T offset) {
+    T value;
+    memcpy(&value, raw + offset, sizeof(value));
+    return value;
+}
 
-    int values[18];
-    if (!Utils::ReadMemoryToBuffer(hProcess, address, &values, sizeof(values))) {
+/**
+ * Reads and decodes a simple item with a single read.
+ * @param memory The memory of the game process.
+ * @param address The address of the item.
+ * @return Whether the item could be read.
+ */
+bool SimpleItemSnapshot::Read(ProcessMemory &memory, DWORD address) {
+    BYTE raw[SIZE];
+    if (!memory.Read(address, raw, sizeof(raw))) {
         return false;
     }
-    if (values[17] != 0) {
+    vtable = ReadField<DWORD>(raw, 0x0);
+    x = ReadField<float>(raw, 0x24);
+    y = ReadField<float>(raw, 0x28);
+    itemId = ReadField<int>(raw, 0x2C);
+    ingredientId = ReadField<int>(raw, 0x30);
+    conveyorIndex = ReadField<int>(raw, 0x38);
+    terminator = ReadField<int>(raw, 0x44);
+    // The vtable and the contiguous block from x to the conveyor index
+    hash = Hash::Bytes(raw + 0x24, 0x3C - 0x24, Hash::Bytes(raw, sizeof(DWORD)));
+    return true;
+}
+
+/**
+ * Reads and decodes a complex item with a single read.
+ * @param memory The memory of the game process.
+ * @param address The address of the item.
+ * @return Whether the item could be read.
+ */
+bool ComplexItemSnapshot::Read(ProcessMemory &memory, DWORD address) {
+    BYTE raw[SIZE];
+    if (!memory.Read(address, raw, sizeof(raw))) {
         return false;
     }
-    int typeValue;
-    if (!Utils::ReadMemoryToBuffer(hProcess, values[0], &typeValue, sizeof(typeValue))) {
+    vtable = ReadField<DWORD>(raw, 0x0);
+    x = ReadField<float>(raw, 0x24);
+    y = ReadField<float>(raw, 0x28);
+    conveyorIndex = ReadField<int>(raw, 0x38);
+    itemCount = ReadField<int>(raw, 0x58);
+    itemList = ReadField<DWORD>(raw, 0x78);
+    hash = Hash::Bytes(raw, sizeof(DWORD));
+    hash = Hash::Bytes(raw + 0x24, 0x3C - 0x24, hash);
+    hash = Hash::Bytes(raw + 0x58, sizeof(int), hash);
+    hash = Hash::Bytes(raw + 0x78, sizeof(DWORD), hash);
+    return true;
+}
+
+/**
+ * Reads the addresses of the sub-items with a single read.
+ * @param memory The memory of the game process.
+ * @param addresses (out) The addresses. Must have room for MAX_ITEMS entries.
+ * @return The number of sub-items, or 0 if the item count is out of range or the list could not be read.
+ */
+int ComplexItemSnapshot::ReadItemAddresses(ProcessMemory &memory, DWORD *addresses) const {
+    if (itemCount <= 0 || itemCount > MAX_ITEMS) {
+        return 0;
+    }
+    if (!memory.Read(itemList, addresses, itemCount * sizeof(DWORD))) {
+        std::cout << "Error: Could not read from process memory. Line: " << __LINE__ << std::endl;
+        return 0;
+    }
+    return itemCount;
+}
+
+/**
+ * Re-reads the snapshot of this item. All getters are served from the snapshot until the next refresh.
+ * @param memory The memory of the game process.
+ * @return Whether the item could be read.
+ */
+bool SimpleItem::Refresh(ProcessMemory &memory) {
+    hasSnapshot = snapshot.Read(memory, address);
+    return hasSnapshot;
+}
+
+/**
+ * Gets the snapshot of this item, reading it if it has not been read yet.
+ * @param memory The memory of the game process.
+ * @return The snapshot, or @c nullptr if the item could not be read.
+ */
+const SimpleItemSnapshot *SimpleItem::GetSnapshot(ProcessMemory &memory) {
+    if (!hasSnapshot && !Refresh(memory)) {
+        return nullptr;
+    }
+    return &snapshot;
+}
+
+/**
+ * Checks if the address still points to a valid simple item. This refreshes the snapshot.
+ * @param memory The memory of the game process.
+ */
+bool SimpleItem::isValid(ProcessMemory &memory) {
+    if (!Refresh(memory)) {
         return false;
     }
-    int actualValue;
-    if (!Utils::ReadMemoryToBuffer(hProcess, typeValue + 0x4, &actualValue, sizeof(actualValue))) {
+    if (snapshot.terminator != 0) {
         return false;
     }
-    return actualValue == 1317794187;
+    return TypeCache::Classify(memory, snapshot.vtable) == ObjectKind::Simple;
 }
 
 /**
  * Gets the item id of this item.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @return The item id.
  */
-int SimpleItem::GetItemId(HANDLE hProcess) {
-    if (_itemId != -1) {
-        return _itemId;
-    }
-    int value;
-    if (!Utils::ReadMemoryToBuffer(hProcess, address + 0x2C, &value, sizeof(value))) {
-        return -1;
-    }
-    _itemId = value;
-    return value;
+int SimpleItem::GetItemId(ProcessMemory &memory) {
+    const SimpleItemSnapshot *current = GetSnapshot(memory);
+    return current != nullptr ? current->itemId : -1;
 }
 
 /**
  * Gets the ingredient id of this item.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @return The ingredient id.
  */
-int SimpleItem::GetIngredientId(HANDLE hProcess) {
-    if (_ingredientId != -1) {
-        return _ingredientId;
-    }
-    int value;
-    if (!Utils::ReadMemoryToBuffer(hProcess, address + 0x30, &value, sizeof(value))) {
-        return -1;
-    }
-    _ingredientId = value;
-    return value;
+int SimpleItem::GetIngredientId(ProcessMemory &memory) {
+    const SimpleItemSnapshot *current = GetSnapshot(memory);
+    return current != nullptr ? current->ingredientId : -1;
 }
 
 /**
  * Gets the conveyor index of this item.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @return The conveyor index.
  */
-int SimpleItem::GetConveyorIndex(HANDLE hProcess) {
-    int value;
-    if (!Utils::ReadMemoryToBuffer(hProcess, address + 0x38, &value, sizeof(value))) {
-        return -1;
-    }
-    return value;
+int SimpleItem::GetConveyorIndex(ProcessMemory &memory) {
+    const SimpleItemSnapshot *current = GetSnapshot(memory);
+    return current != nullptr ? current->conveyorIndex : -1;
 }
 
 /**
  * Gets the name of this item.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @return The name of this item.
  */
-std::string SimpleItem::GetName(HANDLE hProcess) {
-    int id = GetItemId(hProcess);
+std::string_view SimpleItem::GetName(ProcessMemory &memory) {
+    int id = GetItemId(memory);
     return ItemManager::GetItemName(id);
 }
 
 /**
  * Gets the ingredient name of this item.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @return The ingredient name of this item.
  */
-std::string SimpleItem::GetIngredientName(HANDLE hProcess) {
-    int id = GetIngredientId(hProcess);
+std::string_view SimpleItem::GetIngredientName(ProcessMemory &memory) {
+    int id = GetIngredientId(memory);
     return ItemManager::GetItemName(id);
 }
 
 /**
  * Gets the x coordinate of this item.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @return The x coordinate.
  */
-float SimpleItem::GetX(HANDLE hProcess) {
-    float value;
-    if (!Utils::ReadMemoryToBuffer(hProcess, address + 0x24, &value, sizeof(value))) {
-        return -1;
-    }
-    return value;
+float SimpleItem::GetX(ProcessMemory &memory) {
+    const SimpleItemSnapshot *current = GetSnapshot(memory);
+    return current != nullptr ? current->x : -1;
 }
 
 /**
  * Gets the y coordinate of this item.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @return The y coordinate.
  */
-float SimpleItem::GetY(HANDLE hProcess) {
-    float value;
-    if (!Utils::ReadMemoryToBuffer(hProcess, address + 0x28, &value, sizeof(value))) {
-        return -1;
-    }
-    return value;
+float SimpleItem::GetY(ProcessMemory &memory) {
+    const SimpleItemSnapshot *current = GetSnapshot(memory);
+    return current != nullptr ? current->y : -1;
 }
 
 /**
  * Gets the position of this item.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @return The position.
  */
-std::pair<float, float> SimpleItem::GetPos(HANDLE hProcess) {
-    return std::make_pair(GetX(hProcess), GetY(hProcess));
-}
-
-/**
- * Gets the x coordinate of the mouse position of this item.
- * @param hProcess The handle to the process.
- * @return The x coordinate of the mouse position.
- */
-float SimpleItem::GetMouseX(HANDLE hProcess) {
-    std::pair<float, float> pos = GetMousePos(hProcess);
-    return pos.first;
-}
-
-/**
- * Gets the y coordinate of the mouse position of this item.
- * @param hProcess The handle to the process.
- * @return The y coordinate of the mouse position.
- */
-float SimpleItem::GetMouseY(HANDLE hProcess) {
-    std::pair<float, float> pos = GetMousePos(hProcess);
-    return pos.second;
-}
-
-/**
- * Gets the mouse position of this item.
- * @param hProcess The handle to the process.
- * @return The mouse position.
- */
-std::pair<float, float> SimpleItem::GetMousePos(HANDLE hProcess) {
-    return Utils::GamePosToMouseAbsolute(GameState::GetWindowHandle(), GetX(hProcess), GetY(hProcess));
+std::pair<float, float> SimpleItem::GetPos(ProcessMemory &memory) {
+    return std::make_pair(GetX(memory), GetY(memory));
 }
 
 /**
  * Sets the item id of this item.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @param value The new item id.
  */
-void SimpleItem::SetItemId(HANDLE hProcess, int value) {
+void SimpleItem::SetItemId(ProcessMemory &memory, int value) {
     if (value < 0 || value >= ItemManager::GetNumItems()) {
         return;
     }
-    if (!Utils::WriteBufferToProcessMemory(hProcess, address + 0x2C, &value, sizeof(value))) {
+    if (!memory.Write(address + 0x2C, &value, sizeof(value))) {
         std::cout << "Error: Could not write to process memory. Line: " << __LINE__ << std::endl;
         return;
     }
-    _itemId = value;
+    snapshot.itemId = value;
 }
 
 /**
  * Sets the ingredient id of this item.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @param value The new ingredient id.
  */
-void SimpleItem::SetIngredientId(HANDLE hProcess, int value) {
+void SimpleItem::SetIngredientId(ProcessMemory &memory, int value) {
     if (value < 0 || value >= ItemManager::GetNumItems()) {
         return;
     }
-    if (!Utils::WriteBufferToProcessMemory(hProcess, address + 0x30, &value, sizeof(value))) {
+    if (!memory.Write(address + 0x30, &value, sizeof(value))) {
         std::cout << "Error: Could not write to process memory. Line: " << __LINE__ << std::endl;
         return;
     }
-    _ingredientId = value;
+    snapshot.ingredientId = value;
 }
 
 /**
- * Determines if this item has changed since the last call to this function.
+ * Determines if this item has changed since the last call to this function, and advances the generation if it did.
+ * This refreshes the snapshot.
+ * @param memory The memory of the game process.
  * @return @c true if this item has changed, @c false otherwise.
  */
-bool SimpleItem::HasChanged() {
-    int newHash = 0;
-    newHash += GetItemId(GameState::GetHandle());
-    newHash += GetIngredientId(GameState::GetHandle());
-    newHash += GetConveyorIndex(GameState::GetHandle());
-    newHash += GetX(GameState::GetHandle());
-    newHash += GetY(GameState::GetHandle());
+bool SimpleItem::HasChanged(ProcessMemory &memory) {
+    uint64_t newHash = Refresh(memory) ? snapshot.hash : 0;
     if (newHash != hash) {
         hash = newHash;
+        generation++;
         return true;
     }
     return false;
 }
 
 /**
- * Checks if the address still points to a valid complex item.
- * @param hProcess The handle to the process.
+ * Re-reads the snapshot of this item. All getters are served from the snapshot until the next refresh.
+ * @param memory The memory of the game process.
+ * @return Whether the item could be read.
  */
-bool ComplexItem::isValid(HANDLE hProcess) {
-    if (address == 0) {
-        return false;
-    }
-    int values[32];
-    if (!Utils::ReadMemoryToBuffer(hProcess, address, &values, sizeof(values))) {
-        return false;
+bool ComplexItem::Refresh(ProcessMemory &memory) {
+    hasSnapshot = snapshot.Read(memory, address);
+    return hasSnapshot;
+}
+
+/**
+ * Gets the snapshot of this item, reading it if it has not been read yet.
+ * @param memory The memory of the game process.
+ * @return The snapshot, or @c nullptr if the item could not be read.
+ */
+const ComplexItemSnapshot *ComplexItem::GetSnapshot(ProcessMemory &memory) {
+    if (!hasSnapshot && !Refresh(memory)) {
+        return nullptr;
     }
-    int type = values[0];
-    int typeValue;
-    if (!Utils::ReadMemoryToBuffer(hProcess, type, &typeValue, sizeof(typeValue))) {
+    return &snapshot;
+}
+
+/**
+ * Checks if the address still points to a valid complex item. This refreshes the snapshot.
+ * @param memory The memory of the game process.
+ */
+bool ComplexItem::isValid(ProcessMemory &memory) {
+    if (address == 0) {
         return false;
     }
-    int actualValue;
-    if (!Utils::ReadMemoryToBuffer(hProcess, typeValue + 0x4, &actualValue, sizeof(actualValue))) {
+    if (!Refresh(memory)) {
         return false;
     }
-    return actualValue == 113766795;
+    return TypeCache::Classify(memory, snapshot.vtable) == ObjectKind::Complex;
 }
 
 /**
  * Gets the sub-items of this complex item.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @return The sub-items.
  */
-std::list<SimpleItem> ComplexItem::GetItems(HANDLE hProcess) {
-    int values[32];
-    if (!Utils::ReadMemoryToBuffer(hProcess, address, &values, sizeof(values))) {
+std::list<SimpleItem> ComplexItem::GetItems(ProcessMemory &memory) {
+    const ComplexItemSnapshot *current = GetSnapshot(memory);
+    if (current == nullptr) {
         return {};
     }
-    // Validate
-    int type = values[0];
-    int typeValue;
-    if (!Utils::ReadMemoryToBuffer(hProcess, type, &typeValue, sizeof(typeValue))) {
-        return {};
-    }
-    int actualValue;
-    if (!Utils::ReadMemoryToBuffer(hProcess, typeValue + 0x4, &actualValue, sizeof(actualValue))) {
-        return {};
-    }
-    if (actualValue != 113766795) {
-        return {};
-    }
-    int listAddress = values[30];
-    int size = values[22];
-	std::vector<int> itemAddresses(size);
-	if (!Utils::ReadMemoryToBuffer(hProcess, listAddress, itemAddresses.data(), itemAddresses.size() * sizeof(int))) {
-        std::cout << "Error: Could not read from process memory. Line: " << __LINE__ << std::endl;
+    if (TypeCache::Classify(memory, current->vtable) != ObjectKind::Complex) {
         return {};
     }
+    DWORD itemAddresses[ComplexItemSnapshot::MAX_ITEMS];
+    int itemCount = current->ReadItemAddresses(memory, itemAddresses);
     std::list<SimpleItem> subItems;
-    for (int i = 0; i < size; i++) {
+    for (int i = 0; i < itemCount; i++) {
         subItems.push_back(SimpleItem(itemAddresses[i]));
     }
     return subItems;
@@ -324,61 +367,65 @@ std::list<SimpleItem> ComplexItem::GetItems(HANDLE hProcess) {
 
 /**
  * Gets the conveyor index of this item.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @return The conveyor index.
  */
-int ComplexItem::GetConveyorIndex(HANDLE hProcess) {
-    int value;
-    if (!Utils::ReadMemoryToBuffer(hProcess, address + 0x38, &value, sizeof(value))) {
-        return -1;
-    }
-    return value;
+int ComplexItem::GetConveyorIndex(ProcessMemory &memory) {
+    const ComplexItemSnapshot *current = GetSnapshot(memory);
+    return current != nullptr ? current->conveyorIndex : -1;
 }
 
 /**
  * Gets the x coordinate of this item.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @return The x coordinate.
  */
-float ComplexItem::GetX(HANDLE hProcess) {
-    float value;
-    if (!Utils::ReadMemoryToBuffer(hProcess, address + 0x24, &value, sizeof(value))) {
-        return -1;
-    }
-    return value;
+float ComplexItem::GetX(ProcessMemory &memory) {
+    const ComplexItemSnapshot *current = GetSnapshot(memory);
+    return current != nullptr ? current->x : -1;
 }
 
 /**
  * Gets the y coordinate of this item.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @return The y coordinate.
  */
-float ComplexItem::GetY(HANDLE hProcess) {
-    float value;
-    if (!Utils::ReadMemoryToBuffer(hProcess, address + 0x28, &value, sizeof(value))) {
-        return -1;
-    }
-    return value;
+float ComplexItem::GetY(ProcessMemory &memory) {
+    const ComplexItemSnapshot *current = GetSnapshot(memory);
+    return current != nullptr ? current->y : -1;
 }
 
 /**
- * Determines if this item has changed since the last call to this function.
- * @return @c true if this item has changed, @c false otherwise.
+ * Determines if this item has changed since the last call to this function, and advances the generation if it did.
+ * This refreshes the snapshot.
+ * @param memory The memory of the game process.
+ * @return @c true if this item has changed or one of its sub-items could not be read, @c false otherwise.
  */
-bool ComplexItem::HasChanged() {
-    int newHash = 0;
-    std::list<SimpleItem> items = GetItems(GameState::GetHandle());
-    for (SimpleItem item: items) {
-        newHash += item.GetItemId(GameState::GetHandle());
-        newHash += item.GetIngredientId(GameState::GetHandle());
-        newHash += item.GetConveyorIndex(GameState::GetHandle());
-        newHash += item.GetX(GameState::GetHandle());
-        newHash += item.GetY(GameState::GetHandle());
-    }
-    newHash += GetX(GameState::GetHandle());
-    newHash += GetY(GameState::GetHandle());
+bool ComplexItem::HasChanged(ProcessMemory &memory) {
+    uint64_t newHash = 0;
+    bool unreadable = false;
+    if (Refresh(memory)) {
+        newHash = snapshot.hash;
+        DWORD itemAddresses[ComplexItemSnapshot::MAX_ITEMS];
+        int itemCount = snapshot.ReadItemAddresses(memory, itemAddresses);
+        for (int i = 0; i < itemCount; i++) {
+            SimpleItemSnapshot item;
+            if (!item.Read(memory, itemAddresses[i])) {
+                unreadable = true;
+                break;
+            }
+            newHash = Hash::Combine(newHash, item.hash);
+        }
+    }
+    if (unreadable) {
+        // Without the sub-item the hash says nothing, so the item is treated as changed until it can be read again
+        hash = 0;
+        generation++;
+        return true;
+    }
     if (newHash != hash) {
         hash = newHash;
+        generation++;
         return true;
     }
     return false;
@@ -386,65 +433,46 @@ bool ComplexItem::HasChanged() {
 
 /**
  * Gets the item this ItemInfo points to.
+ * @param memory The memory of the game process.
  * @return The item.
  */
-std::unique_ptr<ItemBase> ItemInfo::GetItem() {
+std::unique_ptr<ItemBase> ItemInfo::GetItem(ProcessMemory &memory) {
     if (mItem == 0) {
         return nullptr;
     }
-    int values[32];
-    if (!Utils::ReadMemoryToBuffer(GameState::GetHandle(), mItem, &values, sizeof(values))) {
-        std::cout << "Error: Could not read from process memory. Line: " << __LINE__ << std::endl;
-        return nullptr;
-    }
-    int type = values[0];
-    int typeValue;
-    if (!Utils::ReadMemoryToBuffer(GameState::GetHandle(), type, &typeValue, sizeof(typeValue))) {
-        std::cout << "Error: Could not read from process memory. Line: " << __LINE__ << std::endl;
-        return nullptr;
-    }
-    int actualValue;
-    if (!Utils::ReadMemoryToBuffer(GameState::GetHandle(), typeValue + 0x4, &actualValue, sizeof(actualValue))) {
+    DWORD vtable;
+    if (!memory.Read(mItem, &vtable, sizeof(vtable))) {
         std::cout << "Error: Could not read from process memory. Line: " << __LINE__ << std::endl;
         return nullptr;
     }
-    if (actualValue == 1317794187) {
-        return std::make_unique<SimpleItem>(mItem);
-    } else if (actualValue == 113766795) {
-        return std::make_unique<ComplexItem>(mItem);
+    switch (TypeCache::Classify(memory, vtable)) {
+        case ObjectKind::Simple:
+            return std::make_unique<SimpleItem>(mItem);
+        case ObjectKind::Complex:
+            return std::make_unique<ComplexItem>(mItem);
+        default:
+            return nullptr;
     }
-    return nullptr;
 }
 
 /**
  * Checks if the address still points to a valid customer.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  */
-bool Customer::isValid(HANDLE hProcess) {
-    int value;
-    if (!Utils::ReadMemoryToBuffer(hProcess, address, &value, sizeof(value))) {
-        return false;
-    }
-    int typeValue;
-    if (!Utils::ReadMemoryToBuffer(hProcess, value, &typeValue, sizeof(typeValue))) {
-        return false;
-    }
-    int actualValue;
-    if (!Utils::ReadMemoryToBuffer(hProcess, typeValue + 0x4, &actualValue, sizeof(actualValue))) {
-        return false;
-    }
-    return actualValue == 113766795;
+bool Customer::isValid(ProcessMemory &memory) {
+    // Customers share the signature of complex items
+    return TypeCache::ClassifyObject(memory, address) == ObjectKind::Complex;
 }
 
 /**
  * Gets the id of this customer.
- * @param hProcess The handle to the process.
+ * @param memory The memory of the game process.
  * @return The id.
  * @note This isn't very useful, as the id always increments by 1 for each customer and seemingly never resets.
  */
-int Customer::GetId(HANDLE hProcess) {
+int Customer::GetId(ProcessMemory &memory) {
     int value;
-    if (!Utils::ReadMemoryToBuffer(hProcess, address + 0x488, &value, sizeof(value))) {
+    if (!memory.Read(address + 0x488, &value, sizeof(value))) {
         std::cout << "Error: Could not read from process memory. Line: " << __LINE__ << std::endl;
         return -1;
     }
@@ -453,27 +481,37 @@ int Customer::GetId(HANDLE hProcess) {
 
 /**
  * Gets the items ordered by this customer.
- * @param hProcess The handle to the process.
- * @return The items.
+ * The order vector is read with a single read, directly into @p items.
+ * @param memory The memory of the game process.
+ * @param items (out) The items. The buffer is reused, so its capacity carries over between calls.
+ * @return Whether the items could be read. On failure, @p items is empty.
  */
-std::list<ItemInfo> Customer::GetItems(HANDLE hProcess) {
-    std::list<ItemInfo> items;
-    DWORD vectorAddress;
-    if (!Utils::ReadMemoryToBuffer(hProcess, address + 0x15C, &vectorAddress, sizeof(vectorAddress))) {
+bool Customer::GetItems(ProcessMemory &memory, std::vector<ItemInfo> &items) {
+    items.clear();
+    DWORD bounds[2];
+    if (!memory.Read(address + 0x15C, &bounds, sizeof(bounds))) {
         std::cout << "Error: Could not read from process memory. Line: " << __LINE__ << std::endl;
+        return false;
     }
-    DWORD vectorEnd;
-    if (!Utils::ReadMemoryToBuffer(hProcess, address + 0x160, &vectorEnd, sizeof(vectorEnd))) {
-        std::cout << "Error: Could not read from process memory. Line: " << __LINE__ << std::endl;
+    DWORD vectorAddress = bounds[0];
+    DWORD vectorEnd = bounds[1];
+    if (vectorEnd < vectorAddress || (vectorEnd - vectorAddress) % sizeof(ItemInfo) != 0) {
+        std::cout << "Error: Corrupt order vector of customer " << address << std::endl;
+        return false;
     }
-    int vectorLength = (vectorEnd - vectorAddress) / 48;
-    for (int i = 0; i < vectorLength; i++) {
-        DWORD itemAddress = vectorAddress + i * 48;
-        ItemInfo itemInfo;
-        if (!Utils::ReadMemoryToBuffer(hProcess, itemAddress, &itemInfo, sizeof(itemInfo))) {
-            std::cout << "Error: Could not read from process memory. Line: " << __LINE__ << std::endl;
-        }
-        items.push_back(itemInfo);
+    DWORD vectorLength = (vectorEnd - vectorAddress) / sizeof(ItemInfo);
+    if (vectorLength > MAX_ORDER_ITEMS) {
+        std::cout << "Error: Corrupt order vector of customer " << address << std::endl;
+        return false;
+    }
+    if (vectorLength == 0) {
+        return true;
     }
-    return items;
-}
\ No newline at end of file
+    items.resize(vectorLength);
+    if (!memory.Read(vectorAddress, items.data(), vectorLength * sizeof(ItemInfo))) {
+        std::cout << "Error: Could not read from process memory. Line: " << __LINE__ << std::endl;
+        items.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,151 @@
+#include <ConveyorStore.h>
+
+/**
+ * Adds an item to the back of the conveyor.
+ * @param address The address of the item.
+ * @param kind The kind of the item.
+ * @return @c false if an item with this address is already on the conveyor.
+ */
+bool ConveyorStore::Insert(DWORD address, ObjectKind kind) {
+    if (index.find(address) != index.end()) {
+        return false;
+    }
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = slots.size();
+        slots.emplace_back();
+    }
+    slots[slot].address = address;
+    slots[slot].kind = kind;
+    slots[slot].hash = 0;
+    slots[slot].generation = 0;
+    Link(slot);
+    index[address] = slot;
+    return true;
+}
+
+/**
+ * Removes an item from the conveyor.
+ * @param address The address of the item.
+ * @return @c false if no item with this address is on the conveyor.
+ */
+bool ConveyorStore::Remove(DWORD address) {
+    auto it = index.find(address);
+    if (it == index.end()) {
+        return false;
+    }
+    uint32_t slot = it->second;
+    index.erase(it);
+    Unlink(slot);
+    freeSlots.push_back(slot);
+    return true;
+}
+
+/**
+ * Looks up an item by address.
+ * @param address The address of the item.
+ * @return The item, or @c nullptr if it is not on the conveyor. Only valid until the store is modified.
+ */
+const ConveyorSlot *ConveyorStore::Find(DWORD address) const {
+    auto it = index.find(address);
+    return it != index.end() ? &slots[it->second] : nullptr;
+}
+
+/**
+ * Returns the item that was added first.
+ * @return The item, or @c nullptr if the conveyor is empty. Only valid until the store is modified.
+ */
+const ConveyorSlot *ConveyorStore::Front() const {
+    return head != NONE ? &slots[head] : nullptr;
+}
+
+/**
+ * Moves an item to the back of the conveyor.
+ * @param address The address of the item.
+ * @return @c false if no item with this address is on the conveyor.
+ */
+bool ConveyorStore::MoveToBack(DWORD address) {
+    auto it = index.find(address);
+    if (it == index.end()) {
+        return false;
+    }
+    Unlink(it->second);
+    Link(it->second);
+    return true;
+}
+
+/**
+ * Stores the hash of an item's state, advancing the item's generation if the hash changed.
+ * @param address The address of the item.
+ * @param hash The new hash.
+ * @return @c true if the item is on the conveyor and its hash changed.
+ */
+bool ConveyorStore::UpdateHash(DWORD address, uint64_t hash) {
+    auto it = index.find(address);
+    if (it == index.end() || slots[it->second].hash == hash) {
+        return false;
+    }
+    slots[it->second].hash = hash;
+    slots[it->second].generation++;
+    return true;
+}
+
+/**
+ * Removes all items, keeping the allocated slots.
+ */
+void ConveyorStore::Clear() {
+    slots.clear();
+    freeSlots.clear();
+    index.clear();
+    head = NONE;
+    tail = NONE;
+}
+
+/**
+ * Returns the number of items on the conveyor.
+ * @return The number of items.
+ */
+size_t ConveyorStore::Size() const {
+    return index.size();
+}
+
+bool ConveyorStore::IsEmpty() const {
+    return index.empty();
+}
+
+/**
+ * @internal
+ * Appends a slot to the list.
+ */
+void ConveyorStore::Link(uint32_t slot) {
+    slots[slot].prev = tail;
+    slots[slot].next = NONE;
+    if (tail != NONE) {
+        slots[tail].next = slot;
+    } else {
+        head = slot;
+    }
+    tail = slot;
+}
+
+/**
+ * @internal
+ * Removes a slot from the list.
+ */
+void ConveyorStore::Unlink(uint32_t slot) {
+    uint32_t prev = slots[slot].prev;
+    uint32_t next = slots[slot].next;
+    if (prev != NONE) {
+        slots[prev].next = next;
+    } else {
+        head = next;
+    }
+    if (next != NONE) {
+        slots[next].prev = prev;
+    } else {
+        tail = prev;
+    }
+}
@@ -0,0 +1,94 @@
+#include <ConveyorTable.h>
+#include <Content.h>
+#include <Hash.h>
+
+/**
+ * Returns the number of items in the table.
+ * @return The number of items.
+ */
+size_t ConveyorTable::Size() const {
+    return address.size();
+}
+
+/**
+ * Empties the table, keeping the capacity of its columns.
+ */
+void ConveyorTable::Clear() {
+    Resize(0);
+    subItems.clear();
+}
+
+/**
+ * Resizes every column. New rows are uninitialized apart from the vector defaults.
+ * @param size The number of items.
+ */
+void ConveyorTable::Resize(size_t size) {
+    address.resize(size);
+    kind.resize(size);
+    itemId.resize(size);
+    ingredientId.resize(size);
+    conveyorIndex.resize(size);
+    x.resize(size);
+    y.resize(size);
+    firstSubItem.resize(size);
+    subItemCount.resize(size);
+    hash.resize(size);
+    generation.resize(size);
+}
+
+/**
+ * Decodes the item whose address and kind are in row @p from and stores it in row @p to.
+ * Rows can be compacted while decoding by passing <tt>to <= from</tt>.
+ * @param memory The memory of the game process.
+ * @param from The row to take the address and kind from.
+ * @param to The row to store the decoded item in.
+ * @return @c false if the address no longer points to an item of that kind. Row @p to is not modified in that case.
+ */
+bool ConveyorTable::Decode(ProcessMemory &memory, size_t from, size_t to) {
+    DWORD itemAddress = address[from];
+    ObjectKind itemKind = kind[from];
+    if (itemKind == ObjectKind::Simple) {
+        SimpleItemSnapshot item;
+        if (!item.Read(memory, itemAddress) || item.terminator != 0 ||
+            TypeCache::Classify(memory, item.vtable) != ObjectKind::Simple) {
+            return false;
+        }
+        itemId[to] = item.itemId;
+        ingredientId[to] = item.ingredientId;
+        conveyorIndex[to] = item.conveyorIndex;
+        x[to] = item.x;
+        y[to] = item.y;
+        subItemCount[to] = 0;
+        hash[to] = item.hash;
+    } else if (itemKind == ObjectKind::Complex) {
+        ComplexItemSnapshot item;
+        if (!item.Read(memory, itemAddress) || TypeCache::Classify(memory, item.vtable) != ObjectKind::Complex) {
+            return false;
+        }
+        itemId[to] = -1;
+        ingredientId[to] = -1;
+        conveyorIndex[to] = item.conveyorIndex;
+        x[to] = item.x;
+        y[to] = item.y;
+        uint64_t itemHash = item.hash;
+        DWORD subItemAddresses[ComplexItemSnapshot::MAX_ITEMS];
+        int count = item.ReadItemAddresses(memory, subItemAddresses);
+        for (int i = 0; i < count; i++) {
+            SimpleItemSnapshot subItem;
+            if (!subItem.Read(memory, subItemAddresses[i])) {
+                subItem = SimpleItemSnapshot();
+            }
+            subItems.push_back({subItemAddresses[i], subItem.itemId, subItem.ingredientId});
+            itemHash = Hash::Combine(itemHash, subItem.hash);
+        }
+        subItemCount[to] = count;
+        hash[to] = itemHash;
+    } else {
+        return false;
+    }
+    firstSubItem[to] = subItems.size() - subItemCount[to];
+    address[to] = itemAddress;
+    kind[to] = itemKind;
+    generation[to] = 0;
+    return true;
+}
@@ -0,0 +1,195 @@
+#include <Managers.h>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "pugixml.hpp"
+
+// What GetItemData returns for ids the catalog does not have
+static const ItemData NO_ITEM = {0, 0, -1, -1, -1, -1, ItemType::None};
+
+/**
+ * @internal
+ * Parses the type attribute of an item.
+ */
+static ItemType ParseType(std::string_view type) {
+    if (type == "Conveyor") {
+        return ItemType::Conveyor;
+    }
+    if (type == "Machine") {
+        return ItemType::Machine;
+    }
+    return ItemType::None;
+}
+
+/**
+ * @internal
+ * Returns the id of the item a transformation attribute names, or -1 if it is empty or names no item.
+ */
+static int16_t FindTarget(const std::unordered_map<std::string_view, int16_t> &ids, std::string_view name) {
+    auto it = ids.find(name);
+    return it != ids.end() ? it->second : -1;
+}
+
+/**
+ * Loads the item data from the specified file, replacing the catalog loaded before.
+ * @param filename The filename to load the item names from.
+ * @return Whether the item names were loaded successfully. If not, the previous catalog stays.
+ */
+bool ItemManager::LoadItems(const std::string &filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cout << "Error: Could not open file." << std::endl;
+        return false;
+    }
+    pugi::xml_document doc;
+    pugi::xml_parse_result result = doc.load(file);
+    if (!result) {
+        std::cout << "Error: " << result.description() << std::endl;
+        return false;
+    }
+    pugi::xml_node root = doc.child("Food");
+    if (!root) {
+        std::cout << "Error: Could not find root node." << std::endl;
+        return false;
+    }
+    std::vector<ItemData> loaded;
+    std::string pool;
+    for (pugi::xml_node item: root.children("Item")) {
+        int id = item.attribute("id").as_int(-1);
+        std::string_view name = item.attribute("name").as_string();
+        if (id < 0 || id > INT16_MAX || name.size() > UINT16_MAX) {
+            std::cout << "Error: Invalid item " << id << " in " << filename << std::endl;
+            return false;
+        }
+        if (id >= (int) loaded.size()) {
+            loaded.resize(id + 1, NO_ITEM);
+        }
+        loaded[id] = {(uint32_t) pool.size(), (uint16_t) name.size(), (int16_t) id, -1, -1, -1,
+                      ParseType(item.attribute("type").as_string())};
+        pool.append(name);
+    }
+    // The transformations name their targets, which may come later in the file. Of items with the same name, the
+    // lowest id is the target
+    std::unordered_map<std::string_view, int16_t> ids;
+    for (const ItemData &data: loaded) {
+        if (data.id >= 0) {
+            ids.emplace(std::string_view(pool).substr(data.nameOffset, data.nameLength), data.id);
+        }
+    }
+    for (pugi::xml_node item: root.children("Item")) {
+        ItemData &data = loaded[item.attribute("id").as_int()];
+        data.oven = FindTarget(ids, item.attribute("oven").as_string());
+        data.pot = FindTarget(ids, item.attribute("pot").as_string());
+        data.pan = FindTarget(ids, item.attribute("pan").as_string());
+    }
+    items = std::move(loaded);
+    namePool = std::move(pool);
+    return true;
+}
+
+/**
+ * Returns the name of the item with the specified ID.
+ * @param id The ID of the item.
+ * @return The name of the item with the specified ID, or "Unknown" if the catalog has no such item.
+ */
+std::string_view ItemManager::GetItemName(int id) {
+    if (id < 0 || id >= (int) items.size() || items[id].id < 0) {
+        return "Unknown";
+    }
+    return std::string_view(namePool.data() + items[id].nameOffset, items[id].nameLength);
+}
+
+/**
+ * Returns the data of the item with the specified ID.
+ * @param id The ID of the item.
+ * @return The data of the item with the specified ID, with an id of -1 if the catalog has no such item.
+ */
+const ItemData &ItemManager::GetItemData(int id) {
+    if (id < 0 || id >= (int) items.size()) {
+        return NO_ITEM;
+    }
+    return items[id];
+}
+
+/**
+ * Returns the number of item ids, one more than the highest id in the catalog.
+ * @return The number of item ids.
+ */
+int ItemManager::GetNumItems() {
+    return items.size();
+}
+
+/**
+ * Loads the item names and data.
+ * @return Whether the item names and data were loaded successfully.
+ */
+bool ItemManager::LoadContent() {
+    if (!ItemManager::LoadItems("resources/food.xml")) {
+        return false;
+    }
+    return true;
+}
+
+int ItemManager::IngredientLimit(int id) {
+    switch (id) {
+        case 4:
+        case 37:
+        case 38:
+        case 39:
+        case 42:
+        case 48:
+        case 57:
+        case 129:
+        case 130:
+        case 150:
+        case 155:
+            return 1;
+        default:
+            if (id >= 234){
+                return 0;
+            }
+            return -1;
+    }
+}
+
+/**
+ * Returns where an ingredient goes in the stack of an order.
+ * @param id The ingredient id.
+ * @return The stacking layer. Containers and bottom buns are bases, the top bun is a top.
+ */
+StackingLayer ItemManager::GetStackingLayer(int id) {
+    switch (id) {
+        case 1:   // BottomBun
+        case 17:  // SnackTray
+        case 19:  // Bowl
+        case 20:  // CoffeeMug
+        case 21:  // TeaCup
+        case 23:  // MexSideTray
+        case 24:  // Plate
+        case 25:  // SundaeDish
+        case 26:  // SmallDrinkCont
+        case 27:  // LargeDrinkCont
+        case 28:  // Glass
+        case 29:  // SmallSideCont
+        case 30:  // LargeSideCont
+        case 31:  // LargeSundaeCont
+        case 32:  // Ramekin
+        case 119: // IceCreamCone
+        case 125: // Basket
+        case 140: // PizzaCrust
+        case 155: // Saucer
+        case 157: // SushiTray
+        case 204: // TortillaBowl
+            return StackingLayer::Base;
+        case 8:   // TopBun
+            return StackingLayer::Top;
+        default:
+            return StackingLayer::Filling;
+    }
+}
+
+std::vector<ItemData> ItemManager::items;
+std::string ItemManager::namePool;
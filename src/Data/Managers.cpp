@@ -1,5 +1,4 @@
 #include <Content.h>
-#include <Utils.h>
 #include <unordered_map>
 #include <fstream>
 #include <iostream>
@@ -9,22 +8,43 @@
 #include <list>
 #include <vector>
 #include <functional>
-#include <Debugging.h>
 #include <Managers.h>
+#include <TypeCache.h>
+#include <PageCache.h>
+#include <World.h>
+#include <Feasibility.h>
+#include <Scheduler.h>
+#include <MotionPredictor.h>
+#include <ConveyorStore.h>
+#include <Sequence.h>
+#include <Recorder.h>
 #include <string>
-#include "pugixml.hpp"
+#include <chrono>
+#include <algorithm>
+
+#ifdef _WIN32
+
+#include <Utils.h>
+
+#endif
 
 float GameState::bbPercent = 0.0f;
 int GameState::numConveyorItems = 0;
-std::vector<std::unique_ptr<ItemBase>> GameState::conveyorItems;
+ConveyorStore GameState::conveyorItems;
 std::vector<Customer> GameState::customers;
 bool GameState::dirty = false;
+ChangeSignal GameState::stateSignal;
+ChangeSignal GameState::wakeSignal;
+TickClock GameState::tickClock;
+std::atomic<uint64_t> GameState::ordersHash{0};
+std::atomic<uint64_t> GameState::levelCount{0};
 bool GameState::needsSorting = false;
 HANDLE GameState::handle = NULL;
+std::unique_ptr<ProcessMemory> GameState::memory;
+std::unique_ptr<PageCache> GameState::pageCache;
+std::unique_ptr<ProcessMemory> GameState::recordedMemory;
+std::unique_ptr<Actuator> GameState::actuator;
 HWND GameState::windowHandle = NULL;
-int GameState::timeWithNoCustomers = 30;
-
-bool botRetryFlag = false;
 
 std::mutex GameState::conveyorItemsMutex;
 std::mutex GameState::customersMutex;
@@ -46,46 +66,39 @@ float GameState::GetNumConveyorItems() {
 }
 
 /**
- * Returns a copy of the conveyor items.
- * @return A copy of the conveyor items.
- * @note This function is thread-safe, but locks the conveyor items mutex.
+ * Decodes the conveyor items into a table. Items that are no longer valid are removed from the conveyor.
+ * @param table (out) The conveyor items, in conveyor order.
+ * @note This function is thread-safe, but locks the conveyor items mutex. Items are decoded outside the lock.
  */
-std::vector<std::unique_ptr<ItemBase>> GameState::GetConveyorItems() {
-    std::lock_guard<std::mutex> lock(conveyorItemsMutex);
-    std::vector<std::unique_ptr<ItemBase>> items;
-    int i = 0;
-    for (int i = conveyorItems.size() - 1; i >= 0; i--) {
-        std::unique_ptr<ItemBase> &item = conveyorItems[i];
-        if (item.get() == nullptr) {
-            conveyorItems.erase(conveyorItems.begin() + i);
-        }
-    }
-    std::vector<std::unique_ptr<ItemBase>> removedItems = std::vector<std::unique_ptr<ItemBase>>();
-    for (const std::unique_ptr<ItemBase> &item: conveyorItems) {
-        if (SimpleItem * singleItem = dynamic_cast<SimpleItem *>(item.get())) {
-            if (singleItem->isValid(handle)) {
-                items.push_back(std::make_unique<SimpleItem>(*singleItem));
-            } else {
-                removedItems.push_back(std::make_unique<SimpleItem>(*singleItem));
-            }
-        } else if (ComplexItem * multiItem = dynamic_cast<ComplexItem *>(item.get())) {
-            if (multiItem->isValid(handle)) {
-                items.push_back(std::make_unique<ComplexItem>(*multiItem));
-            } else {
-                removedItems.push_back(std::make_unique<ComplexItem>(*multiItem));
-            }
+void GameState::GetConveyorItems(ConveyorTable &table) {
+    table.Clear();
+    {
+        std::lock_guard<std::mutex> lock(conveyorItemsMutex);
+        conveyorItems.ForEach([&table](const ConveyorSlot &slot) {
+            table.address.push_back(slot.address);
+            table.kind.push_back(slot.kind);
+        });
+    }
+    size_t numItems = table.address.size();
+    table.Resize(numItems);
+    std::vector<DWORD> removedItems;
+    size_t numValid = 0;
+    for (size_t i = 0; i < numItems; i++) {
+        DWORD address = table.address[i];
+        if (table.Decode(GetMemory(), i, numValid)) {
+            numValid++;
+        } else {
+            removedItems.push_back(address);
         }
-        i++;
     }
-    for (std::unique_ptr<ItemBase> &item: removedItems) {
-        for (int i = 0; i < conveyorItems.size(); i++) {
-            if (conveyorItems[i]->GetAddress() == item->GetAddress()) {
-                conveyorItems.erase(conveyorItems.begin() + i);
-                break;
-            }
+    table.Resize(numValid);
+    if (!removedItems.empty()) {
+        std::lock_guard<std::mutex> lock(conveyorItemsMutex);
+        for (DWORD address: removedItems) {
+            conveyorItems.Remove(address);
         }
+        MarkChanged();
     }
-    return items;
 }
 
 /**
@@ -96,7 +109,7 @@ std::vector<std::unique_ptr<ItemBase>> GameState::GetConveyorItems() {
 std::vector<Customer> GameState::GetCustomers() {
     std::lock_guard<std::mutex> lock(customersMutex);
     for (int i = customers.size() - 1; i >= 0; i--) {
-        if (!customers[i].isValid(handle)) {
+        if (!customers[i].isValid(GetMemory())) {
             customers.erase(customers.begin() + i);
         }
     }
@@ -112,6 +125,17 @@ bool GameState::IsDirty() {
     return dirty;
 }
 
+/**
+ * Returns whether an item is on the conveyor.
+ * @param address The address of the item.
+ * @return Whether the item is on the conveyor.
+ * @note This function is thread-safe, but locks the conveyor items mutex.
+ */
+bool GameState::HasConveyorItem(DWORD address) {
+    std::lock_guard<std::mutex> lock(conveyorItemsMutex);
+    return conveyorItems.Find(address) != nullptr;
+}
+
 /**
  * Returns the handle to the game process.
  * @return The handle to the game process.
@@ -120,6 +144,39 @@ HANDLE GameState::GetHandle() {
     return handle;
 }
 
+/**
+ * Returns the memory of the game process, as seen through the per-tick page cache.
+ * @return The memory of the game process.
+ */
+ProcessMemory &GameState::GetMemory() {
+    return *pageCache;
+}
+
+/**
+ * Returns the memory of the game process without the page cache.
+ * @return The memory of the game process.
+ * @note Use this for reads that must see the latest state, e.g. in breakpoint callbacks.
+ */
+ProcessMemory &GameState::GetDirectMemory() {
+    return recordedMemory != nullptr ? *recordedMemory : *memory;
+}
+
+/**
+ * Returns the page cache in front of the memory of the game process.
+ * @return The page cache.
+ */
+PageCache &GameState::GetPageCache() {
+    return *pageCache;
+}
+
+/**
+ * Returns the actuator that sends input to the game.
+ * @return The actuator.
+ */
+Actuator &GameState::GetActuator() {
+    return *actuator;
+}
+
 /**
  * Returns the handle to the game window.
  * @return The handle to the game window.
@@ -135,7 +192,7 @@ HWND GameState::GetWindowHandle() {
 void GameState::SetBBPercent(float value) {
     if (bbPercent != value) {
         bbPercent = value;
-        dirty = true;
+        MarkChanged();
     }
 }
 
@@ -146,7 +203,7 @@ void GameState::SetBBPercent(float value) {
 void GameState::SetNumConveyorItems(int value) {
     if (numConveyorItems != value) {
         numConveyorItems = value;
-        dirty = true;
+        MarkChanged();
     }
 }
 
@@ -156,57 +213,54 @@ void GameState::SetNumConveyorItems(int value) {
  * @note This function is thread-safe, but locks the conveyor items mutex.
  */
 void GameState::AddItemFromAddress(DWORD address) {
-    int values[32];
-    if (!Utils::ReadMemoryToBuffer(handle, address, &values, sizeof(values))) {
-        return;
-    }
-    int type = values[0];
-    int typeValue;
-    Utils::ReadMemoryToBuffer(handle, type, &typeValue, sizeof(typeValue));
-    int actualValue;
-    Utils::ReadMemoryToBuffer(handle, typeValue + 0x4, &actualValue, sizeof(actualValue));
-    if (actualValue == 1317794187) {
-        std::unique_ptr<SimpleItem> item = std::make_unique<SimpleItem>(address);
-        if (!item->isValid(handle)) {
+    ObjectKind kind = TypeCache::ClassifyObject(GetDirectMemory(), address);
+    if (kind == ObjectKind::Simple) {
+        SimpleItem item(address);
+        if (!item.isValid(GetDirectMemory())) {
             return;
         }
-        std::lock_guard<std::mutex> lock(conveyorItemsMutex);
-        conveyorItems.push_back(std::move(item));
-    } else if (actualValue == 113766795) {
-        std::unique_ptr<ComplexItem> item = std::make_unique<ComplexItem>(address);
-        if (!item->isValid(handle)) {
+    } else if (kind == ObjectKind::Complex) {
+        ComplexItem item(address);
+        if (!item.isValid(GetDirectMemory())) {
             return;
         }
-        std::lock_guard<std::mutex> lock(conveyorItemsMutex);
-        conveyorItems.push_back(std::move(item));
+    } else {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(conveyorItemsMutex);
+    if (conveyorItems.Insert(address, kind)) {
+        MarkChanged();
     }
 }
 
 /**
  * Removes a conveyor item from an address.
+ * If the address is not on the conveyor, it is treated as a complex item that absorbed one of the conveyor items,
+ * and that conveyor item is removed instead.
  * @param address The address of the conveyor item.
- * @note This function is thread-safe, but locks the conveyor items mutex.
+ * @note This function is thread-safe, but locks the conveyor items mutex. Game memory is only read outside the lock.
  */
 void GameState::RemoveItemFromAddress(DWORD address) {
-    botRetryFlag = false;
-    std::lock_guard<std::mutex> lock(conveyorItemsMutex);
-    for (int i = 0; i < conveyorItems.size(); i++) {
-        if (conveyorItems[i]->GetAddress() == address) {
-            conveyorItems.erase(conveyorItems.begin() + i);
+    if (actuator != nullptr) {
+        actuator->Confirm(address);
+    }
+    {
+        std::lock_guard<std::mutex> lock(conveyorItemsMutex);
+        if (conveyorItems.Remove(address)) {
+            MarkChanged();
             return;
         }
     }
     ComplexItem item(address);
-    if (!item.isValid(handle)) {
+    if (!item.isValid(GetDirectMemory())) {
         return;
     }
-    for (int i = 0; i < conveyorItems.size(); i++) {
-        std::list<SimpleItem> subItems = item.GetItems(handle);
-        for (SimpleItem &subItem: subItems) {
-            if (conveyorItems[i]->GetAddress() == subItem.GetAddress()) {
-                conveyorItems.erase(conveyorItems.begin() + i);
-                return;
-            }
+    std::list<SimpleItem> subItems = item.GetItems(GetDirectMemory());
+    std::lock_guard<std::mutex> lock(conveyorItemsMutex);
+    for (SimpleItem &subItem: subItems) {
+        if (conveyorItems.Remove(subItem.GetAddress())) {
+            MarkChanged();
+            return;
         }
     }
 }
@@ -222,6 +276,40 @@ void GameState::SetHandle(HANDLE pHandle) {
     handle = pHandle;
 }
 
+/**
+ * Sets the memory of the game process.
+ * @param pMemory The new memory of the game process.
+ * @note The reads are recorded if a session is being recorded when the memory is set.
+ */
+void GameState::SetMemory(std::unique_ptr<ProcessMemory> pMemory) {
+    if (memory != nullptr) {
+        std::cout << "Warning: Overwriting game memory." << std::endl;
+    }
+    recordedMemory.reset();
+    pageCache.reset();
+    memory = std::move(pMemory);
+    pageCache = std::make_unique<PageCache>(*memory);
+    // The cache records the pages it fetches, once per epoch rather than per read, and the direct reads are recorded as
+    // the bot makes them
+    if (Recorder::IsRecording()) {
+        pageCache->SetFetchesRecorded(true);
+        recordedMemory = std::make_unique<RecordingProcessMemory>(*memory);
+        recordedMemory->SetRecorded(true);
+    }
+}
+
+/**
+ * Sets the actuator that sends input to the game.
+ * @param pActuator The new actuator. The previous actuator is stopped.
+ */
+void GameState::SetActuator(std::unique_ptr<Actuator> pActuator) {
+    if (actuator != nullptr) {
+        std::cout << "Warning: Overwriting actuator." << std::endl;
+        actuator->Stop();
+    }
+    actuator = std::move(pActuator);
+}
+
 /**
  * Sets the handle to the game window.
  * @param pHandle The new handle to the game window.
@@ -235,27 +323,25 @@ void GameState::SetWindowHandle(HWND pHandle) {
 
 /**
  * Sorts the conveyor items by conveyor index.
- * @note This function is thread-safe, but locks the conveyor items mutex.
+ * @note This function is thread-safe, but locks the conveyor items mutex. Conveyor indices are read outside the lock.
  */
 void GameState::SortConveyorItems() {
     if (!needsSorting) {
         return;
     }
-    std::sort(conveyorItems.begin(), conveyorItems.end(),
-              [](const std::unique_ptr<ItemBase> &a, const std::unique_ptr<ItemBase> &b) {
-            if (SimpleItem * singleItemA = dynamic_cast<SimpleItem *>(a.get())) {
-                if (SimpleItem * singleItemB = dynamic_cast<SimpleItem *>(b.get())) {
-                    return singleItemA->GetConveyorIndex(GameState::handle) >
-                           singleItemB->GetConveyorIndex(GameState::handle);
-                }
-            } else if (ComplexItem * multiItemA = dynamic_cast<ComplexItem *>(a.get())) {
-                if (ComplexItem * multiItemB = dynamic_cast<ComplexItem *>(b.get())) {
-                    return multiItemA->GetConveyorIndex(GameState::handle) >
-                           multiItemB->GetConveyorIndex(GameState::handle);
-                }
-            }
-        return false;
+    ConveyorTable table;
+    GetConveyorItems(table);
+    std::vector<size_t> order(table.Size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&table](size_t a, size_t b) {
+        return table.conveyorIndex[a] > table.conveyorIndex[b];
     });
+    std::lock_guard<std::mutex> lock(conveyorItemsMutex);
+    for (size_t i: order) {
+        conveyorItems.MoveToBack(table.address[i]);
+    }
     needsSorting = false;
 }
 
@@ -267,7 +353,7 @@ void GameState::SortConveyorItems() {
 void GameState::AddCustomer(Customer customer) {
     std::lock_guard<std::mutex> lock(customersMutex);
     customers.push_back(customer);
-    dirty = true;
+    MarkChanged();
 }
 
 /**
@@ -279,53 +365,64 @@ void GameState::RemoveCustomer(int index) {
     std::lock_guard<std::mutex> lock(customersMutex);
     if (index >= 0 && index < customers.size()) {
         customers.erase(customers.begin() + index);
-        dirty = true;
+        MarkChanged();
     }
 }
 
 /**
- * Resets the game state.
+ * Resets the game state and starts a new level, which makes the world reader forget the customers of the last one.
  */
 void GameState::Reset() {
+    TypeCache::Invalidate();
+    levelCount.fetch_add(1);
     std::lock_guard<std::mutex> lock(conveyorItemsMutex);
-    conveyorItems.clear();
+    conveyorItems.Clear();
     customers.clear();
     numConveyorItems = 0;
-    dirty = true;
+    ordersHash = 0;
+    MarkChanged();
 }
 
 /**
  * Increments the first item on the conveyor.
- * @note This function is thread-safe, but locks the conveyor items mutex.
+ * @note This function is thread-safe, but locks the conveyor items mutex. Game memory is accessed outside the lock.
  */
 void GameState::IncrementFirstItem() {
     SortConveyorItems();
-    std::lock_guard<std::mutex> lock(conveyorItemsMutex);
-    if (!GameState::conveyorItems.empty()) {
-        ItemBase *item = GameState::conveyorItems.front().get();
-        if (SimpleItem * singleItem = dynamic_cast<SimpleItem *>(item)) {
-            int id = singleItem->GetItemId(GameState::GetHandle());
-            singleItem->SetItemId(GameState::GetHandle(), id + 1);
-            singleItem->SetIngredientId(GameState::GetHandle(), id + 1);
+    DWORD address = 0;
+    {
+        std::lock_guard<std::mutex> lock(conveyorItemsMutex);
+        const ConveyorSlot *front = conveyorItems.Front();
+        if (front == nullptr || front->kind != ObjectKind::Simple) {
+            return;
         }
+        address = front->address;
     }
+    SimpleItem item(address);
+    int id = item.GetItemId(GetMemory());
+    item.SetItemId(GetMemory(), id + 1);
+    item.SetIngredientId(GetMemory(), id + 1);
 }
 
 /**
  * Decrements the first item on the conveyor.
- * @note This function is thread-safe, but locks the conveyor items mutex.
+ * @note This function is thread-safe, but locks the conveyor items mutex. Game memory is accessed outside the lock.
  */
 void GameState::DecrementFirstItem() {
     SortConveyorItems();
-    std::lock_guard<std::mutex> lock(conveyorItemsMutex);
-    if (!GameState::conveyorItems.empty()) {
-        ItemBase *item = GameState::conveyorItems.front().get();
-        if (SimpleItem * singleItem = dynamic_cast<SimpleItem *>(item)) {
-            int id = singleItem->GetItemId(GameState::GetHandle());
-            singleItem->SetItemId(GameState::GetHandle(), id - 1);
-            singleItem->SetIngredientId(GameState::GetHandle(), id - 1);
+    DWORD address = 0;
+    {
+        std::lock_guard<std::mutex> lock(conveyorItemsMutex);
+        const ConveyorSlot *front = conveyorItems.Front();
+        if (front == nullptr || front->kind != ObjectKind::Simple) {
+            return;
         }
+        address = front->address;
     }
+    SimpleItem item(address);
+    int id = item.GetItemId(GetMemory());
+    item.SetItemId(GetMemory(), id - 1);
+    item.SetIngredientId(GetMemory(), id - 1);
 }
 
 /**
@@ -340,565 +437,501 @@ void GameState::Update() {
 /**
  * Checks whether any of the items have changed. Also sets the dirty flag if any of the items have changed.
  * @return Whether any of the items have changed.
- * @note This function is thread-safe, but locks the conveyor items mutex.
+ * @note This function is thread-safe, but locks the conveyor items mutex. Items are read outside the lock.
  */
 bool GameState::CheckItemsDirty() {
     if (dirty) {
         return true;
     }
-    std::lock_guard<std::mutex> lock(conveyorItemsMutex);
-    for (const std::unique_ptr<ItemBase> &item: conveyorItems) {
-        if (SimpleItem * singleItem = dynamic_cast<SimpleItem *>(item.get())) {
-            if (singleItem->HasChanged()) {
-                dirty = true;
-            }
-        } else if (ComplexItem * multiItem = dynamic_cast<ComplexItem *>(item.get())) {
-            if (multiItem->HasChanged()) {
-                dirty = true;
-            }
-        }
-    }
+    static thread_local ConveyorTable table;
+    GetConveyorItems(table);
+    UpdateItemGenerations(table);
     return dirty;
 }
 
-void MoveMouseToAbsolute(HWND window, int x, int y) {
-    if (window != GetForegroundWindow()) {
-        SetForegroundWindow(window);
-        Sleep(100);
+/**
+ * Compares the hashes of decoded conveyor items with the last seen ones, advancing the generation of every item that
+ * changed, and the state version if any did.
+ * @param table (in, out) The decoded conveyor items. The generation column is filled in.
+ * @return Whether any of the items have changed.
+ * @note This function is thread-safe, but locks the conveyor items mutex.
+ */
+bool GameState::UpdateItemGenerations(ConveyorTable &table) {
+    bool changed = false;
+    std::lock_guard<std::mutex> lock(conveyorItemsMutex);
+    for (size_t i = 0; i < table.Size(); i++) {
+        if (conveyorItems.UpdateHash(table.address[i], table.hash[i])) {
+            changed = true;
+        }
+        const ConveyorSlot *slot = conveyorItems.Find(table.address[i]);
+        table.generation[i] = slot != nullptr ? slot->generation : 0;
     }
-
-
-    POINT p = {x, y};
-
-    INPUT input = {0};
-    input.type = INPUT_MOUSE;
-    input.mi.dx = static_cast<long>(p.x * (65535.0 / GetSystemMetrics(SM_CXSCREEN)));
-    input.mi.dy = static_cast<long>(p.y * (65535.0 / GetSystemMetrics(SM_CYSCREEN)));
-    input.mi.dwFlags = MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_MOVE;
-    SendInput(1, &input, sizeof(INPUT));
-    POINT cp;
-    int sleepCount = 0;
-    do {
-        GetCursorPos(&cp);
-        Sleep(5);
-        sleepCount++;
-    } while ((abs(cp.x - p.x) > 2 || abs(cp.y - p.y) > 2) && sleepCount < 100);
-    Sleep(5);
+    if (changed) {
+        MarkChanged();
+    }
+    return changed;
 }
 
-void ClickMouseAtAbsolute(HWND window, int x, int y) {
-    if (window != GetForegroundWindow()) {
-        SetForegroundWindow(window);
-        Sleep(100);
+/**
+ * Compares the hash of all customer orders with the last seen one, advancing the state version if it changed.
+ * @param hash The hash of the orders.
+ * @return Whether the orders have changed.
+ */
+bool GameState::UpdateOrdersHash(uint64_t hash) {
+    if (ordersHash.exchange(hash) == hash) {
+        return false;
     }
-
-    MoveMouseToAbsolute(window, x, y);
-
-    INPUT input = {0};
-    input.type = INPUT_MOUSE;
-
-    input.mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
-    SendInput(1, &input, sizeof(INPUT));
-
-    input.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-    SendInput(1, &input, sizeof(INPUT));
+    MarkChanged();
+    return true;
 }
 
-void ClickMouseAtGamePos(HWND window, int x, int y) {
-    std::pair<float, float> pos = Utils::GamePosToMouseAbsolute(window, x, y);
-    ClickMouseAtAbsolute(window, static_cast<int>(pos.first), static_cast<int>(pos.second));
+/**
+ * Returns the version of the game state. The version advances whenever anything the bot tracks changes, and only then,
+ * so comparing two versions tells whether anything changed in between.
+ * @return The version.
+ */
+uint64_t GameState::GetStateVersion() {
+    return stateSignal.GetVersion();
 }
 
-
-void ClickRightMouse(HWND window) {
-
-    POINT p = {10,40};
-    ClientToScreen(window, &p);
-
-    INPUT input = {0};
-    input.type = INPUT_MOUSE;
-    input.mi.dwFlags = MOUSEEVENTF_RIGHTDOWN;
-    SendInput(1, &input, sizeof(INPUT));
-
-    input.mi.dwFlags = MOUSEEVENTF_RIGHTUP;
-    SendInput(1, &input, sizeof(INPUT));
+/**
+ * Returns the number of times the game state was reset, i.e. how many levels were started.
+ * @return The number of resets.
+ */
+uint64_t GameState::GetLevelCount() {
+    return levelCount.load();
 }
 
-int delay = 0;
-int skip = 0;
-DWORD prev = 0;
-int attempts = 0;
-
-bool makingItem = false;
-ItemInfo targetItem;
-std::vector<std::unique_ptr<SimpleItem>> ingredientsLeft;
-
-std::unique_ptr<SimpleItem> itemToRetry = nullptr;
-
-void Shuffle(std::vector<std::unique_ptr<SimpleItem>> &v) {
-    for (int i = 0; i < v.size(); i++) {
-        int j = rand() % v.size();
-        std::swap(v[i], v[j]);
-    }
+/**
+ * Returns the time the game state last changed.
+ * @return The steady clock time in nanoseconds.
+ */
+int64_t GameState::GetChangeNanos() {
+    return stateSignal.GetChangeNanos();
 }
 
-void GameState::PerformActions() {
-    HANDLE h = GameState::GetHandle();
-    if (GetAsyncKeyState(VK_END)) {
-        if (delay > 100 && delay < 999999) {
-            delay = 0;
-            makingItem = false;
-            ingredientsLeft.clear();
-        } else {
-            delay = 999999;
-        }
-        return;
-    }
-    if (GetAsyncKeyState(VK_HOME)) {
-        delay = 0;
-        return;
-    }
-    if (GameState::GetCustomers().size() > 0) {
-        if (delay > 0) {
-            delay--;
-            return;
-        }
-        if (!makingItem) {
-            int cskip = skip;
-            std::vector<ItemInfo> items;
-            for (Customer &customer: GameState::GetCustomers()) {
-                for (ItemInfo &item: customer.GetItems(GameState::GetHandle())) {
-                    items.push_back(item);
-                }
-            }
-            ItemInfo target;
-            std::vector<std::unique_ptr<SimpleItem>> ingredientsBackup;
-            bool found = false;
-            int i = 0;
-            std::vector<std::unique_ptr<SimpleItem>> ingredients;
-            while (!found && i < items.size()) {
-                ItemInfo &item = items[i];
-                if (item.mNumCopies == item.mNumComplete || item.mRobotComplete) {
-                    i++;
-                    continue;
-                }
-                if (cskip > 0) {
-                    cskip--;
-                    continue;
-                }
-                std::unique_ptr<ItemBase> ib = item.GetItem();
-                ingredients.clear();
-                if (SimpleItem * si = dynamic_cast<SimpleItem *>(ib.get())) {
-                    if (ItemManager::IngredientLimit(si->GetIngredientId(GameState::GetHandle())) != -1) {
-                        int numIngredients = 0;
-                        for (std::unique_ptr<SimpleItem> &ingredient: ingredients) {
-                            if (ingredient->GetIngredientId(GameState::GetHandle()) ==
-                                si->GetIngredientId(GameState::GetHandle())) {
-                                numIngredients++;
-                            }
-                        }
-                        if (numIngredients < ItemManager::IngredientLimit(si->GetIngredientId(GameState::GetHandle()))) {
-                            ingredients.push_back(std::make_unique<SimpleItem>(*si));
-                        }
-                    } else {
-                        ingredients.push_back(std::make_unique<SimpleItem>(*si));
-                    }
-                } else if (ComplexItem * ci = dynamic_cast<ComplexItem *>(ib.get())) {
-                    for (SimpleItem &ingredient: ci->GetItems(handle)) {
-                        if (ItemManager::IngredientLimit(ingredient.GetIngredientId(GameState::GetHandle())) != -1) {
-                            int numIngredients = 0;
-                            for (std::unique_ptr<SimpleItem> &ingredient2: ingredients) {
-                                if (ingredient2->GetIngredientId(GameState::GetHandle()) ==
-                                    ingredient.GetIngredientId(GameState::GetHandle())) {
-                                    numIngredients++;
-                                }
-                            }
-                            if (numIngredients < ItemManager::IngredientLimit(ingredient.GetIngredientId(GameState::GetHandle()))) {
-                                ingredients.push_back(std::make_unique<SimpleItem>(ingredient));
-                            }
-                        } else {
-                            ingredients.push_back(std::make_unique<SimpleItem>(ingredient));
-                        }
-                    }
-                }
-                std::vector<bool> foundIngredients;
-                for (int i = 0; i < ingredients.size(); i++) {
-                    foundIngredients.push_back(false);
-                }
-                for (const std::unique_ptr<ItemBase> &conveyorItem: GameState::GetConveyorItems()) {
-                    if (SimpleItem * si = dynamic_cast<SimpleItem *>(conveyorItem.get())) {
-                        for (int i = 0; i < ingredients.size(); i++) {
-                            if (ingredients[i]->GetIngredientId(GameState::GetHandle()) ==
-                                si->GetIngredientId(GameState::GetHandle()) && !foundIngredients[i]) {
-                                foundIngredients[i] = true;
-                                break;
-                            }
-                        }
-                    } else if (ComplexItem * ci = dynamic_cast<ComplexItem *>(conveyorItem.get())) {
-                        // Ignored for now
-                    }
-                }
-                bool allFound = true;
-                for (bool foundIngredient: foundIngredients) {
-                    if (!foundIngredient) {
-                        allFound = false;
-                        break;
-                    }
-                }
-                if (allFound) {
-                    if (cskip > 0) {
-                        cskip--;
-                        continue;
-                    }
-                    target = item;
-                    found = true;
-                }
-                i++;
-            }
-            if (found) {
-                targetItem = target;
-                makingItem = true;
-                ingredientsLeft = std::move(ingredients);
-            } else {
-                int cskip = skip;
-                bool didFind = false;
-                for (Customer &customer: GameState::GetCustomers()) {
-                    for (ItemInfo &item: customer.GetItems(GameState::GetHandle())) {
-                        if (item.mNumCopies == item.mNumComplete || item.mRobotComplete) {
-                            continue;
-                        }
-                        if (cskip > 0) {
-                            cskip--;
-                            continue;
-                        }
-                        targetItem = item;
-                        makingItem = true;
-                        std::unique_ptr<ItemBase> ib = targetItem.GetItem();
-                        ingredients.clear();
-                        if (SimpleItem * si = dynamic_cast<SimpleItem *>(ib.get())) {
-                            if (ItemManager::IngredientLimit(si->GetIngredientId(GameState::GetHandle())) != -1) {
-                                int numIngredients = 0;
-                                for (std::unique_ptr<SimpleItem> &ingredient: ingredients) {
-                                    if (ingredient->GetIngredientId(GameState::GetHandle()) ==
-                                        si->GetIngredientId(GameState::GetHandle())) {
-                                        numIngredients++;
-                                    }
-                                }
-                                if (numIngredients < ItemManager::IngredientLimit(si->GetIngredientId(GameState::GetHandle()))) {
-                                    ingredients.push_back(std::make_unique<SimpleItem>(*si));
-                                }
-                            } else {
-                                ingredients.push_back(std::make_unique<SimpleItem>(*si));
-                            }
-                        } else if (ComplexItem * ci = dynamic_cast<ComplexItem *>(ib.get())) {
-                            for (SimpleItem &ingredient: ci->GetItems(handle)) {
-                                if (ItemManager::IngredientLimit(ingredient.GetIngredientId(GameState::GetHandle())) != -1) {
-                                    int numIngredients = 0;
-                                    for (std::unique_ptr<SimpleItem> &ingredient2: ingredients) {
-                                        if (ingredient2->GetIngredientId(GameState::GetHandle()) ==
-                                            ingredient.GetIngredientId(GameState::GetHandle())) {
-                                            numIngredients++;
-                                        }
-                                    }
-                                    if (numIngredients < ItemManager::IngredientLimit(ingredient.GetIngredientId(GameState::GetHandle()))) {
-                                        ingredients.push_back(std::make_unique<SimpleItem>(ingredient));
-                                    }
-                                } else {
-                                    ingredients.push_back(std::make_unique<SimpleItem>(ingredient));
-                                }
-                            }
-                        }
-                        ingredientsLeft = std::move(ingredients);
-                        didFind = true;
-                        break;
-                    }
-                    if (didFind) {
-                        break;
-                    }
-                }
-                if (!didFind) {
-                    skip = 0;
-                    delay = 10;
-                }
-            }
-        } else {
-            if (botRetryFlag) {
-                ingredientsLeft.insert(ingredientsLeft.begin(), std::move(itemToRetry));
-            }
-            while (!ingredientsLeft.empty() && ingredientsLeft[0] == nullptr) {
-                ingredientsLeft.erase(ingredientsLeft.begin());
-            }
-            if (!ingredientsLeft.empty()) {
-                std::vector<std::unique_ptr<ItemBase>> conveyorItems = GameState::GetConveyorItems();
-                std::pair<float, float> coords = std::make_pair(-1, -1);
-                int i = 0;
-                if (attempts < 10) {
-                    do {
-                        if (ingredientsLeft[i] == nullptr) {
-                            ingredientsLeft.erase(ingredientsLeft.begin() + i);
-                            continue;
-                        }
-                        SimpleItem &ingredient = *ingredientsLeft[i];
-                        std::cout << "Finding ingredient " << ingredient.GetIngredientName(handle) << std::endl;
-                        // Find on the conveyor
-                        for (const std::unique_ptr<ItemBase> &conveyorItem: conveyorItems) {
-                            if (SimpleItem * si = dynamic_cast<SimpleItem *>(conveyorItem.get())) {
-                                if (si->GetIngredientId(GameState::GetHandle()) ==
-                                    ingredient.GetIngredientId(GameState::GetHandle())) {
-                                    coords = si->GetMousePos(GameState::GetHandle());
-                                    if (prev != si->GetAddress()) {
-                                        prev = si->GetAddress();
-                                        attempts = 0;
-                                    } else {
-                                        attempts++;
-                                    }
-                                    break;
-                                }
-                            } else if (ComplexItem * ci = dynamic_cast<ComplexItem *>(conveyorItem.get())) {
-                                // Ignored for now
-                            }
-                        }
-                    } while (coords.first == -1 && ++i < ingredientsLeft.size());
-                }
-                if (coords.first != -1) {
-                    std::cout << "Clicking at " << coords.first << ", " << coords.second << std::endl;
-                    botRetryFlag = true;
-                    itemToRetry = std::move(ingredientsLeft[0]);
-                    ClickMouseAtAbsolute(GameState::GetWindowHandle(), coords.first, coords.second);
-                    ingredientsLeft.erase(ingredientsLeft.begin() + i);
-                    skip = 0;
-                    dirty = true;
-                } else {
-                    // Give up because you're bad at the game.
-                    std::cout << "I give up. This game is too hard." << std::endl;
-                    makingItem = false;
-                    botRetryFlag = false;
-                    ClickMouseAtGamePos(GameState::GetWindowHandle(), 400, 120);
-                    skip++;
-                    prev = 0;
-                    attempts = 0;
-                    dirty = true;
-                }
-            } else {
-                std::cout << "Done with item! Delivering." << std::endl;
-                makingItem = false;
-                ClickRightMouse(GameState::GetWindowHandle());
-                dirty = true;
-            }
-            delay = 2;
-        }
-        timeWithNoCustomers = 0;
-    } else {
-        timeWithNoCustomers++;
-        if (timeWithNoCustomers > 100) {
-            delay = 30;
-        } else {
-            delay = 10;
-        }
-    }
+/**
+ * Blocks until the game state changes, or until a deadline.
+ * @param version The last version the caller has seen.
+ * @param deadlineNanos The steady clock time to stop waiting at.
+ * @return The current version.
+ */
+uint64_t GameState::WaitForChange(uint64_t version, int64_t deadlineNanos) {
+    return stateSignal.Wait(version, deadlineNanos);
 }
 
 /**
- * Sets a breakpoint at the specified address.
- * @param address The address to set the breakpoint at.
- * @param callback The callback to call when the breakpoint is hit.
- * @return Whether the breakpoint was set successfully.
+ * Blocks until the game state changes or the bot acts on a game frame, or until a deadline.
+ * @param count The last wake count the caller has seen.
+ * @param deadlineNanos The steady clock time to stop waiting at.
+ * @return The current wake count.
  */
-bool BreakpointManager::SetBreakpoint(LPVOID address, std::function<void(const DEBUG_EVENT &, HANDLE)> callback) {
-    Breakpoint bp;
-    bp.address = address;
-    bp.callback = callback;
-
-    std::cout << "Setting breakpoint at address: " << address << std::endl;
-
-    // Read the original byte
-    BYTE originalByte;
-    if (!ReadProcessMemory(processHandle, address, &originalByte, sizeof(originalByte), NULL)) {
-        return false;
-    }
-
-    // Write 0xCC to set the breakpoint
-    BYTE int3 = 0xCC;
-    if (!WriteProcessMemory(processHandle, address, &int3, sizeof(int3), NULL)) {
-        return false;
-    }
-
-    bp.originalByte = originalByte;
-    bp.isActive = true;
-    breakpoints[address] = bp;
-    return true;
+uint64_t GameState::WaitForWake(uint64_t count, int64_t deadlineNanos) {
+    return wakeSignal.Wait(count, deadlineNanos);
 }
 
 /**
- * Handles a breakpoint.
- * @param debugEvent The debug event.
- * @return Whether the breakpoint was handled successfully.
+ * Returns how many times the game state changed or the bot acted on a game frame.
+ * @return The wake count.
  */
-bool BreakpointManager::HandleBreakpoint(const DEBUG_EVENT &debugEvent) {
-    LPVOID address = (LPVOID) debugEvent.u.Exception.ExceptionRecord.ExceptionAddress;
-    auto it = breakpoints.find(address);
-    if (it == breakpoints.end()) {
-        return false;
-    }
-
-    Breakpoint &bp = it->second;
+uint64_t GameState::GetWakeCount() {
+    return wakeSignal.GetVersion();
+}
 
-    // Restore the original instruction
-    if (!WriteProcessMemory(processHandle, address, &bp.originalByte, sizeof(bp.originalByte), NULL)) {
-        return false;
+/**
+ * Records a frame of the game. Frames the bot acts on wake the world reader, so it and the planner run once per game
+ * frame rather than on a fixed cadence. They leave the state version alone, which only advances on changes.
+ * @param timestampNanos The steady clock time of the frame.
+ */
+void GameState::OnFrame(int64_t timestampNanos) {
+    if (tickClock.OnFrame(timestampNanos)) {
+        wakeSignal.Notify();
     }
+}
 
-    // Get the thread context
-    threadHandle = OpenThread(THREAD_ALL_ACCESS, FALSE, debugEvent.dwThreadId);
-    CONTEXT context;
-    ZeroMemory(&context, sizeof(CONTEXT));
-    context.ContextFlags = CONTEXT_FULL;
-    GetThreadContext(threadHandle, &context);
-
-    // Set the trap flag for single-step execution
-    context.EFlags |= 0x100; // Set trap flag
-    SetThreadContext(threadHandle, &context);
+/**
+ * Returns the clock following the game's frames.
+ * @return The tick clock.
+ */
+TickClock &GameState::GetTickClock() {
+    return tickClock;
+}
 
-    CloseHandle(threadHandle);
+/**
+ * @internal
+ * Sets the dirty flag and advances the state version, waking the threads waiting for a change.
+ */
+void GameState::MarkChanged() {
+    dirty = true;
+    stateSignal.Notify();
+    wakeSignal.Notify();
+}
+
+// The hotkeys are read at least this often, in frames
+const int KEY_POLL_FRAMES = 3;
+// The virtual key codes of the hotkeys, VK_END and VK_HOME
+const int KEY_END = 0x23;
+const int KEY_HOME = 0x24;
+// A delivery is over when the game serves the order, or after this many frames
+const int DELIVERY_TIMEOUT_FRAMES = 6;
+// Item building, delivery and discarding run as sequences, resumed when what they wait for happens
+SequenceRunner sequences;
+bool paused = false;
+// Whether a delivery or a discard is using the tray
+bool trayBusy = false;
+int64_t customersSeenNanos = 0;
+
+OrderScheduler scheduler;
+MotionPredictor motion;
+int clicks = 0;
+int missedClicks = 0;
+ClickOrder clickOrder;
+std::vector<ClickTarget> clickTargets;
+std::vector<int> clickSequence;
+// The game position of the last click
+float cursorX = 400.0f;
+float cursorY = 300.0f;
 
-    // Schedule the callback
-    if (bp.callback) {
-        Debugging::EnqueueEvent(debugEvent, bp.callback, processHandle);
+/**
+ * @internal
+ * Converts a game position to the absolute mouse position that clicks it.
+ * Without a game window, e.g. in the simulator, input is sent in game positions.
+ * @param x The x coordinate in the game.
+ * @param y The y coordinate in the game.
+ * @return The mouse position.
+ */
+static std::pair<float, float> GamePosToScreen(float x, float y) {
+#ifdef _WIN32
+    if (GameState::GetWindowHandle() != NULL) {
+        return Utils::GamePosToMouseAbsolute(GameState::GetWindowHandle(), x, y);
     }
+#endif
+    return std::make_pair(x, y);
+}
 
-    // Remember to reinstate this breakpoint after single-step
-    lastBreakpoint = &bp;
-
-    return true;
+/**
+ * @internal
+ * Reads whether a hotkey is pressed. Only the game's own machine has hotkeys.
+ * @param key The virtual key code.
+ * @return Whether the key is pressed.
+ */
+static bool IsKeyPressed([[maybe_unused]] int key) {
+#ifdef _WIN32
+    return GetAsyncKeyState(key) != 0;
+#else
+    return false;
+#endif
 }
 
 /**
  * @internal
- * Reinstates the last breakpoint.
+ * Converts a number of game frames to a duration, at the measured frame period.
+ * @param frames The number of frames.
+ * @return The duration in nanoseconds.
  */
-void BreakpointManager::ReinstateBreakpoint() {
-    if (lastBreakpoint && lastBreakpoint->isActive) {
-        BYTE int3 = 0xCC;
-        WriteProcessMemory(processHandle, lastBreakpoint->address, &int3, sizeof(int3), NULL);
-        lastBreakpoint = nullptr;
-    }
+static int64_t FramesToNanos(int64_t frames) {
+    return frames * GameState::GetTickClock().GetFramePeriodNanos();
 }
 
 /**
  * @internal
- * Clears the single-step flag.
+ * Returns whether the latest snapshot has customers.
+ * @return Whether there are customers.
  */
-void BreakpointManager::ClearSingleStep() {
-    CONTEXT context;
-    ZeroMemory(&context, sizeof(CONTEXT));
-    context.ContextFlags = CONTEXT_FULL;
-    GetThreadContext(threadHandle, &context);
-    context.EFlags &= ~0x100; // Clear trap flag
-    SetThreadContext(threadHandle, &context);
+static bool HasCustomers() {
+    std::shared_ptr<const WorldSnapshot> world = WorldReader::GetSnapshot();
+    return world != nullptr && !world->customers.empty();
 }
 
 /**
- * Loads the item data from the specified file.
- * @param filename The filename to load the item names from.
- * @return Whether the item names were loaded successfully.
+ * @internal
+ * Returns whether an order was served in the latest snapshot: it is gone, has more complete copies than before, or is
+ * being completed by the robot.
+ * @param key The order.
+ * @param numComplete The number of complete copies of the order before it was delivered.
+ * @return Whether the order was served.
  */
-bool ItemManager::LoadItems(const std::string &filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cout << "Error: Could not open file." << std::endl;
-        return false;
-    }
-    pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load(file);
-    if (!result) {
-        std::cout << "Error: " << result.description() << std::endl;
-        return false;
-    }
-    pugi::xml_node root = doc.child("Food");
-    if (!root) {
-        std::cout << "Error: Could not find root node." << std::endl;
+static bool IsServed(OrderKey key, int numComplete) {
+    std::shared_ptr<const WorldSnapshot> world = WorldReader::GetSnapshot();
+    if (world == nullptr) {
         return false;
     }
-    for (pugi::xml_node item: root.children("Item")) {
-        int id = item.attribute("id").as_int();
-        std::string name = item.attribute("name").as_string();
-        std::string type = item.attribute("type").as_string();
-        std::string oven = item.attribute("oven").as_string();
-        std::string pot = item.attribute("pot").as_string();
-        std::string pan = item.attribute("pan").as_string();
-        ItemData data = {id, name, type, oven, pot, pan};
-        itemNames.push_back(name);
-        itemData[id] = data;
-        itemDataByName[name] = data;
+    for (const OrderEntry &order: world->orders) {
+        if (OrderScheduler::GetKey(order) == key) {
+            return order.info.mNumComplete > numComplete || order.info.mRobotComplete;
+        }
     }
     return true;
 }
 
 /**
- * Returns the name of the item with the specified ID.
- * @param id The ID of the item.
- * @return The name of the item with the specified ID.
+ * @internal
+ * Delivers the item on the tray, and holds the tray until the game serves it.
+ * @param key The order the item is for.
+ * @param numComplete The number of complete copies of the order before the delivery.
+ * @return The sequence.
  */
-std::string ItemManager::GetItemName(int id) {
-    if (id < 0 || id >= itemNames.size()) {
-        return "Unknown";
-    }
-    return itemNames[id];
+static Sequence Deliver(OrderKey key, int numComplete) {
+    trayBusy = true;
+    std::cout << "Done with item! Delivering." << std::endl;
+    GameState::GetActuator().Submit(ActuatorCommandType::RightClick, 0, 0);
+    co_await WaitUntil([key, numComplete] { return IsServed(key, numComplete); },
+                       FramesToNanos(DELIVERY_TIMEOUT_FRAMES));
+    trayBusy = false;
 }
 
 /**
- * Returns the data of the item with the specified ID.
- * @param id The ID of the item.
- * @return The data of the item with the specified ID.
+ * @internal
+ * Throws away the item on the tray, and holds the tray until the game has cleared it.
+ * @return The sequence.
  */
-ItemData ItemManager::GetItemData(int id) {
-    if (id < 0 || id >= itemData.size()) {
-        return ItemData();
-    }
-    return itemData[id];
+static Sequence Discard() {
+    trayBusy = true;
+    // Give up because you're bad at the game.
+    std::cout << "I give up. This game is too hard." << std::endl;
+    std::pair<float, float> pos = GamePosToScreen(400, 120);
+    GameState::GetActuator().Submit(ActuatorCommandType::Click, (int) pos.first, (int) pos.second);
+    cursorX = 400.0f;
+    cursorY = 120.0f;
+    co_await WaitFor(FramesToNanos(2));
+    trayBusy = false;
 }
 
 /**
- * Returns the number of items.
- * @return The number of items.
+ * @internal
+ * Builds an order: clicks its ingredients one at a time, each once the previous one was taken, then delivers it.
+ * Gives up on the order and discards the tray when an ingredient cannot be clicked.
+ * @param key The order.
+ * @param ingredients The ingredients of the order, in stacking order.
+ * @param skip (in, out) The number of orders given up on in a row without an ingredient clicked, shared with Serve.
+ * @return The sequence.
  */
-int ItemManager::GetNumItems() {
-    return itemNames.size();
+static Sequence BuildOrder(OrderKey key, std::vector<int> ingredients, std::shared_ptr<int> skip) {
+    DWORD prev = 0;
+    int attempts = 0;
+    int numComplete = 0;
+    while (!ingredients.empty()) {
+        std::shared_ptr<const WorldSnapshot> world = WorldReader::GetSnapshot();
+        if (world == nullptr) {
+            // The world reader was reset; the order is picked up again from its next snapshot
+            co_await WaitFor(FramesToNanos(1));
+            continue;
+        }
+        uint64_t version = world->version;
+        for (const OrderEntry &order: world->orders) {
+            if (OrderScheduler::GetKey(order) == key) {
+                numComplete = order.info.mNumComplete;
+            }
+        }
+        // The committed order is always first in the plan, with its items in the order of ingredients
+        scheduler.Update(*world, &key, ingredients);
+        const SchedulePlan &plan = scheduler.GetPlan();
+        std::pair<float, float> coords = std::make_pair(-1, -1);
+        int i = 0;
+        int64_t clickTime = ChangeSignal::NowNanos();
+        bool blocked = false;
+        if (attempts < 10) {
+            // Predict every reserved item for the time of this click, then choose which one to click first
+            const ConveyorTable &conveyor = world->conveyor;
+            int64_t aimTime = clickTime + motion.GetLatencyNanos();
+            clickTargets.resize(ingredients.size());
+            clickSequence.resize(ingredients.size());
+            bool anyAvailable = false;
+            for (size_t t = 0; t < ingredients.size(); t++) {
+                ClickTarget &target = clickTargets[t];
+                target.ingredient = ingredients[t];
+                target.layer = ItemManager::GetStackingLayer(target.ingredient);
+                target.available = false;
+                target.vx = 0.0f;
+                target.vy = 0.0f;
+                DWORD reservedItem = plan.items[plan.orders[0].firstItem + t];
+                for (size_t c = 0; reservedItem != 0 && c < conveyor.Size(); c++) {
+                    if (conveyor.address[c] == reservedItem) {
+                        // Aim where the item will be when the click is sent, not where it was captured
+                        target.x = conveyor.x[c];
+                        target.y = conveyor.y[c];
+                        motion.Predict(reservedItem, aimTime, target.x, target.y);
+                        float vx, vy;
+                        if (motion.GetVelocity(reservedItem, vx, vy)) {
+                            target.vx = vx * 1e-9f;
+                            target.vy = vy * 1e-9f;
+                        }
+                        target.available = true;
+                        anyAvailable = true;
+                        break;
+                    }
+                }
+            }
+            if (clickOrder.Plan(clickTargets.data(), clickTargets.size(), cursorX, cursorY,
+                                clickSequence.data()) > 0) {
+                i = clickSequence[0];
+                DWORD reservedItem = plan.items[plan.orders[0].firstItem + i];
+                std::cout << "Finding ingredient " << ItemManager::GetItemName(ingredients[i]) << std::endl;
+                coords = GamePosToScreen(clickTargets[i].x, clickTargets[i].y);
+                if (prev != reservedItem) {
+                    prev = reservedItem;
+                    attempts = 0;
+                } else {
+                    attempts++;
+                }
+            } else if (anyAvailable) {
+                // The items that are there go on top of one that is not there yet
+                blocked = true;
+                attempts++;
+            }
+        }
+        // A snapshot held across a wait keeps the world reader from reusing it
+        world.reset();
+        if (coords.first == -1) {
+            if (!blocked) {
+                sequences.Spawn(Discard());
+                (*skip)++;
+                co_return;
+            }
+            std::cout << "Waiting for a lower layer of the stack" << std::endl;
+            co_await WaitUntil([version] {
+                std::shared_ptr<const WorldSnapshot> next = WorldReader::GetSnapshot();
+                return next == nullptr || next->version != version;
+            }, FramesToNanos(2));
+            continue;
+        }
+        DWORD item = plan.items[plan.orders[0].firstItem + i];
+        Actuator &actuator = GameState::GetActuator();
+        if (actuator.Submit(ActuatorCommandType::Click, (int) coords.first, (int) coords.second, item) == 0) {
+            // Nothing is lost, the click is chosen again on the next frame
+            std::cout << "Error: The input queue is full." << std::endl;
+            co_await WaitFor(FramesToNanos(1));
+            continue;
+        }
+        std::cout << "Clicking at " << coords.first << ", " << coords.second << std::endl;
+        // The click is sent in the background; the last batch tells how long sending takes
+        motion.RecordLatency(ChangeSignal::NowNanos() - clickTime + actuator.GetLastSendLatencyNanos());
+        clicks++;
+        cursorX = clickTargets[i].x;
+        cursorY = clickTargets[i].y;
+        // The click landed when the game takes the item off the conveyor
+        bool taken = co_await WaitUntil([item] { return !GameState::HasConveyorItem(item); },
+                                        FramesToNanos(2) + motion.GetLatencyNanos());
+        if (!taken) {
+            missedClicks++;
+            std::cout << "Missed click, retrying (" << missedClicks << " of " << clicks << " clicks missed)"
+                      << std::endl;
+            continue;
+        }
+        ingredients.erase(ingredients.begin() + i);
+        *skip = 0;
+    }
+    sequences.Spawn(Deliver(key, numComplete));
 }
 
 /**
- * Loads the item names and data.
- * @return Whether the item names and data were loaded successfully.
+ * @internal
+ * Serves the customers: picks an order once the tray is free, builds it, and repeats.
+ * @return The sequence.
  */
-bool ItemManager::LoadContent() {
-    if (!ItemManager::LoadItems("resources/food.xml")) {
-        return false;
+static Sequence Serve() {
+    std::vector<int> ingredients;
+    // Without a plan, orders are tried in memory order, past the ones just given up on
+    std::shared_ptr<int> skip = std::make_shared<int>(0);
+    while (true) {
+        if (!HasCustomers()) {
+            int64_t now = ChangeSignal::NowNanos();
+            co_await WaitFor(FramesToNanos(now - customersSeenNanos > FramesToNanos(100) ? 30 : 10));
+            continue;
+        }
+        customersSeenNanos = ChangeSignal::NowNanos();
+        co_await WaitUntil([] { return !trayBusy; });
+        std::shared_ptr<const WorldSnapshot> world = WorldReader::GetSnapshot();
+        if (world == nullptr) {
+            continue;
+        }
+        ingredients.clear();
+        scheduler.Update(*world, nullptr, ingredients);
+        const SchedulePlan &plan = scheduler.GetPlan();
+        OrderKey key;
+        bool didFind = false;
+        if (!plan.orders.empty()) {
+            const ScheduledOrder &next = plan.orders[0];
+            key = next.key;
+            ingredients.assign(plan.ingredients.begin() + next.firstItem,
+                               plan.ingredients.begin() + next.firstItem + next.itemCount);
+            didFind = true;
+        } else {
+            int cskip = *skip;
+            for (const OrderEntry &order: world->orders) {
+                const ItemInfo &item = order.info;
+                if (item.mNumCopies == item.mNumComplete || item.mRobotComplete) {
+                    continue;
+                }
+                if (cskip > 0) {
+                    cskip--;
+                    continue;
+                }
+                key = OrderScheduler::GetKey(order);
+                Feasibility::CollectIngredients(*world, order, ingredients);
+                didFind = true;
+                break;
+            }
+        }
+        if (!didFind) {
+            *skip = 0;
+            co_await WaitFor(FramesToNanos(10));
+            continue;
+        }
+        world.reset();
+        std::shared_ptr<const bool> built = sequences.Spawn(BuildOrder(key, ingredients, skip));
+        co_await WaitUntil([&built] { return *built; });
     }
-    return true;
 }
 
-int ItemManager::IngredientLimit(int id) {
-    switch (id) {
-        case 4:
-        case 37:
-        case 38:
-        case 39:
-        case 42:
-        case 48:
-        case 57:
-        case 129:
-        case 130:
-        case 150:
-        case 155:
-            return 1;
-        default:
-            if (id >= 234){
-                return 0;
-            }
-            return -1;
+/**
+ * Acts on the latest snapshot of the game: resumes the action sequences whose wait is over.
+ * The caller runs this again when a snapshot with a changed state is published, or at the returned time at the latest.
+ * @return The steady clock time in nanoseconds by which the planner wants to run again.
+ */
+int64_t GameState::PerformActions() {
+    Recorder::RecordTick(GetStateVersion());
+    int64_t now = ChangeSignal::NowNanos();
+    // Even when nothing changes, the planner runs every few frames to read the hotkeys
+    int64_t pollNanos = now + KEY_POLL_FRAMES * tickClock.GetFramePeriodNanos();
+    if (IsKeyPressed(KEY_END)) {
+        if (paused) {
+            paused = false;
+            sequences.Clear();
+            trayBusy = false;
+        } else {
+            paused = true;
+        }
+        return pollNanos;
+    }
+    if (IsKeyPressed(KEY_HOME)) {
+        paused = false;
+        return pollNanos;
+    }
+    std::shared_ptr<const WorldSnapshot> world = WorldReader::GetSnapshot();
+    if (world == nullptr || paused) {
+        return pollNanos;
     }
+    motion.Update(world->conveyor, world->timeNanos);
+    if (sequences.GetActiveCount() == 0) {
+        sequences.Spawn(Serve());
+    }
+    return std::min(sequences.Run(now), pollNanos);
 }
 
-std::vector<std::string> ItemManager::itemNames;
-std::unordered_map<int, ItemData> ItemManager::itemData;
-std::unordered_map<std::string, ItemData> ItemManager::itemDataByName;
\ No newline at end of file
+/**
+ * Drops the action sequences in flight and everything the planner learned, as if the bot had just started.
+ * Used when a simulated game starts over; must be called from the planner's thread.
+ */
+void GameState::ResetActions() {
+    sequences.Clear();
+    paused = false;
+    trayBusy = false;
+    customersSeenNanos = 0;
+    scheduler = OrderScheduler();
+    motion = MotionPredictor();
+    clicks = 0;
+    missedClicks = 0;
+    cursorX = 400.0f;
+    cursorY = 300.0f;
+}
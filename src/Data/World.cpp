@@ -0,0 +1,214 @@
+#include <World.h>
+#include <Managers.h>
+#include <Hash.h>
+#include <Feasibility.h>
+#include <Patience.h>
+#include <Recorder.h>
+#include <algorithm>
+#include <chrono>
+
+std::shared_ptr<WorldSnapshot> WorldReader::current;
+std::shared_ptr<WorldSnapshot> WorldReader::spare;
+std::atomic<bool> WorldReader::running{false};
+std::thread WorldReader::thread;
+uint64_t WorldReader::frame = 0;
+int64_t WorldReader::startNanos = 0;
+PatienceTracker WorldReader::patience;
+uint64_t WorldReader::level = 0;
+ChangeSignal WorldReader::publishSignal;
+
+/**
+ * Empties the snapshot, keeping the capacity of its buffers.
+ */
+void WorldSnapshot::Clear() {
+    frame = 0;
+    timeNanos = 0;
+    version = 0;
+    bbPercent = 0.0f;
+    conveyor.Clear();
+    customers.clear();
+    orders.clear();
+    ingredients.clear();
+    conveyorCounts.Clear();
+    requirements.clear();
+    missingIngredients.clear();
+}
+
+/**
+ * Starts the reader thread.
+ */
+void WorldReader::Start() {
+    if (running.exchange(true)) {
+        return;
+    }
+    thread = std::thread(ReaderThread);
+}
+
+/**
+ * Stops the reader thread and waits for it to finish.
+ */
+void WorldReader::Stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+/**
+ * Returns the most recently published snapshot.
+ * @return The snapshot, or @c nullptr if no snapshot has been published yet.
+ * @note This function is lock-free with respect to the reader; the snapshot stays valid for as long as it is held.
+ */
+std::shared_ptr<const WorldSnapshot> WorldReader::GetSnapshot() {
+    return std::atomic_load(&current);
+}
+
+/**
+ * Blocks until a snapshot is published, or until a deadline.
+ * @param count The number of snapshots the caller has seen, as returned by the previous call.
+ * @param deadlineNanos The steady clock time to stop waiting at.
+ * @return The number of snapshots published so far.
+ */
+uint64_t WorldReader::WaitForSnapshot(uint64_t count, int64_t deadlineNanos) {
+    return publishSignal.Wait(count, deadlineNanos);
+}
+
+/**
+ * Decodes the current state of the game into a snapshot.
+ * @param snapshot (out) The snapshot to fill.
+ * @note This function reads the game's memory through the page cache, but does not start a new epoch.
+ * Customer deadlines are estimated as of the current frame, which Publish advances before capturing.
+ */
+void WorldReader::Capture(WorldSnapshot &snapshot) {
+    static std::vector<ItemInfo> orderBuffer;
+    ProcessMemory &memory = GameState::GetMemory();
+    // Read before the customers, so customers of a level that ended meanwhile are never learned from as lost
+    uint64_t currentLevel = GameState::GetLevelCount();
+    snapshot.Clear();
+    snapshot.bbPercent = GameState::GetBBPercent();
+    GameState::GetConveyorItems(snapshot.conveyor);
+    GameState::UpdateItemGenerations(snapshot.conveyor);
+    uint64_t ordersHash = Hash::OFFSET_BASIS;
+    for (Customer &customer: GameState::GetCustomers()) {
+        CustomerEntry entry = {customer.GetAddress(), customer.GetId(memory), (int) snapshot.orders.size(), 0, 0, 0};
+        customer.GetItems(memory, orderBuffer);
+        ordersHash = Hash::Combine(ordersHash, customer.GetAddress());
+        ordersHash = Hash::Bytes(orderBuffer.data(), orderBuffer.size() * sizeof(ItemInfo), ordersHash);
+        for (const ItemInfo &info: orderBuffer) {
+            OrderEntry order = {info, (int) snapshot.ingredients.size(), 0, customer.GetAddress()};
+            ObjectKind kind = TypeCache::ClassifyObject(memory, info.mItem);
+            if (kind == ObjectKind::Simple) {
+                SimpleItemSnapshot recipe;
+                recipe.Read(memory, info.mItem);
+                snapshot.ingredients.push_back(recipe.ingredientId);
+            } else if (kind == ObjectKind::Complex) {
+                ComplexItemSnapshot recipe;
+                DWORD ingredientAddresses[ComplexItemSnapshot::MAX_ITEMS];
+                int count = recipe.Read(memory, info.mItem) ? recipe.ReadItemAddresses(memory, ingredientAddresses) : 0;
+                for (int i = 0; i < count; i++) {
+                    SimpleItemSnapshot ingredient;
+                    ingredient.Read(memory, ingredientAddresses[i]);
+                    snapshot.ingredients.push_back(ingredient.ingredientId);
+                }
+            }
+            order.ingredientCount = snapshot.ingredients.size() - order.firstIngredient;
+            snapshot.orders.push_back(order);
+        }
+        entry.orderCount = snapshot.orders.size() - entry.firstOrder;
+        snapshot.customers.push_back(entry);
+    }
+    if (currentLevel != level) {
+        // The customers of the last level left with it rather than running out of patience
+        patience.Reset();
+        level = currentLevel;
+    }
+    patience.Observe(frame, snapshot.customers, snapshot.orders);
+    Feasibility::CountConveyor(snapshot.conveyor, snapshot.conveyorCounts);
+    static std::vector<int> ingredientBuffer;
+    snapshot.requirements.resize(snapshot.orders.size());
+    for (size_t i = 0; i < snapshot.orders.size(); i++) {
+        Feasibility::CollectIngredients(snapshot, snapshot.orders[i], ingredientBuffer);
+        Feasibility::CountIngredients(ingredientBuffer, snapshot.requirements[i]);
+    }
+    Feasibility::CheckAll(snapshot.conveyorCounts, snapshot.requirements, snapshot.missingIngredients);
+    GameState::UpdateOrdersHash(ordersHash);
+    snapshot.version = GameState::GetStateVersion();
+    snapshot.wakes = GameState::GetWakeCount();
+}
+
+/**
+ * Captures a new snapshot and publishes it, waking the threads waiting for a snapshot.
+ * The buffers of the previously published snapshot are reused once no consumer holds it anymore.
+ */
+void WorldReader::Publish() {
+    std::shared_ptr<WorldSnapshot> next = std::move(spare);
+    if (next == nullptr || next.use_count() > 1) {
+        next = std::make_shared<WorldSnapshot>();
+    }
+    GameState::GetPageCache().BeginEpoch();
+    int64_t timeNanos = ChangeSignal::NowNanos();
+    // Frames count time rather than snapshots, since a change publishes a snapshot between frames
+    if (startNanos == 0) {
+        startNanos = timeNanos;
+    }
+    frame = (timeNanos - startNanos) / (FRAME_MILLIS * 1000000LL) + 1;
+    Capture(*next);
+    next->frame = frame;
+    next->timeNanos = timeNanos;
+    Recorder::RecordSnapshot(*next);
+    spare = std::atomic_exchange(&current, next);
+    publishSignal.Notify();
+}
+
+/**
+ * Publishes a snapshot if the game state changed or the bot acted on a frame since the published one was captured, as
+ * a planner run does when no reader thread publishes snapshots for it.
+ * @return Whether a snapshot was published.
+ */
+bool WorldReader::PublishIfStale() {
+    std::shared_ptr<const WorldSnapshot> world = GetSnapshot();
+    bool stale = world == nullptr || world->wakes != GameState::GetWakeCount();
+    // Holding the snapshot would keep Publish from reusing its buffers
+    world.reset();
+    if (stale) {
+        Publish();
+    }
+    return stale;
+}
+
+/**
+ * Returns the patience estimate of the customers.
+ * @return The patience tracker. Only the reader thread updates it.
+ */
+const PatienceTracker &WorldReader::GetPatience() {
+    return patience;
+}
+
+/**
+ * Drops the published snapshot, the frame count and the patience estimate, e.g. when a simulated game starts over.
+ * @note The reader thread must not be running.
+ */
+void WorldReader::Reset() {
+    std::atomic_store(&current, std::shared_ptr<WorldSnapshot>());
+    spare.reset();
+    frame = 0;
+    startNanos = 0;
+    patience.Reset();
+    level = GameState::GetLevelCount();
+}
+
+/**
+ * @internal
+ * Publishes a snapshot on every game frame the bot acts on, and whenever the game state changes in between, until the
+ * reader is stopped. Missed frames are stood in for by the tick clock's predictions; a stalled game is not polled.
+ */
+void WorldReader::ReaderThread() {
+    while (running.load()) {
+        Publish();
+        uint64_t wakes = current->wakes;
+        // Changes made by the capture itself are already in the snapshot, so they do not wake the reader again
+        GameState::WaitForWake(wakes, GameState::GetTickClock().GetDeadlineNanos(ChangeSignal::NowNanos()));
+    }
+}
@@ -2,45 +2,235 @@
 #include <Utils.h>
 #include <Managers.h>
 #include <Content.h>
+#include <ProcessMemory.h>
+#include <Actuator.h>
+#include <World.h>
 #include <atomic>
-#include <list>
-#include <functional>
+#include <chrono>
 #include <ntstatus.h>
 #include <tlhelp32.h>
 #include <iostream>
 #include <thread>
-#include <queue>
-#include <condition_variable>
 #include <Debugging.h>
+#include <BreakpointHandlers.h>
 
 #ifndef VERSION_0_5_9C
 #define VERSION_0_5_9C
 #endif
 
-std::mutex queueMutex;
-std::condition_variable queueCondition;
-std::queue<std::pair<DEBUG_EVENT, std::function<void(const DEBUG_EVENT &, HANDLE)>>> eventQueue;
+RingBuffer<BreakpointEvent, Debugging::EVENT_QUEUE_SIZE> Debugging::eventQueue;
+HANDLE Debugging::eventSignal = NULL;
+std::atomic<bool> Debugging::workerRunning{false};
+std::atomic<uint64_t> Debugging::droppedEvents{0};
+std::atomic<uint64_t> Debugging::unreadableEvents{0};
+LatencyHistogram Debugging::handleLatency;
+LatencyHistogram Debugging::suspendLatency;
 
-void WorkerThread(HANDLE handle) {
-    while (true) {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        queueCondition.wait(lock, [] { return !eventQueue.empty(); });
+/**
+ * @internal
+ * Returns the current steady clock time.
+ * @return The time in nanoseconds.
+ */
+static uint64_t NowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Sets a breakpoint at the specified address.
+ * @param address The address to set the breakpoint at.
+ * @param id The breakpoint, which selects the handler to run when it is hit.
+ * @return Whether the breakpoint was set successfully.
+ */
+bool BreakpointManager::SetBreakpoint(LPVOID address, BreakpointId id) {
+    Breakpoint bp;
+    bp.address = address;
+    bp.id = id;
 
-        auto item = eventQueue.front();
-        eventQueue.pop();
+    std::cout << "Setting breakpoint at address: " << address << std::endl;
 
-        lock.unlock();
+    // Read the original byte
+    BYTE originalByte;
+    if (!ReadProcessMemory(processHandle, address, &originalByte, sizeof(originalByte), NULL)) {
+        return false;
+    }
 
-        // Execute the callback with the event and handle
-        item.second(item.first, handle);
+    // Write 0xCC to set the breakpoint
+    BYTE int3 = 0xCC;
+    if (!WriteProcessMemory(processHandle, address, &int3, sizeof(int3), NULL)) {
+        return false;
     }
+
+    bp.originalByte = originalByte;
+    bp.isActive = true;
+    breakpoints[address] = bp;
+    return true;
 }
 
-void Debugging::EnqueueEvent(const DEBUG_EVENT &debugEvent, std::function<void(const DEBUG_EVENT &, HANDLE)> callback,
-                             HANDLE handle) {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    eventQueue.push(std::make_pair(debugEvent, callback));
-    queueCondition.notify_one();
+/**
+ * Handles a breakpoint.
+ * Captures the registers the breakpoint's handler needs and queues the handler for the worker thread.
+ * @param debugEvent The debug event.
+ * @return Whether the breakpoint was handled successfully.
+ */
+bool BreakpointManager::HandleBreakpoint(const DEBUG_EVENT &debugEvent) {
+    LPVOID address = (LPVOID) debugEvent.u.Exception.ExceptionRecord.ExceptionAddress;
+    auto it = breakpoints.find(address);
+    if (it == breakpoints.end()) {
+        return false;
+    }
+
+    Breakpoint &bp = it->second;
+
+    // Restore the original instruction
+    if (!WriteProcessMemory(processHandle, address, &bp.originalByte, sizeof(bp.originalByte), NULL)) {
+        return false;
+    }
+
+    // Get the thread context
+    threadHandle = OpenThread(THREAD_ALL_ACCESS, FALSE, debugEvent.dwThreadId);
+    CONTEXT context;
+    ZeroMemory(&context, sizeof(CONTEXT));
+    context.ContextFlags = CONTEXT_FULL;
+    bool hasRegisters = GetThreadContext(threadHandle, &context);
+
+    BreakpointEvent event{};
+    event.id = bp.id;
+    event.threadId = debugEvent.dwThreadId;
+    event.timestamp = NowNanos();
+#ifdef _WIN64
+    WOW64_CONTEXT wowContext;
+    hasRegisters = Utils::GetWow64ThreadContext(threadHandle, wowContext);
+    if (hasRegisters) {
+        event.eax = wowContext.Eax;
+        event.ebx = wowContext.Ebx;
+        event.ecx = wowContext.Ecx;
+        event.esi = wowContext.Esi;
+        event.edi = wowContext.Edi;
+    }
+#else
+    event.eax = context.Eax;
+    event.ebx = context.Ebx;
+    event.ecx = context.Ecx;
+    event.esi = context.Esi;
+    event.edi = context.Edi;
+#endif
+
+    // Set the trap flag for single-step execution
+    context.EFlags |= 0x100; // Set trap flag
+    SetThreadContext(threadHandle, &context);
+
+    CloseHandle(threadHandle);
+
+    // Schedule the handler, unless the registers it needs could not be read
+    if (hasRegisters) {
+        Debugging::EnqueueEvent(event);
+    } else {
+        Debugging::CountUnreadableEvent();
+    }
+
+    // Remember to reinstate this breakpoint after single-step
+    lastBreakpoint = &bp;
+
+    return true;
+}
+
+/**
+ * @internal
+ * Reinstates the last breakpoint.
+ */
+void BreakpointManager::ReinstateBreakpoint() {
+    if (lastBreakpoint && lastBreakpoint->isActive) {
+        BYTE int3 = 0xCC;
+        WriteProcessMemory(processHandle, lastBreakpoint->address, &int3, sizeof(int3), NULL);
+        lastBreakpoint = nullptr;
+    }
+}
+
+/**
+ * @internal
+ * Clears the single-step flag.
+ */
+void BreakpointManager::ClearSingleStep() {
+    CONTEXT context;
+    ZeroMemory(&context, sizeof(CONTEXT));
+    context.ContextFlags = CONTEXT_FULL;
+    GetThreadContext(threadHandle, &context);
+    context.EFlags &= ~0x100; // Clear trap flag
+    SetThreadContext(threadHandle, &context);
+}
+
+/**
+ * @internal
+ * Runs the handlers of queued breakpoint events until the debug loop ends.
+ */
+void Debugging::WorkerThread() {
+    BreakpointEvent event;
+    while (true) {
+        while (eventQueue.Pop(event)) {
+            BreakpointHandlers::Dispatch(event, GameState::GetDirectMemory());
+            handleLatency.Record(NowNanos() - event.timestamp);
+        }
+        if (!workerRunning.load()) {
+            break;
+        }
+        // The signal is auto-reset, so a push between the last pop and this wait still wakes the worker
+        WaitForSingleObject(eventSignal, INFINITE);
+    }
+}
+
+/**
+ * Queues a breakpoint event for the worker thread. Must only be called by the debug loop.
+ * @param event The event.
+ * @return @c false if the queue is full and the event was dropped.
+ * @note This function neither allocates nor locks, since the game thread is suspended while it runs.
+ */
+bool Debugging::EnqueueEvent(const BreakpointEvent &event) {
+    if (!eventQueue.Push(event)) {
+        droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    SetEvent(eventSignal);
+    return true;
+}
+
+/**
+ * Returns the time from a breakpoint hit until its handler has finished.
+ * @return The histogram.
+ */
+const LatencyHistogram &Debugging::GetHandleLatency() {
+    return handleLatency;
+}
+
+/**
+ * Returns the time the game thread is suspended per breakpoint hit.
+ * @return The histogram.
+ */
+const LatencyHistogram &Debugging::GetSuspendLatency() {
+    return suspendLatency;
+}
+
+/**
+ * Returns the number of breakpoint events dropped because the queue was full.
+ * @return The number of events.
+ */
+uint64_t Debugging::GetDroppedEvents() {
+    return droppedEvents.load(std::memory_order_relaxed);
+}
+
+/**
+ * Counts a breakpoint hit whose registers could not be read. Its event is dropped rather than handled.
+ */
+void Debugging::CountUnreadableEvent() {
+    unreadableEvents.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Returns the number of breakpoint hits dropped because their registers could not be read.
+ * @return The number of events.
+ */
+uint64_t Debugging::GetUnreadableEvents() {
+    return unreadableEvents.load(std::memory_order_relaxed);
 }
 
 void Debugging::DebugLoop() {
@@ -78,9 +268,15 @@ void Debugging::DebugLoop() {
         exit(0);
     }
     GameState::SetHandle(hProcess);
+    GameState::SetMemory(std::make_unique<Win32ProcessMemory>(hProcess));
+    GameState::SetActuator(std::make_unique<Win32Actuator>(windowHandle));
+    GameState::GetActuator().Start();
+    WorldReader::Start();
     GameState::SetWindowHandle(windowHandle);
     BreakpointManager bpManager(hProcess);
-    std::thread workerThread(WorkerThread, hProcess);
+    eventSignal = CreateEvent(NULL, FALSE, FALSE, NULL);
+    workerRunning = true;
+    std::thread workerThread(WorkerThread);
 
     /*
      * F3 0F10 96 4C010000 | movss xmm2,[esi+0000014C]
@@ -101,27 +297,7 @@ void Debugging::DebugLoop() {
     LPVOID bbOffset = (LPVOID) 0x168F53;
 #endif
     LPVOID bbAddress = (LPVOID) ((uintptr_t) baseAddress + (uintptr_t) bbOffset);
-    bpManager.SetBreakpoint(bbAddress, [](const DEBUG_EVENT &debugEvent, HANDLE hProcess) {
-        CONTEXT context;
-        context.ContextFlags = CONTEXT_FULL;
-        HANDLE hThread = OpenThread(THREAD_ALL_ACCESS, FALSE, debugEvent.dwThreadId);
-        if (hThread != NULL) {
-#ifdef _WIN64
-            WOW64_CONTEXT context;
-            if (Utils::GetWow64ThreadContext(hThread, context)) {
-#else
-            if (GetThreadContext(hThread, &context)) {
-#endif
-                DWORD address = context.Ecx;
-                float value;
-                if (!ReadProcessMemory(hProcess, (LPVOID) address, &value, sizeof(value), NULL)) {
-                    return;
-                }
-                GameState::SetBBPercent(value);
-            }
-            CloseHandle(hThread);
-        }
-    });
+    bpManager.SetBreakpoint(bbAddress, BreakpointId::BBPercent);
 
     /*
      * 8B F9            | mov edi,ecx
@@ -141,27 +317,7 @@ void Debugging::DebugLoop() {
     LPVOID conveyorSizeOffset = (LPVOID) 0x533EE;
 #endif
     LPVOID conveyorSizeAddress = (LPVOID) ((uintptr_t) baseAddress + (uintptr_t) conveyorSizeOffset);
-    bpManager.SetBreakpoint(conveyorSizeAddress, [](const DEBUG_EVENT &debugEvent, HANDLE hProcess) {
-        CONTEXT context;
-        context.ContextFlags = CONTEXT_FULL;
-        HANDLE hThread = OpenThread(THREAD_ALL_ACCESS, FALSE, debugEvent.dwThreadId);
-        if (hThread != NULL) {
-#ifdef _WIN64
-            WOW64_CONTEXT context;
-            if (Utils::GetWow64ThreadContext(hThread, context)) {
-#else
-            if (GetThreadContext(hThread, &context)) {
-#endif
-                DWORD address = context.Edi + 0x10C;
-                int value;
-                if (!ReadProcessMemory(hProcess, (LPVOID) address, &value, sizeof(value), NULL)) {
-                    return;
-                }
-                GameState::SetNumConveyorItems(value);
-            }
-            CloseHandle(hThread);
-        }
-    });
+    bpManager.SetBreakpoint(conveyorSizeAddress, BreakpointId::ConveyorSize);
 
     /*
      * 89 10             | mov [eax],edx
@@ -183,28 +339,7 @@ void Debugging::DebugLoop() {
     LPVOID addToConveyorOffset = (LPVOID) 0x422A7;
 #endif
     LPVOID addToConveyorAddress = (LPVOID) ((uintptr_t) baseAddress + (uintptr_t) addToConveyorOffset);
-    bpManager.SetBreakpoint(addToConveyorAddress, [](const DEBUG_EVENT &debugEvent, HANDLE hProcess) {
-        CONTEXT context;
-        context.ContextFlags = CONTEXT_FULL;
-        HANDLE hThread = OpenThread(THREAD_ALL_ACCESS, FALSE, debugEvent.dwThreadId);
-        if (hThread != NULL) {
-#ifdef _WIN64
-            WOW64_CONTEXT context;
-            if (Utils::GetWow64ThreadContext(hThread, context)) {
-#else
-            if (GetThreadContext(hThread, &context)) {
-#endif
-                DWORD startAddress = context.Eax;
-                Node node;
-                if (!Utils::ReadMemoryToBuffer(hProcess, startAddress, &node, sizeof(node))) {
-                    return;
-                }
-                DWORD item = node.content;
-                GameState::AddItemFromAddress(item);
-            }
-            CloseHandle(hThread);
-        }
-    });
+    bpManager.SetBreakpoint(addToConveyorAddress, BreakpointId::AddToConveyor);
 
     /*
      * 8B 46 04          | mov eax,[esi+04]
@@ -226,28 +361,7 @@ void Debugging::DebugLoop() {
     LPVOID removeFromConveyorOffset = (LPVOID) 0x516F9;
 #endif
     LPVOID removeFromConveyorAddress = (LPVOID) ((uintptr_t) baseAddress + (uintptr_t) removeFromConveyorOffset);
-    bpManager.SetBreakpoint(removeFromConveyorAddress, [](const DEBUG_EVENT &debugEvent, HANDLE hProcess) {
-        CONTEXT context;
-        context.ContextFlags = CONTEXT_FULL;
-        HANDLE hThread = OpenThread(THREAD_ALL_ACCESS, FALSE, debugEvent.dwThreadId);
-        if (hThread != NULL) {
-#ifdef _WIN64
-            WOW64_CONTEXT context;
-            if (Utils::GetWow64ThreadContext(hThread, context)) {
-#else
-            if (GetThreadContext(hThread, &context)) {
-#endif
-                DWORD nodeAddress = context.Esi;
-                Node node;
-                if (!Utils::ReadMemoryToBuffer(hProcess, nodeAddress, &node, sizeof(node))) {
-                    return;
-                }
-                DWORD item = node.content;
-                GameState::RemoveItemFromAddress(item);
-            }
-            CloseHandle(hThread);
-        }
-    });
+    bpManager.SetBreakpoint(removeFromConveyorAddress, BreakpointId::RemoveFromConveyor);
 
     /*
      * 8B 03          | mov eax,[ebx]
@@ -267,27 +381,7 @@ void Debugging::DebugLoop() {
     LPVOID customerOffset = (LPVOID) 0x19206;
 #endif
     LPVOID customerAddress = (LPVOID) ((uintptr_t) baseAddress + (uintptr_t) customerOffset);
-    bpManager.SetBreakpoint(customerAddress, [](const DEBUG_EVENT &debugEvent, HANDLE hProcess) {
-        CONTEXT context;
-        context.ContextFlags = CONTEXT_FULL;
-        HANDLE hThread = OpenThread(THREAD_ALL_ACCESS, FALSE, debugEvent.dwThreadId);
-        if (hThread != NULL) {
-#ifdef _WIN64
-            WOW64_CONTEXT context;
-            if (Utils::GetWow64ThreadContext(hThread, context)) {
-#else
-            if (GetThreadContext(hThread, &context)) {
-#endif
-                DWORD address = context.Ebx;
-                Customer customer(address);
-                if (customer.isValid(hProcess)) {
-                    GameState::AddCustomer(customer);
-                }
-            }
-
-            CloseHandle(hThread);
-        }
-    });
+    bpManager.SetBreakpoint(customerAddress, BreakpointId::AddCustomer);
 
     /*
      * C7 86 08010000 00000000 | mov [esi+00000108],00000000
@@ -309,9 +403,7 @@ void Debugging::DebugLoop() {
     LPVOID resetOffset = (LPVOID) 0x4ECE0;
 #endif
     LPVOID resetAddress = (LPVOID) ((uintptr_t) baseAddress + (uintptr_t) resetOffset);
-    bpManager.SetBreakpoint(resetAddress, [](const DEBUG_EVENT &debugEvent, HANDLE hProcess) {
-        GameState::Reset();
-    });
+    bpManager.SetBreakpoint(resetAddress, BreakpointId::Reset);
 
     if (DebugActiveProcess(pid)) {
         DEBUG_EVENT debugEvent;
@@ -319,8 +411,7 @@ void Debugging::DebugLoop() {
             while (WaitForDebugEvent(&debugEvent, 1000)) {
                 DWORD continueStatus = DBG_CONTINUE;
                 if (debugEvent.dwDebugEventCode == EXCEPTION_DEBUG_EVENT) {
-                    long startTick = GetTickCount();
-                    long time;
+                    uint64_t start = NowNanos();
                     switch (debugEvent.u.Exception.ExceptionRecord.ExceptionCode) {
                         case static_cast<DWORD>(EXCEPTION_BREAKPOINT):
                         case static_cast<DWORD>(STATUS_WX86_BREAKPOINT):
@@ -355,11 +446,7 @@ void Debugging::DebugLoop() {
                                     CloseHandle(hThread);
                                 }
                             }
-                            time = GetTickCount() - startTick;
-                            if (time > 50) {
-                                std::cerr << "Warning: Breakpoint callback took " << time << "ms to execute."
-                                          << std::endl;
-                            }
+                            suspendLatency.Record(NowNanos() - start);
                             break;
                         case static_cast<DWORD>(EXCEPTION_SINGLE_STEP):
                         case static_cast<DWORD>(STATUS_WX86_SINGLE_STEP):
@@ -381,5 +468,27 @@ void Debugging::DebugLoop() {
     } else {
         std::cout << "Error: Could not attach debugger to process." << std::endl;
     }
+    workerRunning = false;
+    SetEvent(eventSignal);
+    workerThread.join();
+    CloseHandle(eventSignal);
+    WorldReader::Stop();
+    GameState::GetActuator().Stop();
+    suspendLatency.Print(std::cout, "Breakpoint suspend time");
+    handleLatency.Print(std::cout, "Breakpoint handle latency");
+    GameState::GetActuator().GetSendLatency().Print(std::cout, "Input send latency");
+    GameState::GetActuator().GetConfirmLatency().Print(std::cout, "Click confirm latency");
+    GameState::GetTickClock().Print(std::cout);
+    if (GameState::GetActuator().GetUnconfirmedCount() > 0) {
+        std::cout << "Warning: " << GameState::GetActuator().GetUnconfirmedCount()
+                  << " clicks did not take their item." << std::endl;
+    }
+    if (GetDroppedEvents() > 0) {
+        std::cout << "Warning: Dropped " << GetDroppedEvents() << " breakpoint events." << std::endl;
+    }
+    if (GetUnreadableEvents() > 0) {
+        std::cout << "Warning: Could not read the registers of " << GetUnreadableEvents() << " breakpoint hits."
+                  << std::endl;
+    }
     CloseHandle(hProcess);
 }
\ No newline at end of file
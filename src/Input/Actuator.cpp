@@ -0,0 +1,263 @@
+#include <Actuator.h>
+#include <ChangeSignal.h>
+#include <Recorder.h>
+#include <algorithm>
+#include <chrono>
+
+/**
+ * @internal
+ * Returns the current steady clock time in nanoseconds. The latencies use the bot's clock instead, so that a simulated
+ * game sees the latencies of its own time.
+ */
+static uint64_t NowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Starts the actuator thread.
+ */
+void Actuator::Start() {
+    std::lock_guard<std::mutex> lock(signalMutex);
+    if (running) {
+        return;
+    }
+    running = true;
+    thread = std::thread(&Actuator::WorkerThread, this);
+}
+
+/**
+ * Stops the actuator thread after it has sent the commands already queued, and waits for it to finish.
+ */
+void Actuator::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(signalMutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    signal.notify_one();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+/**
+ * Queues a command. Returns immediately.
+ * @param type The action.
+ * @param x The absolute x coordinate on the screen.
+ * @param y The absolute y coordinate on the screen.
+ * @param item The conveyor item a click is expected to take off the conveyor, or 0.
+ * @return The sequence number of the command, starting at 1, or 0 if the queue is full.
+ */
+uint64_t Actuator::Submit(ActuatorCommandType type, int x, int y, DWORD item) {
+    ActuatorCommand command = {type, x, y, item, submittedCount.load() + 1, (uint64_t) ChangeSignal::NowNanos()};
+    if (!queue.Push(command)) {
+        return 0;
+    }
+    submittedCount.fetch_add(1);
+    Recorder::RecordAction(command);
+    {
+        // Taking the lock orders the push before the worker's check, so the wakeup cannot be lost
+        std::lock_guard<std::mutex> lock(signalMutex);
+    }
+    signal.notify_one();
+    return command.sequence;
+}
+
+/**
+ * Confirms a click, because the game took its item off the conveyor.
+ * @param item The address of the item.
+ * @return Whether a sent click was waiting for this item.
+ * @note This function is thread-safe.
+ */
+bool Actuator::Confirm(DWORD item) {
+    if (item == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    for (auto it = pending.begin(); it != pending.end(); ++it) {
+        if (it->item == item) {
+            confirmLatency.Record(ChangeSignal::NowNanos() - it->sentNanos);
+            pending.erase(it);
+            confirmedCount.fetch_add(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Waits until every submitted command has been sent.
+ * @param timeoutNanos The maximum time to wait.
+ * @return Whether every command was sent in time.
+ */
+bool Actuator::WaitIdle(int64_t timeoutNanos) {
+    std::unique_lock<std::mutex> lock(signalMutex);
+    return idleSignal.wait_for(lock, std::chrono::nanoseconds(timeoutNanos), [this]() {
+        return sentCount.load() == submittedCount.load();
+    });
+}
+
+/**
+ * Returns the number of commands submitted.
+ * @return The number of commands.
+ */
+uint64_t Actuator::GetSubmittedCount() const {
+    return submittedCount.load();
+}
+
+/**
+ * Returns the number of commands sent to the game.
+ * @return The number of commands.
+ */
+uint64_t Actuator::GetSentCount() const {
+    return sentCount.load();
+}
+
+/**
+ * Returns the number of batches sent to the game.
+ * @return The number of batches.
+ */
+uint64_t Actuator::GetBatchCount() const {
+    return batchCount.load();
+}
+
+/**
+ * Returns the number of clicks the game confirmed by taking their item.
+ * @return The number of clicks.
+ */
+uint64_t Actuator::GetConfirmedCount() const {
+    return confirmedCount.load();
+}
+
+/**
+ * Returns the number of clicks that were forgotten without a confirmation.
+ * @return The number of clicks.
+ */
+uint64_t Actuator::GetUnconfirmedCount() const {
+    return unconfirmedCount.load();
+}
+
+/**
+ * Returns the time the most recently sent command spent between submission and sending.
+ * @return The latency in nanoseconds.
+ */
+int64_t Actuator::GetLastSendLatencyNanos() const {
+    return lastSendLatency.load();
+}
+
+/**
+ * Returns the distribution of the time between submitting and sending a command.
+ * @return The histogram.
+ */
+const LatencyHistogram &Actuator::GetSendLatency() const {
+    return sendLatency;
+}
+
+/**
+ * Returns the distribution of the time between sending a click and the game taking its item.
+ * @return The histogram.
+ */
+const LatencyHistogram &Actuator::GetConfirmLatency() const {
+    return confirmLatency;
+}
+
+/**
+ * Sends everything queued as one batch on the calling thread.
+ * The worker thread does this whenever commands arrive; an actuator that is not started, e.g. in a simulation, is
+ * flushed by its owner instead.
+ * @return The number of commands sent.
+ */
+size_t Actuator::Flush() {
+    ActuatorCommand batch[QUEUE_CAPACITY];
+    size_t count = 0;
+    while (count < QUEUE_CAPACITY && queue.Pop(batch[count])) {
+        count++;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    {
+        // The clicks wait for confirmation before they are sent, as the game can take an item before SendBatch returns
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        uint64_t sendNanos = ChangeSignal::NowNanos();
+        for (size_t i = 0; i < count; i++) {
+            if (batch[i].type == ActuatorCommandType::Click && batch[i].item != 0) {
+                if (pending.size() == MAX_PENDING) {
+                    pending.erase(pending.begin());
+                    unconfirmedCount.fetch_add(1);
+                }
+                pending.push_back({batch[i].item, sendNanos});
+            }
+        }
+    }
+    SendBatch(batch, count);
+    uint64_t sentNanos = ChangeSignal::NowNanos();
+    for (size_t i = 0; i < count; i++) {
+        sendLatency.Record(sentNanos - batch[i].submitNanos);
+    }
+    lastSendLatency = sentNanos - batch[count - 1].submitNanos;
+    batchCount.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(signalMutex);
+        sentCount.fetch_add(count);
+    }
+    idleSignal.notify_all();
+    return count;
+}
+
+/**
+ * @internal
+ * Sends everything queued as one batch whenever commands arrive, until the actuator is stopped.
+ */
+void Actuator::WorkerThread() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(signalMutex);
+            signal.wait(lock, [this]() {
+                return !running || !queue.IsEmpty();
+            });
+            if (!running && queue.IsEmpty()) {
+                break;
+            }
+        }
+        Flush();
+    }
+}
+
+/**
+ * Stops the actuator before the recording goes away.
+ */
+RecordingActuator::~RecordingActuator() {
+    Stop();
+}
+
+/**
+ * Returns the commands recorded so far.
+ * @return A copy of the records, in the order they were sent.
+ */
+std::vector<RecordingActuator::Record> RecordingActuator::GetRecords() {
+    std::lock_guard<std::mutex> lock(recordsMutex);
+    return records;
+}
+
+/**
+ * Records a batch, taking as long as a real batch would.
+ * @param commands The commands.
+ * @param count The number of commands.
+ * @return @c true.
+ */
+bool RecordingActuator::SendBatch(const ActuatorCommand *commands, size_t count) {
+    uint64_t start = NowNanos();
+    while ((int64_t) (NowNanos() - start) < batchNanos) {
+        std::this_thread::yield();
+    }
+    std::lock_guard<std::mutex> lock(recordsMutex);
+    batches++;
+    for (size_t i = 0; i < count; i++) {
+        records.push_back({commands[i], batches, start});
+    }
+    return true;
+}
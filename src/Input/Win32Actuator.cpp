@@ -0,0 +1,58 @@
+#include <Windows.h>
+#include <Actuator.h>
+#include <iostream>
+
+/**
+ * Stops the actuator before the window handle goes away.
+ */
+Win32Actuator::~Win32Actuator() {
+    Stop();
+}
+
+/**
+ * Sends a batch with a single @c SendInput call.
+ * Absolute moves are scaled to the 0-65535 range of the primary screen. The game window is brought to the front once
+ * per batch, and only waited on if it was not in front already.
+ * @param commands The commands.
+ * @param count The number of commands.
+ * @return Whether every input event was sent.
+ */
+bool Win32Actuator::SendBatch(const ActuatorCommand *commands, size_t count) {
+    if (window != GetForegroundWindow()) {
+        SetForegroundWindow(window);
+        Sleep(100);
+    }
+    inputs.clear();
+    double xScale = 65535.0 / GetSystemMetrics(SM_CXSCREEN);
+    double yScale = 65535.0 / GetSystemMetrics(SM_CYSCREEN);
+    for (size_t i = 0; i < count; i++) {
+        const ActuatorCommand &command = commands[i];
+        INPUT input = {0};
+        input.type = INPUT_MOUSE;
+        if (command.type != ActuatorCommandType::RightClick) {
+            input.mi.dx = static_cast<long>(command.x * xScale);
+            input.mi.dy = static_cast<long>(command.y * yScale);
+            input.mi.dwFlags = MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_MOVE;
+            inputs.push_back(input);
+            input.mi.dx = 0;
+            input.mi.dy = 0;
+        }
+        if (command.type == ActuatorCommandType::Click) {
+            input.mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
+            inputs.push_back(input);
+            input.mi.dwFlags = MOUSEEVENTF_LEFTUP;
+            inputs.push_back(input);
+        } else if (command.type == ActuatorCommandType::RightClick) {
+            input.mi.dwFlags = MOUSEEVENTF_RIGHTDOWN;
+            inputs.push_back(input);
+            input.mi.dwFlags = MOUSEEVENTF_RIGHTUP;
+            inputs.push_back(input);
+        }
+    }
+    UINT sent = SendInput(inputs.size(), inputs.data(), sizeof(INPUT));
+    if (sent != inputs.size()) {
+        std::cout << "Error: Could not send input. Sent " << sent << " of " << inputs.size() << " events." << std::endl;
+        return false;
+    }
+    return true;
+}
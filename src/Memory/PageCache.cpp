@@ -0,0 +1,236 @@
+#include <PageCache.h>
+#include <Recorder.h>
+#include <algorithm>
+#include <cstring>
+
+static_assert(PageCache::PAGE_SIZE == Recorder::PAGE_SIZE, "The Recorder must take the pages the cache fetches");
+
+/**
+ * Starts a new epoch. Pages fetched in earlier epochs are fetched again on their next read.
+ */
+void PageCache::BeginEpoch() {
+    std::lock_guard<std::mutex> lock(mutex);
+    epoch++;
+    if (pages.size() > MAX_PAGES) {
+        // Drop the pages that were not touched in the last epoch
+        for (auto it = pages.begin(); it != pages.end();) {
+            if (it->second == nullptr || it->second->epoch < epoch - 1) {
+                it = pages.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+/**
+ * Returns the current epoch.
+ * @return The current epoch.
+ */
+uint64_t PageCache::GetEpoch() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return epoch;
+}
+
+/**
+ * Drops all cached pages.
+ */
+void PageCache::Invalidate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    invalidations++;
+    pages.clear();
+}
+
+/**
+ * Drops the cached pages overlapping an address range.
+ * @param address The start of the range.
+ * @param size The size of the range.
+ */
+void PageCache::Invalidate(DWORD address, SIZE_T size) {
+    if (size == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    invalidations++;
+    uint64_t last = (static_cast<uint64_t>(address) + size - 1) & ~static_cast<uint64_t>(PAGE_SIZE - 1);
+    for (uint64_t page = address & ~(PAGE_SIZE - 1); page <= last; page += PAGE_SIZE) {
+        pages.erase(static_cast<DWORD>(page));
+    }
+}
+
+/**
+ * Reads directly from the backend, bypassing the cache.
+ * @param address The address to read from.
+ * @param buffer (out) The buffer to read into.
+ * @param size The size of the buffer.
+ * @return @c true if the whole range was read, @c false otherwise.
+ */
+bool PageCache::ReadUncached(DWORD address, LPVOID buffer, SIZE_T size) {
+    return backend.Read(address, buffer, size);
+}
+
+/**
+ * Returns the memory this cache reads from.
+ * @return The backend memory.
+ */
+ProcessMemory &PageCache::GetBackend() {
+    return backend;
+}
+
+/**
+ * Returns the number of page lookups that were served from the cache.
+ * @return The number of hits.
+ */
+uint64_t PageCache::GetHits() const {
+    return hits.load(std::memory_order_relaxed);
+}
+
+/**
+ * Returns the number of page lookups that had to read from the backend.
+ * @return The number of misses.
+ */
+uint64_t PageCache::GetMisses() const {
+    return misses.load(std::memory_order_relaxed);
+}
+
+/**
+ * Returns the number of bytes read from the backend.
+ * @return The number of bytes.
+ */
+uint64_t PageCache::GetBytesFetched() const {
+    return bytesFetched.load(std::memory_order_relaxed);
+}
+
+/**
+ * Resets the hit, miss and byte counters.
+ */
+void PageCache::ResetCacheCounters() {
+    hits.store(0, std::memory_order_relaxed);
+    misses.store(0, std::memory_order_relaxed);
+    bytesFetched.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * Marks whether the pages this cache fetches, and the reads of pages it cannot fetch, are recorded while a session is
+ * being recorded. Reads served from the cache are not; the recording has their bytes from the fetch.
+ * @param value Whether to record the fetches.
+ * @note Must be set before the cache is read from concurrently.
+ */
+void PageCache::SetFetchesRecorded(bool value) {
+    fetchesRecorded = value;
+}
+
+bool PageCache::ReadImpl(DWORD address, LPVOID buffer, SIZE_T size) {
+    if (static_cast<uint64_t>(address) + size > 0x100000000ULL) {
+        return false;
+    }
+    BYTE *out = static_cast<BYTE *>(buffer);
+    SIZE_T done = 0;
+    while (done < size) {
+        DWORD current = address + done;
+        DWORD pageAddress = current & ~(PAGE_SIZE - 1);
+        DWORD offset = current - pageAddress;
+        SIZE_T chunk = std::min<SIZE_T>(size - done, PAGE_SIZE - offset);
+        std::unique_ptr<Page> stale;
+        PageState state = CopyCached(pageAddress, offset, out + done, chunk, stale);
+        if (state == PageState::Missing) {
+            state = Fetch(pageAddress, offset, out + done, chunk, std::move(stale));
+        }
+        if (state == PageState::Unreadable) {
+            // The page is not fully readable; fall back to reading just the requested bytes
+            if (!backend.Read(current, out + done, chunk)) {
+                return false;
+            }
+            bytesFetched.fetch_add(chunk, std::memory_order_relaxed);
+            if (fetchesRecorded) {
+                Recorder::RecordMemory(current, out + done, chunk);
+            }
+        }
+        done += chunk;
+    }
+    return true;
+}
+
+bool PageCache::WriteImpl(DWORD address, LPCVOID buffer, SIZE_T size) {
+    bool result = backend.Write(address, buffer, size);
+    Invalidate(address, size);
+    return result;
+}
+
+/**
+ * @internal
+ * Copies bytes of a page if the page is cached in the current epoch.
+ * @param pageAddress The address of the page.
+ * @param offset The offset of the bytes in the page.
+ * @param out (out) Receives the bytes if the page is cached and readable.
+ * @param size The number of bytes, which must not cross the end of the page.
+ * @param stale (out) Receives the stale copy of the page if it must be fetched, to fetch into.
+ * @return Whether the bytes were copied, the page is known to be unreadable, or it must be fetched.
+ */
+PageCache::PageState PageCache::CopyCached(DWORD pageAddress, DWORD offset, BYTE *out, SIZE_T size,
+                                           std::unique_ptr<Page> &stale) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pages.find(pageAddress);
+    if (it == pages.end() || it->second == nullptr || it->second->epoch != epoch) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        if (it != pages.end()) {
+            // The entry stays, so that the fetch can put the page back without allocating
+            stale = std::move(it->second);
+        }
+        return PageState::Missing;
+    }
+    hits.fetch_add(1, std::memory_order_relaxed);
+    if (!it->second->readable) {
+        return PageState::Unreadable;
+    }
+    memcpy(out, it->second->data + offset, size);
+    return PageState::Cached;
+}
+
+/**
+ * @internal
+ * Reads a whole page from the backend without holding the lock, copies the requested bytes out of it, and caches it,
+ * or the failure to read it, for the epoch. A fetch that overlapped an invalidation or a new epoch is not cached.
+ * @param pageAddress The address of the page.
+ * @param offset The offset of the bytes in the page.
+ * @param out (out) Receives the bytes if the page could be read.
+ * @param size The number of bytes, which must not cross the end of the page.
+ * @param page The page to fetch into, or @c nullptr to allocate one.
+ * @return Whether the bytes were copied or the page is unreadable; never Missing.
+ */
+PageCache::PageState PageCache::Fetch(DWORD pageAddress, DWORD offset, BYTE *out, SIZE_T size,
+                                      std::unique_ptr<Page> page) {
+    uint64_t fetchEpoch;
+    uint64_t fetchInvalidations;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fetchEpoch = epoch;
+        fetchInvalidations = invalidations;
+    }
+    if (page == nullptr) {
+        page = std::make_unique<Page>();
+    }
+    bool readable;
+    if (fetchesRecorded) {
+        // The page is read next to the copy of its previous fetch, for the Recorder to find what changed
+        BYTE fetched[PAGE_SIZE];
+        readable = backend.Read(pageAddress, fetched, PAGE_SIZE);
+        if (readable) {
+            uint32_t copySession = page->readable ? page->recordedSession : 0;
+            page->recordedSession = Recorder::RecordPage(pageAddress, fetched, page->data, copySession);
+        }
+    } else {
+        readable = backend.Read(pageAddress, page->data, PAGE_SIZE);
+    }
+    if (readable) {
+        bytesFetched.fetch_add(PAGE_SIZE, std::memory_order_relaxed);
+        memcpy(out, page->data + offset, size);
+    }
+    page->epoch = fetchEpoch;
+    page->readable = readable;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (epoch == fetchEpoch && invalidations == fetchInvalidations) {
+        pages[pageAddress] = std::move(page);
+    }
+    return readable ? PageState::Cached : PageState::Unreadable;
+}
@@ -0,0 +1,329 @@
+#include <ProcessMemory.h>
+#include <Recorder.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Dump file layout (little-endian):
+ *   char[4]  magic "BS3D"
+ *   uint32   version (1)
+ *   uint32   number of regions
+ *   per region: uint32 base, uint32 size, followed by size bytes of memory
+ */
+static const char DUMP_MAGIC[4] = {'B', 'S', '3', 'D'};
+static const uint32_t DUMP_VERSION = 1;
+
+/**
+ * Reads memory into a buffer.
+ * @param address The address to read from.
+ * @param buffer (out) The buffer to read into.
+ * @param size The size of the buffer.
+ * @return @c true if the whole range was read, @c false otherwise.
+ */
+bool ProcessMemory::Read(DWORD address, LPVOID buffer, SIZE_T size) {
+    auto start = std::chrono::steady_clock::now();
+    bool result = ReadImpl(address, buffer, size);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    readCount.fetch_add(1, std::memory_order_relaxed);
+    bytesRead.fetch_add(size, std::memory_order_relaxed);
+    readNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                        std::memory_order_relaxed);
+    if (result && recorded) {
+        Recorder::RecordMemory(address, buffer, size);
+    }
+    return result;
+}
+
+/**
+ * Writes a buffer to memory.
+ * @param address The address to write to.
+ * @param buffer The buffer to write.
+ * @param size The size of the buffer.
+ * @return @c true if the whole range was written, @c false otherwise.
+ */
+bool ProcessMemory::Write(DWORD address, LPCVOID buffer, SIZE_T size) {
+    writeCount.fetch_add(1, std::memory_order_relaxed);
+    return WriteImpl(address, buffer, size);
+}
+
+/**
+ * Returns the number of reads since the last reset.
+ * @return The number of reads.
+ */
+uint64_t ProcessMemory::GetReadCount() const {
+    return readCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * Returns the number of bytes requested by reads since the last reset.
+ * @return The number of bytes.
+ */
+uint64_t ProcessMemory::GetBytesRead() const {
+    return bytesRead.load(std::memory_order_relaxed);
+}
+
+/**
+ * Returns the total time spent in reads since the last reset.
+ * @return The time in nanoseconds.
+ */
+uint64_t ProcessMemory::GetReadNanos() const {
+    return readNanos.load(std::memory_order_relaxed);
+}
+
+/**
+ * Returns the number of writes since the last reset.
+ * @return The number of writes.
+ */
+uint64_t ProcessMemory::GetWriteCount() const {
+    return writeCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * Resets the read and write counters.
+ */
+void ProcessMemory::ResetCounters() {
+    readCount.store(0, std::memory_order_relaxed);
+    bytesRead.store(0, std::memory_order_relaxed);
+    readNanos.store(0, std::memory_order_relaxed);
+    writeCount.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * Marks whether the reads of this memory are recorded while a session is being recorded.
+ * @param value Whether to record the reads.
+ * @note Must be set before the memory is read from concurrently.
+ */
+void ProcessMemory::SetRecorded(bool value) {
+    recorded = value;
+}
+
+ImageProcessMemory::~ImageProcessMemory() {
+    Clear();
+}
+
+/**
+ * Allocates a zeroed region in the image.
+ * @param base The address of the region.
+ * @param size The size of the region.
+ * @return A pointer to the region's memory, or @c nullptr if the region overlaps an existing one.
+ */
+BYTE *ImageProcessMemory::MapRegion(DWORD base, SIZE_T size) {
+    std::unique_ptr<BYTE[]> buffer(new BYTE[size]());
+    if (!AddRegion(base, size, buffer.get())) {
+        return nullptr;
+    }
+    ownedBuffers.push_back(std::move(buffer));
+    return ownedBuffers.back().get();
+}
+
+/**
+ * Loads the regions of a dump file into the image.
+ * @param filename The dump file.
+ * @return Whether the dump was loaded successfully. If not, the image is left as it was.
+ * @note On POSIX systems the file is mapped copy-on-write, so writes to the image never reach the file.
+ */
+bool ImageProcessMemory::LoadDump(const std::string &filename) {
+#ifdef _WIN32
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cout << "Error: Could not open dump " << filename << std::endl;
+        return false;
+    }
+    SIZE_T fileSize = file.tellg();
+    std::unique_ptr<BYTE[]> contents(new BYTE[fileSize]);
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char *>(contents.get()), fileSize)) {
+        std::cout << "Error: Could not read dump " << filename << std::endl;
+        return false;
+    }
+    BYTE *data = contents.get();
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cout << "Error: Could not open dump " << filename << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        std::cout << "Error: Could not read dump " << filename << std::endl;
+        return false;
+    }
+    SIZE_T fileSize = st.st_size;
+    void *mapping = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cout << "Error: Could not map dump " << filename << std::endl;
+        return false;
+    }
+    BYTE *data = static_cast<BYTE *>(mapping);
+#endif
+    // A dump that fails partway leaves the image as it was
+    std::map<DWORD, Region> previous = regions;
+    if (!AddDumpRegions(data, fileSize, filename)) {
+        regions = std::move(previous);
+#ifndef _WIN32
+        munmap(mapping, fileSize);
+#endif
+        return false;
+    }
+#ifdef _WIN32
+    ownedBuffers.push_back(std::move(contents));
+#else
+    fileMappings.push_back({mapping, fileSize});
+#endif
+    return true;
+}
+
+/**
+ * @internal
+ * Adds the regions of a dump file's contents to the image. On failure, some of them may have been added.
+ * @param data The contents of the dump file, which must outlive the regions.
+ * @param fileSize The size of the contents.
+ * @param filename The dump file, for errors.
+ * @return Whether the dump was valid and all of its regions were added.
+ */
+bool ImageProcessMemory::AddDumpRegions(BYTE *data, SIZE_T fileSize, const std::string &filename) {
+    uint32_t header[3];
+    if (fileSize < sizeof(header) || memcmp(data, DUMP_MAGIC, sizeof(DUMP_MAGIC)) != 0) {
+        std::cout << "Error: " << filename << " is not a memory dump." << std::endl;
+        return false;
+    }
+    memcpy(header, data, sizeof(header));
+    if (header[1] != DUMP_VERSION) {
+        std::cout << "Error: Unsupported dump version " << header[1] << std::endl;
+        return false;
+    }
+    SIZE_T offset = sizeof(header);
+    for (uint32_t i = 0; i < header[2]; i++) {
+        uint32_t regionHeader[2];
+        if (fileSize - offset < sizeof(regionHeader)) {
+            std::cout << "Error: Truncated dump " << filename << std::endl;
+            return false;
+        }
+        memcpy(regionHeader, data + offset, sizeof(regionHeader));
+        offset += sizeof(regionHeader);
+        if (fileSize - offset < regionHeader[1]) {
+            std::cout << "Error: Truncated dump " << filename << std::endl;
+            return false;
+        }
+        if (!AddRegion(regionHeader[0], regionHeader[1], data + offset)) {
+            std::cout << "Error: Overlapping region at " << regionHeader[0] << " in " << filename << std::endl;
+            return false;
+        }
+        offset += regionHeader[1];
+    }
+    return true;
+}
+
+/**
+ * Writes all regions of the image to a dump file.
+ * @param filename The dump file.
+ * @return Whether the dump was written successfully.
+ */
+bool ImageProcessMemory::SaveDump(const std::string &filename) const {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cout << "Error: Could not open dump " << filename << std::endl;
+        return false;
+    }
+    uint32_t header[3];
+    memcpy(header, DUMP_MAGIC, sizeof(DUMP_MAGIC));
+    header[1] = DUMP_VERSION;
+    header[2] = regions.size();
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    for (const auto &entry: regions) {
+        const Region &region = entry.second;
+        uint32_t regionHeader[2] = {region.base, static_cast<uint32_t>(region.size)};
+        file.write(reinterpret_cast<const char *>(regionHeader), sizeof(regionHeader));
+        file.write(reinterpret_cast<const char *>(region.data), region.size);
+    }
+    return file.good();
+}
+
+/**
+ * Translates an address range of the image to local memory.
+ * @param address The address.
+ * @param size The size of the range.
+ * @return A pointer to the local copy of the range, or @c nullptr if the range is not fully contained in one region.
+ */
+BYTE *ImageProcessMemory::Translate(DWORD address, SIZE_T size) {
+    auto it = regions.upper_bound(address);
+    if (it == regions.begin()) {
+        return nullptr;
+    }
+    --it;
+    const Region &region = it->second;
+    uint64_t offset = static_cast<uint64_t>(address) - region.base;
+    if (offset + size > region.size) {
+        return nullptr;
+    }
+    return region.data + offset;
+}
+
+/**
+ * Removes all regions from the image.
+ */
+void ImageProcessMemory::Clear() {
+    regions.clear();
+    ownedBuffers.clear();
+#ifndef _WIN32
+    for (FileMapping &mapping: fileMappings) {
+        munmap(mapping.data, mapping.size);
+    }
+#endif
+    fileMappings.clear();
+}
+
+bool ImageProcessMemory::ReadImpl(DWORD address, LPVOID buffer, SIZE_T size) {
+    BYTE *data = Translate(address, size);
+    if (data == nullptr) {
+        return false;
+    }
+    memcpy(buffer, data, size);
+    return true;
+}
+
+bool ImageProcessMemory::WriteImpl(DWORD address, LPCVOID buffer, SIZE_T size) {
+    BYTE *data = Translate(address, size);
+    if (data == nullptr) {
+        return false;
+    }
+    memcpy(data, buffer, size);
+    return true;
+}
+
+/**
+ * @internal
+ * Adds a region to the image.
+ * @return @c false if the region is empty, exceeds the 32-bit address space or overlaps an existing region.
+ */
+bool ImageProcessMemory::AddRegion(DWORD base, SIZE_T size, BYTE *data) {
+    if (size == 0 || static_cast<uint64_t>(base) + size > 0x100000000ULL) {
+        return false;
+    }
+    auto next = regions.lower_bound(base);
+    if (next != regions.end() && next->second.base < static_cast<uint64_t>(base) + size) {
+        return false;
+    }
+    if (next != regions.begin()) {
+        auto prev = std::prev(next);
+        if (static_cast<uint64_t>(prev->second.base) + prev->second.size > base) {
+            return false;
+        }
+    }
+    regions[base] = {base, size, data};
+    return true;
+}
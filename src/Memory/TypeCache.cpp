@@ -0,0 +1,87 @@
+#include <TypeCache.h>
+
+std::mutex TypeCache::mutex;
+std::unordered_map<DWORD, ObjectKind> TypeCache::kinds;
+size_t TypeCache::unknownEntries = 0;
+std::atomic<uint64_t> TypeCache::hits{0};
+std::atomic<uint64_t> TypeCache::misses{0};
+
+/**
+ * Classifies a vtable.
+ * @param memory The memory of the game process.
+ * @param vtable The vtable pointer, i.e. the first value of an object.
+ * @return The kind of object the vtable belongs to.
+ * @note Vtables that could not be read are not cached, as the read may succeed later.
+ */
+ObjectKind TypeCache::Classify(ProcessMemory &memory, DWORD vtable) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = kinds.find(vtable);
+        if (it != kinds.end()) {
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+    misses.fetch_add(1, std::memory_order_relaxed);
+    int function;
+    if (!memory.Read(vtable, &function, sizeof(function))) {
+        return ObjectKind::Unknown;
+    }
+    int signature;
+    if (!memory.Read(function + 0x4, &signature, sizeof(signature))) {
+        return ObjectKind::Unknown;
+    }
+    ObjectKind kind = ObjectKind::Unknown;
+    if (signature == SIMPLE_ITEM_SIGNATURE) {
+        kind = ObjectKind::Simple;
+    } else if (signature == COMPLEX_ITEM_SIGNATURE) {
+        kind = ObjectKind::Complex;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (kind != ObjectKind::Unknown) {
+        kinds[vtable] = kind;
+    } else if (unknownEntries < MAX_UNKNOWN_ENTRIES && kinds.emplace(vtable, kind).second) {
+        // Stale objects can hold arbitrary values, so only a bounded number of unknown vtables are remembered.
+        unknownEntries++;
+    }
+    return kind;
+}
+
+/**
+ * Classifies the object at an address by reading its header.
+ * @param memory The memory of the game process.
+ * @param address The address of the object.
+ * @return The kind of the object.
+ */
+ObjectKind TypeCache::ClassifyObject(ProcessMemory &memory, DWORD address) {
+    DWORD vtable;
+    if (!memory.Read(address, &vtable, sizeof(vtable))) {
+        return ObjectKind::Unknown;
+    }
+    return Classify(memory, vtable);
+}
+
+/**
+ * Forgets all classified vtables.
+ */
+void TypeCache::Invalidate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    kinds.clear();
+    unknownEntries = 0;
+}
+
+/**
+ * Returns the number of lookups that were served from the cache.
+ * @return The number of hits.
+ */
+uint64_t TypeCache::GetHits() {
+    return hits.load(std::memory_order_relaxed);
+}
+
+/**
+ * Returns the number of lookups that had to read the game's memory.
+ * @return The number of misses.
+ */
+uint64_t TypeCache::GetMisses() {
+    return misses.load(std::memory_order_relaxed);
+}
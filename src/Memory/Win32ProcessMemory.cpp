@@ -0,0 +1,19 @@
+#include <windows.h>
+#include <ProcessMemory.h>
+#include <Utils.h>
+
+/**
+ * Returns the handle to the process.
+ * @return The handle to the process.
+ */
+HANDLE Win32ProcessMemory::GetHandle() {
+    return processHandle;
+}
+
+bool Win32ProcessMemory::ReadImpl(DWORD address, LPVOID buffer, SIZE_T size) {
+    return Utils::ReadMemoryToBuffer(processHandle, address, buffer, size);
+}
+
+bool Win32ProcessMemory::WriteImpl(DWORD address, LPCVOID buffer, SIZE_T size) {
+    return Utils::WriteBufferToProcessMemory(processHandle, address, buffer, size);
+}
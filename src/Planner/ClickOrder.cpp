@@ -0,0 +1,214 @@
+#include <ClickOrder.h>
+#include <cmath>
+#include <limits>
+
+/**
+ * Chooses the order to click the targets in.
+ * Only targets that can be reached within the stacking layers are sequenced: a missing base blocks every filling and
+ * top, and a missing base or filling blocks the tops.
+ * @param targets The targets, in recipe order.
+ * @param count The number of targets.
+ * @param cursorX The x coordinate of the cursor, in game units.
+ * @param cursorY The y coordinate of the cursor, in game units.
+ * @param sequence (out) The indices of the targets to click, in click order. Must have room for @p count entries.
+ * @return The number of targets in @p sequence. 0 if no target can be clicked yet.
+ */
+int ClickOrder::Plan(const ClickTarget *targets, int count, float cursorX, float cursorY, int *sequence) {
+    if (count > MAX_TARGETS) {
+        count = MAX_TARGETS;
+    }
+    // The targets that can be clicked eventually, in recipe order
+    int clickable[MAX_TARGETS];
+    int numClickable = 0;
+    uint32_t reached = 0;
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (int i = 0; i < count; i++) {
+            if (targets[i].available && !(reached & (1u << i)) && IsAllowed(targets, count, reached, i)) {
+                reached |= 1u << i;
+                progress = true;
+            }
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        if (reached & (1u << i)) {
+            clickable[numClickable++] = i;
+        }
+    }
+    if (numClickable == 0) {
+        return 0;
+    }
+    if (numClickable > MAX_EXACT) {
+        return PlanGreedy(targets, count, cursorX, cursorY, sequence);
+    }
+
+    // Best cost of clicking a subset of the clickable targets, ending with a given one
+    int numSubsets = 1 << numClickable;
+    states.resize(numSubsets * MAX_EXACT);
+    const ClickCost unreachable = {std::numeric_limits<int>::max(), 0, 0.0f};
+    for (State &state: states) {
+        state.cost = unreachable;
+    }
+    for (int subset = 0; subset < numSubsets; subset++) {
+        // The same subset as a mask over all targets, for the layer check
+        uint32_t clicked = 0;
+        for (int j = 0; j < numClickable; j++) {
+            if (subset & (1 << j)) {
+                clicked |= 1u << clickable[j];
+            }
+        }
+        for (int last = -1; last < numClickable; last++) {
+            float x = cursorX;
+            float y = cursorY;
+            ClickCost cost = {0, 0, 0.0f};
+            if (last == -1) {
+                if (subset != 0) {
+                    continue;
+                }
+            } else {
+                const State &state = states[subset * MAX_EXACT + last];
+                if (!(subset & (1 << last)) || state.cost.lost == unreachable.lost) {
+                    continue;
+                }
+                x = state.x;
+                y = state.y;
+                cost = state.cost;
+            }
+            for (int next = 0; next < numClickable; next++) {
+                if ((subset & (1 << next)) || !IsAllowed(targets, count, clicked, clickable[next])) {
+                    continue;
+                }
+                float nextX = x;
+                float nextY = y;
+                ClickCost nextCost = cost;
+                Step(targets[clickable[next]], nextX, nextY, nextCost);
+                State &nextState = states[(subset | (1 << next)) * MAX_EXACT + next];
+                if (nextCost < nextState.cost) {
+                    nextState = {nextCost, nextX, nextY, last};
+                }
+            }
+        }
+    }
+    int full = numSubsets - 1;
+    int best = 0;
+    for (int last = 1; last < numClickable; last++) {
+        if (states[full * MAX_EXACT + last].cost < states[full * MAX_EXACT + best].cost) {
+            best = last;
+        }
+    }
+    int subset = full;
+    for (int position = numClickable - 1; position >= 0; position--) {
+        sequence[position] = clickable[best];
+        int previous = states[subset * MAX_EXACT + best].previous;
+        subset &= ~(1 << best);
+        best = previous;
+    }
+    return numClickable;
+}
+
+/**
+ * Estimates the outcome of clicking targets in the given order.
+ * @param targets The targets.
+ * @param sequence The indices of the targets to click, in click order.
+ * @param length The number of entries in @p sequence.
+ * @param cursorX The x coordinate of the cursor, in game units.
+ * @param cursorY The y coordinate of the cursor, in game units.
+ * @return The cost.
+ */
+ClickCost ClickOrder::Evaluate(const ClickTarget *targets, const int *sequence, int length, float cursorX,
+                               float cursorY) {
+    ClickCost cost = {0, 0, 0.0f};
+    for (int i = 0; i < length; i++) {
+        Step(targets[sequence[i]], cursorX, cursorY, cost);
+    }
+    return cost;
+}
+
+/**
+ * Sequences the targets the way the planner used to: the first available target in recipe order, each time.
+ * @param targets The targets, in recipe order.
+ * @param count The number of targets.
+ * @param sequence (out) The indices of the available targets. Must have room for @p count entries.
+ * @return The number of targets in @p sequence.
+ */
+int ClickOrder::RecipeOrder(const ClickTarget *targets, int count, int *sequence) {
+    int length = 0;
+    for (int i = 0; i < count; i++) {
+        if (targets[i].available) {
+            sequence[length++] = i;
+        }
+    }
+    return length;
+}
+
+/**
+ * Checks whether a target may be clicked after the given targets.
+ * @param targets The targets.
+ * @param count The number of targets.
+ * @param clicked The targets clicked so far, as a bit mask over the target indices.
+ * @param next The target to click.
+ * @return Whether every target of a lower layer has been clicked.
+ */
+bool ClickOrder::IsAllowed(const ClickTarget *targets, int count, uint32_t clicked, int next) {
+    StackingLayer layer = targets[next].layer;
+    for (int i = 0; i < count; i++) {
+        if (i != next && !(clicked & (1u << i)) && targets[i].layer < layer) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @internal
+ * Moves the cursor to a target and clicks it, advancing the time and adding the travel.
+ */
+void ClickOrder::Step(const ClickTarget &target, float &x, float &y, ClickCost &cost) {
+    double t = (double) cost.nanos;
+    float targetX = (float) (target.x + target.vx * t);
+    float targetY = (float) (target.y + target.vy * t);
+    float distance = std::hypot(targetX - x, targetY - y);
+    t += distance / CURSOR_SPEED;
+    // Aim at where the item is when the cursor gets there
+    x = (float) (target.x + target.vx * t);
+    y = (float) (target.y + target.vy * t);
+    if (x < 0.0f || x > SCREEN_WIDTH || y < 0.0f || y > SCREEN_HEIGHT) {
+        cost.lost++;
+    }
+    cost.travel += distance;
+    cost.nanos = (int64_t) t + CLICK_NANOS;
+}
+
+/**
+ * @internal
+ * Sequences long orders by always clicking the allowed target that is quickest to reach.
+ */
+int ClickOrder::PlanGreedy(const ClickTarget *targets, int count, float cursorX, float cursorY, int *sequence) {
+    uint32_t clicked = 0;
+    int length = 0;
+    ClickCost cost = {0, 0, 0.0f};
+    while (true) {
+        int best = -1;
+        ClickCost bestCost = cost;
+        for (int i = 0; i < count; i++) {
+            if (!targets[i].available || (clicked & (1u << i)) || !IsAllowed(targets, count, clicked, i)) {
+                continue;
+            }
+            float x = cursorX;
+            float y = cursorY;
+            ClickCost nextCost = cost;
+            Step(targets[i], x, y, nextCost);
+            if (best == -1 || nextCost < bestCost) {
+                best = i;
+                bestCost = nextCost;
+            }
+        }
+        if (best == -1) {
+            return length;
+        }
+        Step(targets[best], cursorX, cursorY, cost);
+        clicked |= 1u << best;
+        sequence[length++] = best;
+    }
+}
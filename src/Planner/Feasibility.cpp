@@ -0,0 +1,93 @@
+#include <Feasibility.h>
+#include <Managers.h>
+
+/**
+ * Counts the ingredients on the conveyor.
+ * @param conveyor The conveyor items.
+ * @param available (out) The number of simple items per ingredient id.
+ * @note Complex items are not counted, since they cannot be used as ingredients.
+ */
+void Feasibility::CountConveyor(const ConveyorTable &conveyor, IngredientCounts &available) {
+    available.Clear();
+    for (size_t i = 0; i < conveyor.Size(); i++) {
+        if (conveyor.kind[i] == ObjectKind::Simple) {
+            available.Add(conveyor.ingredientId[i]);
+        }
+    }
+    // Ids outside the dense range cannot match any requirement, so they are not an error here
+    available.overflow = false;
+}
+
+/**
+ * Collects the ingredients of an order that have to be placed, respecting the ingredient limits.
+ * @param world The world snapshot.
+ * @param order The order.
+ * @param ingredients (out) The ingredient ids, in recipe order.
+ */
+void Feasibility::CollectIngredients(const WorldSnapshot &world, const OrderEntry &order,
+                                     std::vector<int> &ingredients) {
+    ingredients.clear();
+    for (int i = 0; i < order.ingredientCount; i++) {
+        int ingredientId = world.ingredients[order.firstIngredient + i];
+        int limit = ItemManager::IngredientLimit(ingredientId);
+        if (limit != -1) {
+            int numIngredients = 0;
+            for (int ingredient: ingredients) {
+                if (ingredient == ingredientId) {
+                    numIngredients++;
+                }
+            }
+            if (numIngredients < limit) {
+                ingredients.push_back(ingredientId);
+            }
+        } else {
+            ingredients.push_back(ingredientId);
+        }
+    }
+}
+
+/**
+ * Compiles a list of ingredients into a count vector.
+ * @param ingredients The ingredient ids.
+ * @param required (out) The number of each ingredient.
+ */
+void Feasibility::CountIngredients(const std::vector<int> &ingredients, IngredientCounts &required) {
+    required.Clear();
+    for (int ingredient: ingredients) {
+        required.Add(ingredient);
+    }
+}
+
+/**
+ * Checks whether every required ingredient is available.
+ * @param available The available ingredients.
+ * @param required The required ingredients.
+ * @return Whether the order can be built.
+ */
+bool Feasibility::IsFeasible(const IngredientCounts &available, const IngredientCounts &required) {
+    if (required.overflow) {
+        return false;
+    }
+    for (int i = 0; i < IngredientCounts::MAX_INGREDIENTS; i++) {
+        if (available.counts[i] < required.counts[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Counts the required ingredients that are not available.
+ * @param available The available ingredients.
+ * @param required The required ingredients.
+ * @return The number of missing ingredients. Ingredients outside the dense id range are counted once.
+ */
+int Feasibility::CountMissing(const IngredientCounts &available, const IngredientCounts &required) {
+    int missing = required.overflow ? 1 : 0;
+    for (int i = 0; i < IngredientCounts::MAX_INGREDIENTS; i++) {
+        if (available.counts[i] < required.counts[i]) {
+            missing += required.counts[i] - available.counts[i];
+        }
+    }
+    return missing;
+}
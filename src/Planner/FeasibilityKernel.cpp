@@ -0,0 +1,177 @@
+#include <Feasibility.h>
+
+/*
+ * Checks every pending order against the conveyor histogram in one pass. Each order is a 256-byte row of required
+ * counts; the number of missing ingredients is the sum over the row of max(0, required - available), which maps
+ * directly onto saturating byte subtraction followed by a horizontal byte sum (PSADBW against zero).
+ *
+ * The SIMD kernels are compiled with per-function target attributes and selected at run time, so the build does not
+ * need -msse2 or -mavx2 (the 32-bit build does not enable SSE2 by default).
+ */
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define BS3BOT_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+/**
+ * @internal
+ * Checks the orders one byte at a time.
+ */
+static int CheckScalar(const IngredientCounts &available, const IngredientCounts *required, size_t numOrders,
+                       int *missing) {
+    int numFeasible = 0;
+    for (size_t order = 0; order < numOrders; order++) {
+        missing[order] = Feasibility::CountMissing(available, required[order]);
+        numFeasible += missing[order] == 0;
+    }
+    return numFeasible;
+}
+
+#ifdef BS3BOT_X86_KERNELS
+
+/**
+ * @internal
+ * Checks the orders 16 ingredient ids at a time.
+ */
+__attribute__((target("sse2")))
+static int CheckSSE2(const IngredientCounts &available, const IngredientCounts *required, size_t numOrders,
+                     int *missing) {
+    const int numChunks = IngredientCounts::MAX_INGREDIENTS / 16;
+    // The conveyor row is shared by every order, so it stays in registers
+    __m128i availableChunks[numChunks];
+    for (int i = 0; i < numChunks; i++) {
+        availableChunks[i] = _mm_load_si128(reinterpret_cast<const __m128i *>(available.counts) + i);
+    }
+    const __m128i zero = _mm_setzero_si128();
+    int numFeasible = 0;
+    for (size_t order = 0; order < numOrders; order++) {
+        const __m128i *row = reinterpret_cast<const __m128i *>(required[order].counts);
+        __m128i sum = zero;
+        for (int i = 0; i < numChunks; i++) {
+            __m128i shortfall = _mm_subs_epu8(_mm_load_si128(row + i), availableChunks[i]);
+            sum = _mm_add_epi64(sum, _mm_sad_epu8(shortfall, zero));
+        }
+        int total = _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum, sum));
+        missing[order] = total + (required[order].overflow ? 1 : 0);
+        numFeasible += missing[order] == 0;
+    }
+    return numFeasible;
+}
+
+/**
+ * @internal
+ * Checks the orders 32 ingredient ids at a time.
+ */
+__attribute__((target("avx2")))
+static int CheckAVX2(const IngredientCounts &available, const IngredientCounts *required, size_t numOrders,
+                     int *missing) {
+    const int numChunks = IngredientCounts::MAX_INGREDIENTS / 32;
+    __m256i availableChunks[numChunks];
+    for (int i = 0; i < numChunks; i++) {
+        availableChunks[i] = _mm256_load_si256(reinterpret_cast<const __m256i *>(available.counts) + i);
+    }
+    const __m256i zero = _mm256_setzero_si256();
+    int numFeasible = 0;
+    for (size_t order = 0; order < numOrders; order++) {
+        const __m256i *row = reinterpret_cast<const __m256i *>(required[order].counts);
+        __m256i sum = zero;
+        for (int i = 0; i < numChunks; i++) {
+            __m256i shortfall = _mm256_subs_epu8(_mm256_load_si256(row + i), availableChunks[i]);
+            sum = _mm256_add_epi64(sum, _mm256_sad_epu8(shortfall, zero));
+        }
+        __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        int total = _mm_cvtsi128_si32(half) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(half, half));
+        missing[order] = total + (required[order].overflow ? 1 : 0);
+        numFeasible += missing[order] == 0;
+    }
+    return numFeasible;
+}
+
+#endif
+
+/**
+ * Checks all orders against the available ingredients with the fastest supported kernel.
+ * @param available The available ingredients.
+ * @param required The required ingredients of each order.
+ * @param missing (out) The number of missing ingredients of each order. An order is feasible if this is 0.
+ * @return The number of feasible orders.
+ */
+int Feasibility::CheckAll(const IngredientCounts &available, const std::vector<IngredientCounts> &required,
+                          std::vector<int> &missing) {
+    static const FeasibilityKernel kernel = GetBestKernel();
+    missing.resize(required.size());
+    return CheckAll(kernel, available, required.data(), required.size(), missing.data());
+}
+
+/**
+ * Checks all orders against the available ingredients with the given kernel.
+ * @param kernel The kernel. Falls back to the scalar kernel if it is not supported.
+ * @param available The available ingredients.
+ * @param required The required ingredients of each order.
+ * @param numOrders The number of orders.
+ * @param missing (out) The number of missing ingredients of each order. Must have room for @p numOrders entries.
+ * @return The number of feasible orders.
+ */
+int Feasibility::CheckAll(FeasibilityKernel kernel, const IngredientCounts &available,
+                          const IngredientCounts *required, size_t numOrders, int *missing) {
+#ifdef BS3BOT_X86_KERNELS
+    if (kernel == FeasibilityKernel::AVX2 && IsSupported(FeasibilityKernel::AVX2)) {
+        return CheckAVX2(available, required, numOrders, missing);
+    }
+    if (kernel == FeasibilityKernel::SSE2 && IsSupported(FeasibilityKernel::SSE2)) {
+        return CheckSSE2(available, required, numOrders, missing);
+    }
+#endif
+    return CheckScalar(available, required, numOrders, missing);
+}
+
+/**
+ * Checks whether a kernel can run on this CPU.
+ * @param kernel The kernel.
+ * @return Whether the kernel is supported.
+ */
+bool Feasibility::IsSupported(FeasibilityKernel kernel) {
+    switch (kernel) {
+        case FeasibilityKernel::Scalar:
+            return true;
+#ifdef BS3BOT_X86_KERNELS
+        case FeasibilityKernel::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case FeasibilityKernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+/**
+ * Returns the fastest kernel this CPU supports.
+ * @return The kernel.
+ */
+FeasibilityKernel Feasibility::GetBestKernel() {
+    if (IsSupported(FeasibilityKernel::AVX2)) {
+        return FeasibilityKernel::AVX2;
+    }
+    if (IsSupported(FeasibilityKernel::SSE2)) {
+        return FeasibilityKernel::SSE2;
+    }
+    return FeasibilityKernel::Scalar;
+}
+
+/**
+ * Returns the name of a kernel.
+ * @param kernel The kernel.
+ * @return The name.
+ */
+const char *Feasibility::GetKernelName(FeasibilityKernel kernel) {
+    switch (kernel) {
+        case FeasibilityKernel::SSE2:
+            return "SSE2";
+        case FeasibilityKernel::AVX2:
+            return "AVX2";
+        default:
+            return "Scalar";
+    }
+}
@@ -0,0 +1,28 @@
+#include <IngredientCounts.h>
+#include <cstring>
+
+IngredientCounts::IngredientCounts() {
+    Clear();
+}
+
+/**
+ * Resets all counts to zero.
+ */
+void IngredientCounts::Clear() {
+    memset(counts, 0, sizeof(counts));
+    overflow = false;
+}
+
+/**
+ * Counts one more of an ingredient. Counts saturate at 255.
+ * @param ingredientId The ingredient id.
+ */
+void IngredientCounts::Add(int ingredientId) {
+    if (ingredientId < 0 || ingredientId >= MAX_INGREDIENTS) {
+        overflow = true;
+        return;
+    }
+    if (counts[ingredientId] != UINT8_MAX) {
+        counts[ingredientId]++;
+    }
+}
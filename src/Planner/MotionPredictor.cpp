@@ -0,0 +1,159 @@
+#include <MotionPredictor.h>
+#include <cmath>
+
+/**
+ * Adds the positions of a conveyor snapshot to the item models. Items that are no longer on the conveyor are
+ * forgotten. Updating twice with the same snapshot does nothing.
+ * @param conveyor The conveyor items.
+ * @param timeNanos The time the snapshot was captured.
+ */
+void MotionPredictor::Update(const ConveyorTable &conveyor, int64_t timeNanos) {
+    if (timeNanos == lastUpdateNanos) {
+        return;
+    }
+    lastUpdateNanos = timeNanos;
+    for (size_t i = 0; i < conveyor.Size(); i++) {
+        auto inserted = tracks.emplace(conveyor.address[i], Track());
+        Track &track = inserted.first->second;
+        if (!inserted.second) {
+            if (track.lastSeenNanos == timeNanos) {
+                continue;
+            }
+            float x, y;
+            Evaluate(track, timeNanos, x, y);
+            if (std::fabs(conveyor.x[i] - x) > JUMP_DISTANCE || std::fabs(conveyor.y[i] - y) > JUMP_DISTANCE) {
+                inserted.second = true;
+            }
+        }
+        if (inserted.second) {
+            track.count = 0;
+            track.next = 0;
+        }
+        track.samples[track.next] = {timeNanos, conveyor.x[i], conveyor.y[i]};
+        track.next = (track.next + 1) % MAX_SAMPLES;
+        if (track.count < MAX_SAMPLES) {
+            track.count++;
+        }
+        track.lastSeenNanos = timeNanos;
+        Fit(track);
+    }
+    for (auto it = tracks.begin(); it != tracks.end();) {
+        if (it->second.lastSeenNanos != timeNanos) {
+            it = tracks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * Predicts the position of a conveyor item.
+ * @param address The address of the item.
+ * @param timeNanos The time to predict the position for.
+ * @param x (out) The predicted x coordinate.
+ * @param y (out) The predicted y coordinate.
+ * @return Whether the item is known. If not, @p x and @p y are not modified.
+ */
+bool MotionPredictor::Predict(DWORD address, int64_t timeNanos, float &x, float &y) const {
+    auto it = tracks.find(address);
+    if (it == tracks.end()) {
+        return false;
+    }
+    Evaluate(it->second, timeNanos, x, y);
+    return true;
+}
+
+/**
+ * Returns the fitted velocity of a conveyor item.
+ * @param address The address of the item.
+ * @param vx (out) The velocity along x, in game units per second.
+ * @param vy (out) The velocity along y, in game units per second.
+ * @return Whether the item is known.
+ */
+bool MotionPredictor::GetVelocity(DWORD address, float &vx, float &vy) const {
+    auto it = tracks.find(address);
+    if (it == tracks.end()) {
+        return false;
+    }
+    vx = it->second.vx * 1e9f;
+    vy = it->second.vy * 1e9f;
+    return true;
+}
+
+/**
+ * Records how long it took from deciding on a click until the click was sent.
+ * @param nanos The latency in nanoseconds.
+ */
+void MotionPredictor::RecordLatency(int64_t nanos) {
+    latencyNanos = measuredLatency ? (7 * latencyNanos + nanos) / 8 : nanos;
+    measuredLatency = true;
+}
+
+/**
+ * Returns the expected input latency.
+ * @return The latency in nanoseconds.
+ */
+int64_t MotionPredictor::GetLatencyNanos() const {
+    return latencyNanos;
+}
+
+/**
+ * Forgets all items, e.g. when a new level starts. The measured latency is kept.
+ */
+void MotionPredictor::Clear() {
+    tracks.clear();
+    lastUpdateNanos = 0;
+}
+
+/**
+ * @internal
+ * Fits a line through the samples of a track, per coordinate, with time relative to the newest sample.
+ */
+void MotionPredictor::Fit(Track &track) {
+    const Sample &newest = track.samples[(track.next + MAX_SAMPLES - 1) % MAX_SAMPLES];
+    if (track.count < 2) {
+        track.x = newest.x;
+        track.y = newest.y;
+        track.vx = 0.0f;
+        track.vy = 0.0f;
+        return;
+    }
+    // Times are in the order of 100 ms, so doubles keep the sums exact enough
+    double sumT = 0, sumTT = 0, sumX = 0, sumY = 0, sumTX = 0, sumTY = 0;
+    for (int i = 0; i < track.count; i++) {
+        const Sample &sample = track.samples[i];
+        double t = (double) (sample.timeNanos - newest.timeNanos);
+        sumT += t;
+        sumTT += t * t;
+        sumX += sample.x;
+        sumY += sample.y;
+        sumTX += t * sample.x;
+        sumTY += t * sample.y;
+    }
+    double n = track.count;
+    double denominator = n * sumTT - sumT * sumT;
+    if (denominator <= 0) {
+        track.x = newest.x;
+        track.y = newest.y;
+        track.vx = 0.0f;
+        track.vy = 0.0f;
+        return;
+    }
+    double vx = (n * sumTX - sumT * sumX) / denominator;
+    double vy = (n * sumTY - sumT * sumY) / denominator;
+    track.vx = (float) vx;
+    track.vy = (float) vy;
+    track.x = (float) ((sumX - vx * sumT) / n);
+    track.y = (float) ((sumY - vy * sumT) / n);
+}
+
+/**
+ * @internal
+ * Evaluates the fitted line of a track at a time.
+ */
+void MotionPredictor::Evaluate(const Track &track, int64_t timeNanos, float &x, float &y) {
+    const Sample &newest = track.samples[(track.next + MAX_SAMPLES - 1) % MAX_SAMPLES];
+    double t = (double) (timeNanos - newest.timeNanos);
+    x = (float) (track.x + track.vx * t);
+    y = (float) (track.y + track.vy * t);
+}
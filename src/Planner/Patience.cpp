@@ -0,0 +1,103 @@
+#include <Patience.h>
+#include <algorithm>
+
+/**
+ * Matches the customers of a new snapshot with the ones seen before and sets their arrival and deadline.
+ * Customers that are gone count as served if all of their orders were complete when they were last seen, and as lost
+ * otherwise; every lost customer refines the patience estimate.
+ * @param frame The frame of the snapshot.
+ * @param customers The customers of the snapshot. Their arrival and deadline frames are set.
+ * @param orders The orders of the snapshot.
+ */
+void PatienceTracker::Observe(uint64_t frame, std::vector<CustomerEntry> &customers,
+                              const std::vector<OrderEntry> &orders) {
+    for (CustomerEntry &entry: customers) {
+        TrackedCustomer *customer = nullptr;
+        for (TrackedCustomer &candidate: tracked) {
+            // Ids increase with every customer, so a new customer in a reused slot is told apart by its id
+            if (candidate.address == entry.address && candidate.id == entry.id) {
+                customer = &candidate;
+                break;
+            }
+        }
+        if (customer == nullptr) {
+            tracked.push_back({entry.address, entry.id, frame, frame, started, false});
+            customer = &tracked.back();
+        }
+        bool complete = true;
+        for (int i = entry.firstOrder; i < entry.firstOrder + entry.orderCount; i++) {
+            const ItemInfo &info = orders[i].info;
+            complete &= info.mNumCopies == info.mNumComplete || info.mRobotComplete;
+        }
+        customer->lastSeenFrame = frame;
+        customer->complete = complete;
+        entry.arrivalFrame = customer->arrivalFrame;
+        // A customer still waiting past the estimate is more patient than most; it stays schedulable for a while
+        // rather than being given up on while it is still there
+        entry.deadlineFrame = std::max(customer->arrivalFrame + patienceFrames, frame + patienceFrames / 8);
+    }
+    for (size_t i = 0; i < tracked.size();) {
+        TrackedCustomer &customer = tracked[i];
+        if (customer.lastSeenFrame == frame) {
+            i++;
+            continue;
+        }
+        if (customer.complete) {
+            servedCount++;
+        } else {
+            lostCount++;
+            if (customer.arrivalKnown) {
+                uint64_t waited = customer.lastSeenFrame - customer.arrivalFrame;
+                patienceFrames = learned ? (3 * patienceFrames + waited) / 4 : waited;
+                learned = true;
+            }
+        }
+        customer = tracked.back();
+        tracked.pop_back();
+    }
+    started = true;
+}
+
+/**
+ * Returns the estimated patience of a customer.
+ * @return The number of frames a customer waits before leaving.
+ */
+uint64_t PatienceTracker::GetPatienceFrames() const {
+    return patienceFrames;
+}
+
+/**
+ * Returns whether the patience was learned from a lost customer, rather than assumed.
+ * @return Whether the patience was learned.
+ */
+bool PatienceTracker::HasLearned() const {
+    return learned;
+}
+
+/**
+ * Returns the number of customers that left with all of their orders complete.
+ * @return The number of customers.
+ */
+uint64_t PatienceTracker::GetServedCount() const {
+    return servedCount;
+}
+
+/**
+ * Returns the number of customers that left with incomplete orders.
+ * @return The number of customers.
+ */
+uint64_t PatienceTracker::GetLostCount() const {
+    return lostCount;
+}
+
+/**
+ * Forgets all customers and the learned patience, e.g. when a new level starts.
+ */
+void PatienceTracker::Reset() {
+    tracked.clear();
+    patienceFrames = DEFAULT_PATIENCE_FRAMES;
+    learned = false;
+    started = false;
+    servedCount = 0;
+    lostCount = 0;
+}
@@ -0,0 +1,376 @@
+#include <Scheduler.h>
+#include <Feasibility.h>
+#include <ChangeSignal.h>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+/**
+ * @internal
+ * Returns the current steady clock time in nanoseconds.
+ */
+static int64_t NowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @internal
+ * Removes the ingredients of an order from the available ingredients. The order must be feasible.
+ */
+static void Subtract(IngredientCounts &available, const IngredientCounts &required) {
+    for (int i = 0; i < IngredientCounts::MAX_INGREDIENTS; i++) {
+        available.counts[i] -= required.counts[i];
+    }
+}
+
+/**
+ * @internal
+ * Returns the ingredients of an order to the available ingredients.
+ */
+static void Add(IngredientCounts &available, const IngredientCounts &required) {
+    for (int i = 0; i < IngredientCounts::MAX_INGREDIENTS; i++) {
+        available.counts[i] += required.counts[i];
+    }
+}
+
+/**
+ * Re-plans if anything changed since the last plan.
+ * @param world The world snapshot.
+ * @param committed The order the planner is building, or @c nullptr if it is not building one.
+ * @param committedIngredients The ingredients the committed order still needs, in click order.
+ * @return @c true if a new plan was made, @c false if the previous plan still applies.
+ */
+bool OrderScheduler::Update(const WorldSnapshot &world, const OrderKey *committed,
+                            const std::vector<int> &committedIngredients) {
+    OrderKey committedKey = committed != nullptr ? *committed : OrderKey();
+    if (hasPlan && plan.version == world.version && committedKey == lastCommitted &&
+        committedIngredients == lastCommittedIngredients) {
+        reuseCount++;
+        return false;
+    }
+    int64_t start = NowNanos();
+
+    // Keep what the previous plan decided, so a re-plan after a small change repairs it instead of starting over
+    previousOrders.clear();
+    for (const ScheduledOrder &order: plan.orders) {
+        previousOrders.push_back(order.key);
+    }
+    previousItems.clear();
+    if (!plan.orders.empty() && plan.orders[0].key == committedKey && committed != nullptr) {
+        const ScheduledOrder &order = plan.orders[0];
+        previousItems.assign(plan.items.begin() + order.firstItem,
+                             plan.items.begin() + order.firstItem + order.itemCount);
+    }
+
+    IndexConveyor(world);
+    available = world.conveyorCounts;
+    plan.version = world.version;
+    plan.orders.clear();
+    plan.items.clear();
+    plan.ingredients.clear();
+
+    // The committed order goes first and keeps its items where possible
+    if (committed != nullptr) {
+        int index = -1;
+        for (size_t i = 0; i < world.orders.size(); i++) {
+            if (GetKey(world.orders[i]) == committedKey) {
+                index = i;
+                break;
+            }
+        }
+        plan.orders.push_back({index, committedKey, 0, (int) committedIngredients.size()});
+        for (int ingredient: committedIngredients) {
+            DWORD item = Reserve(world, ingredient, previousItems);
+            if (item != 0 && ingredient >= 0 && ingredient < IngredientCounts::MAX_INGREDIENTS) {
+                available.counts[ingredient]--;
+            }
+            plan.items.push_back(item);
+            plan.ingredients.push_back(ingredient);
+        }
+    }
+
+    // Orders share the deadline of their customer; orders without a customer entry have none
+    orderDeadlines.assign(world.orders.size(), std::numeric_limits<uint64_t>::max());
+    for (const CustomerEntry &customer: world.customers) {
+        for (int i = customer.firstOrder; i < customer.firstOrder + customer.orderCount; i++) {
+            orderDeadlines[i] = customer.deadlineFrame;
+        }
+    }
+
+    // Every other pending order is a candidate
+    candidates.clear();
+    candidateIngredients.clear();
+    for (size_t i = 0; i < world.orders.size(); i++) {
+        const OrderEntry &order = world.orders[i];
+        if (order.info.mNumCopies == order.info.mNumComplete || order.info.mRobotComplete) {
+            continue;
+        }
+        if (committed != nullptr && GetKey(order) == committedKey) {
+            continue;
+        }
+        if (world.requirements[i].overflow) {
+            continue;
+        }
+        Feasibility::CollectIngredients(world, order, ingredientBuffer);
+        candidates.push_back({(int) i, (int) candidateIngredients.size(), (int) ingredientBuffer.size(),
+                              orderDeadlines[i]});
+        candidateIngredients.insert(candidateIngredients.end(), ingredientBuffer.begin(), ingredientBuffer.end());
+    }
+    // Earliest deadline first, then previously scheduled orders in their previous sequence, then the shortest orders
+    auto previousRank = [this, &world](const Candidate &candidate) {
+        OrderKey key = GetKey(world.orders[candidate.order]);
+        auto it = std::find(previousOrders.begin(), previousOrders.end(), key);
+        return it != previousOrders.end() ? (int) (it - previousOrders.begin()) : (int) previousOrders.size();
+    };
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [&previousRank](const Candidate &a, const Candidate &b) {
+                         if (a.deadline != b.deadline) {
+                             return a.deadline < b.deadline;
+                         }
+                         int rankA = previousRank(a);
+                         int rankB = previousRank(b);
+                         if (rankA != rankB) {
+                             return rankA < rankB;
+                         }
+                         return a.ingredientCount < b.ingredientCount;
+                     });
+
+    // The budget runs on the bot's clock, which stands still while a simulated or replayed game plans, so that those
+    // plan the same every time
+    Assign(world, ChangeSignal::NowNanos() + BUDGET_NANOS);
+    uint64_t startFrame = world.frame;
+    if (committed != nullptr) {
+        startFrame += GetBuildFrames(committedIngredients.size());
+    }
+    Materialize(world, startFrame);
+
+    lastCommitted = committedKey;
+    lastCommittedIngredients = committedIngredients;
+    hasPlan = true;
+    planCount++;
+    lastPlanNanos = NowNanos() - start;
+    return true;
+}
+
+/**
+ * Returns the current plan.
+ * @return The plan.
+ */
+const SchedulePlan &OrderScheduler::GetPlan() const {
+    return plan;
+}
+
+/**
+ * Returns the key of an order.
+ * @param order The order.
+ * @return The key.
+ */
+OrderKey OrderScheduler::GetKey(const OrderEntry &order) {
+    OrderKey key;
+    key.customer = order.customer;
+    key.item = order.info.mItem;
+    return key;
+}
+
+/**
+ * Estimates how long the planner takes to build an order.
+ * @param ingredientCount The number of ingredients still to click.
+ * @return The number of frames until the order is delivered.
+ */
+uint64_t OrderScheduler::GetBuildFrames(int ingredientCount) {
+    return (uint64_t) ingredientCount * FRAMES_PER_INGREDIENT + DELIVERY_FRAMES;
+}
+
+/**
+ * Returns the number of re-plans.
+ * @return The number of re-plans.
+ */
+uint64_t OrderScheduler::GetPlanCount() const {
+    return planCount;
+}
+
+/**
+ * Returns the number of updates that kept the previous plan because nothing changed.
+ * @return The number of updates.
+ */
+uint64_t OrderScheduler::GetReuseCount() const {
+    return reuseCount;
+}
+
+/**
+ * Returns the duration of the last re-plan.
+ * @return The duration in nanoseconds.
+ */
+int64_t OrderScheduler::GetLastPlanNanos() const {
+    return lastPlanNanos;
+}
+
+/**
+ * @internal
+ * Buckets the simple conveyor items by ingredient id and clears all reservations.
+ */
+void OrderScheduler::IndexConveyor(const WorldSnapshot &world) {
+    const ConveyorTable &conveyor = world.conveyor;
+    bucketStart.assign(IngredientCounts::MAX_INGREDIENTS + 1, 0);
+    for (size_t i = 0; i < conveyor.Size(); i++) {
+        int ingredient = conveyor.ingredientId[i];
+        if (conveyor.kind[i] == ObjectKind::Simple && ingredient >= 0 &&
+            ingredient < IngredientCounts::MAX_INGREDIENTS) {
+            bucketStart[ingredient + 1]++;
+        }
+    }
+    for (int i = 0; i < IngredientCounts::MAX_INGREDIENTS; i++) {
+        bucketStart[i + 1] += bucketStart[i];
+    }
+    bucketRows.resize(bucketStart[IngredientCounts::MAX_INGREDIENTS]);
+    // Fill each bucket in conveyor order, so the item that arrived first is reserved first
+    bucketFill.assign(bucketStart.begin(), bucketStart.end() - 1);
+    for (size_t i = 0; i < conveyor.Size(); i++) {
+        int ingredient = conveyor.ingredientId[i];
+        if (conveyor.kind[i] == ObjectKind::Simple && ingredient >= 0 &&
+            ingredient < IngredientCounts::MAX_INGREDIENTS) {
+            bucketRows[bucketFill[ingredient]++] = i;
+        }
+    }
+    reserved.assign(conveyor.Size(), 0);
+}
+
+/**
+ * @internal
+ * Reserves a conveyor item with the given ingredient, preferring one of the given addresses.
+ * @return The address of the item, or 0 if no unreserved item with this ingredient is on the conveyor.
+ */
+DWORD OrderScheduler::Reserve(const WorldSnapshot &world, int ingredient, const std::vector<DWORD> &preferred) {
+    if (ingredient < 0 || ingredient >= IngredientCounts::MAX_INGREDIENTS) {
+        return 0;
+    }
+    int first = bucketStart[ingredient];
+    int last = bucketStart[ingredient + 1];
+    for (DWORD address: preferred) {
+        for (int i = first; i < last; i++) {
+            int row = bucketRows[i];
+            if (!reserved[row] && world.conveyor.address[row] == address) {
+                reserved[row] = 1;
+                return address;
+            }
+        }
+    }
+    for (int i = first; i < last; i++) {
+        int row = bucketRows[i];
+        if (!reserved[row]) {
+            reserved[row] = 1;
+            return world.conveyor.address[row];
+        }
+    }
+    return 0;
+}
+
+/**
+ * @internal
+ * Chooses the orders to schedule: greedily in candidate order, then, while time is left, replacing one scheduled
+ * order with two unscheduled ones wherever the freed ingredients allow it.
+ */
+void OrderScheduler::Assign(const WorldSnapshot &world, int64_t deadline) {
+    assigned.assign(candidates.size(), 0);
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const IngredientCounts &required = world.requirements[candidates[i].order];
+        if (Feasibility::IsFeasible(available, required)) {
+            Subtract(available, required);
+            assigned[i] = 1;
+        }
+    }
+    bool improved = true;
+    while (improved && ChangeSignal::NowNanos() < deadline) {
+        improved = false;
+        for (size_t a = 0; a < candidates.size() && !improved && ChangeSignal::NowNanos() < deadline; a++) {
+            if (!assigned[a]) {
+                continue;
+            }
+            const IngredientCounts &removed = world.requirements[candidates[a].order];
+            Add(available, removed);
+            size_t first = candidates.size();
+            for (size_t u = 0; u < candidates.size() && !improved; u++) {
+                if (assigned[u] || u == a) {
+                    continue;
+                }
+                const IngredientCounts &required = world.requirements[candidates[u].order];
+                if (!Feasibility::IsFeasible(available, required)) {
+                    continue;
+                }
+                if (first == candidates.size()) {
+                    Subtract(available, required);
+                    first = u;
+                } else {
+                    Subtract(available, required);
+                    assigned[a] = 0;
+                    assigned[first] = 1;
+                    assigned[u] = 1;
+                    improved = true;
+                }
+            }
+            if (!improved) {
+                if (first != candidates.size()) {
+                    Add(available, world.requirements[candidates[first].order]);
+                }
+                Subtract(available, removed);
+            }
+        }
+    }
+}
+
+/**
+ * @internal
+ * Sequences the chosen orders earliest deadline first, drops the longest builds while an order would finish after its
+ * deadline (Moore-Hodgson), and reserves a conveyor item for each ingredient of the remaining orders.
+ */
+void OrderScheduler::Materialize(const WorldSnapshot &world, uint64_t startFrame) {
+    sequence.clear();
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (assigned[i]) {
+            sequence.push_back(i);
+        }
+    }
+    std::stable_sort(sequence.begin(), sequence.end(), [this](int a, int b) {
+        if (candidates[a].deadline != candidates[b].deadline) {
+            return candidates[a].deadline < candidates[b].deadline;
+        }
+        return candidates[a].ingredientCount < candidates[b].ingredientCount;
+    });
+    kept.clear();
+    uint64_t finishFrame = startFrame;
+    for (int i: sequence) {
+        kept.push_back(i);
+        finishFrame += GetBuildFrames(candidates[i].ingredientCount);
+        if (finishFrame > candidates[i].deadline) {
+            auto longest = std::max_element(kept.begin(), kept.end(), [this](int a, int b) {
+                return candidates[a].ingredientCount < candidates[b].ingredientCount;
+            });
+            finishFrame -= GetBuildFrames(candidates[*longest].ingredientCount);
+            kept.erase(longest);
+        }
+    }
+    // A customer leaves unless all of its orders are delivered, so the other orders of a dropped order's customer
+    // would be built for nothing
+    for (int i: sequence) {
+        if (std::find(kept.begin(), kept.end(), i) != kept.end()) {
+            continue;
+        }
+        DWORD customer = world.orders[candidates[i].order].customer;
+        kept.erase(std::remove_if(kept.begin(), kept.end(), [this, &world, customer](int k) {
+            return world.orders[candidates[k].order].customer == customer;
+        }), kept.end());
+    }
+    plan.droppedCount = sequence.size() - kept.size();
+    static const std::vector<DWORD> noPreference;
+    for (int i: kept) {
+        const Candidate &candidate = candidates[i];
+        plan.orders.push_back({candidate.order, GetKey(world.orders[candidate.order]), (int) plan.items.size(),
+                               candidate.ingredientCount});
+        for (int j = 0; j < candidate.ingredientCount; j++) {
+            int ingredient = candidateIngredients[candidate.firstIngredient + j];
+            plan.items.push_back(Reserve(world, ingredient, noPreference));
+            plan.ingredients.push_back(ingredient);
+        }
+    }
+}
@@ -0,0 +1,139 @@
+#include <Sequence.h>
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+/**
+ * Creates the sequence that owns the coroutine.
+ * @return The sequence.
+ */
+Sequence Sequence::promise_type::get_return_object() {
+    return Sequence(Handle::from_promise(*this));
+}
+
+/**
+ * Stops the bot on an exception escaping a sequence; the bot does not use exceptions, so this is a bug.
+ */
+void Sequence::promise_type::unhandled_exception() {
+    std::cout << "Error: Unhandled exception in an action sequence." << std::endl;
+    std::terminate();
+}
+
+Sequence::Sequence(Sequence &&other) noexcept: handle(other.handle) {
+    other.handle = nullptr;
+}
+
+Sequence &Sequence::operator=(Sequence &&other) noexcept {
+    if (this != &other) {
+        if (handle) {
+            handle.destroy();
+        }
+        handle = other.handle;
+        other.handle = nullptr;
+    }
+    return *this;
+}
+
+/**
+ * Destroys the coroutine, wherever it is suspended.
+ */
+Sequence::~Sequence() {
+    if (handle) {
+        handle.destroy();
+    }
+}
+
+/**
+ * Makes the sequence wait for the condition, and for at most the timeout.
+ * @param awaiting The sequence.
+ */
+void WaitUntil::await_suspend(Sequence::Handle awaiting) {
+    handle = awaiting;
+    Sequence::promise_type &promise = awaiting.promise();
+    int64_t now = promise.runner->GetNowNanos();
+    promise.condition = std::move(condition);
+    promise.deadlineNanos = timeoutNanos >= SequenceRunner::NO_DEADLINE - now ? SequenceRunner::NO_DEADLINE
+                                                                               : now + timeoutNanos;
+}
+
+/**
+ * Makes the sequence wait until the duration has passed.
+ * @param awaiting The sequence.
+ */
+void WaitFor::await_suspend(Sequence::Handle awaiting) {
+    Sequence::promise_type &promise = awaiting.promise();
+    promise.condition = nullptr;
+    promise.deadlineNanos = promise.runner->GetNowNanos() + nanos;
+}
+
+/**
+ * Adds a sequence. It starts on the next run, or on the current one when spawned by a running sequence.
+ * @param sequence The sequence.
+ * @return A flag that becomes true once the sequence has finished.
+ */
+std::shared_ptr<const bool> SequenceRunner::Spawn(Sequence sequence) {
+    Sequence::promise_type &promise = sequence.handle.promise();
+    promise.runner = this;
+    promise.deadlineNanos = 0;
+    std::shared_ptr<const bool> finished = promise.finished;
+    sequences.push_back(std::move(sequence));
+    return finished;
+}
+
+/**
+ * Resumes every sequence whose condition is true or whose deadline has passed, and removes the finished ones.
+ * @param now The current steady clock time in nanoseconds.
+ * @return The earliest deadline of the waiting sequences, or NO_DEADLINE if they only wait for conditions.
+ */
+int64_t SequenceRunner::Run(int64_t now) {
+    nowNanos = now;
+    int64_t next = NO_DEADLINE;
+    // Sequences spawned during the run are appended, and run in the same pass
+    for (size_t i = 0; i < sequences.size(); i++) {
+        Sequence::Handle handle = sequences[i].handle;
+        Sequence::promise_type &promise = handle.promise();
+        bool met = promise.condition && promise.condition();
+        if (!met && promise.deadlineNanos > now) {
+            next = std::min(next, promise.deadlineNanos);
+            continue;
+        }
+        promise.conditionMet = met;
+        promise.condition = nullptr;
+        handle.resume();
+        if (handle.done()) {
+            *promise.finished = true;
+        } else {
+            next = std::min(next, promise.deadlineNanos);
+        }
+    }
+    sequences.erase(std::remove_if(sequences.begin(), sequences.end(), [](const Sequence &sequence) {
+        return sequence.handle.done();
+    }), sequences.end());
+    return next;
+}
+
+/**
+ * Destroys every sequence, wherever it is suspended.
+ */
+void SequenceRunner::Clear() {
+    for (Sequence &sequence: sequences) {
+        *sequence.handle.promise().finished = true;
+    }
+    sequences.clear();
+}
+
+/**
+ * Returns the number of sequences in flight.
+ * @return The number of sequences.
+ */
+size_t SequenceRunner::GetActiveCount() const {
+    return sequences.size();
+}
+
+/**
+ * Returns the time of the current run, which waits are measured from.
+ * @return The steady clock time in nanoseconds.
+ */
+int64_t SequenceRunner::GetNowNanos() const {
+    return nowNanos;
+}
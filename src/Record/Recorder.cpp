@@ -0,0 +1,919 @@
+#include <Recorder.h>
+#include <World.h>
+#include <ChangeSignal.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+/*
+ * Session file layout (little-endian):
+ *   char[4]  magic "BS3R"
+ *   uint32   version (1)
+ *   uint32   record size (64)
+ *   followed by the records, in the order they were recorded
+ */
+static const char SESSION_MAGIC[4] = {'B', 'S', '3', 'R'};
+static const uint32_t SESSION_VERSION = 1;
+// The flush thread writes records to the file in batches of this many
+static const size_t BATCH_SIZE = 256;
+
+/*
+ * The kernels that find the chunks a page fetch changed are compiled with per-function target attributes and selected
+ * at run time, as the feasibility kernels are.
+ */
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define BS3BOT_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+static_assert(Recorder::CHUNK_SIZE == 32, "The kernels compare chunks of 32 bytes");
+
+// Chunks are compared in blocks of this many, so that a block that did not change is passed over with one test
+static const size_t BLOCK_CHUNKS = 8;
+
+typedef size_t (*FindChangedChunksFunction)(const BYTE *before, const BYTE *after, uint8_t *changed);
+
+std::atomic<uint32_t> Recorder::session{0};
+uint32_t Recorder::lastSession = 0;
+std::atomic<uint64_t> Recorder::ticketCount{0};
+std::unique_ptr<Recorder::Producer> Recorder::producers[Recorder::MAX_PRODUCERS];
+std::atomic<size_t> Recorder::producerCount{0};
+std::mutex Recorder::producersMutex;
+thread_local Recorder::Producer *Recorder::localProducer = nullptr;
+uint64_t Recorder::snapshotVersion = 0;
+uint32_t Recorder::snapshotSession = 0;
+std::vector<Recorder::ItemState> Recorder::items;
+std::vector<Recorder::ItemState> Recorder::nextItems;
+std::vector<Recorder::CustomerState> Recorder::customers;
+std::vector<Recorder::CustomerState> Recorder::nextCustomers;
+std::unordered_map<DWORD, std::unique_ptr<Recorder::ShadowPage>> Recorder::shadow;
+Recorder::ShadowPage *Recorder::lastPage = nullptr;
+uint64_t Recorder::lastPageBase = 0;
+uint64_t Recorder::nextTicket = 0;
+uint64_t Recorder::stalledTicket = 0;
+int64_t Recorder::lastTimeNanos = 0;
+std::vector<SessionRecord> Recorder::batch;
+std::ofstream Recorder::file;
+std::thread Recorder::thread;
+std::mutex Recorder::flushMutex;
+std::condition_variable Recorder::flushSignal;
+std::atomic<uint64_t> Recorder::comparedCount{0};
+std::atomic<uint64_t> Recorder::snapshotCount{0};
+std::atomic<uint64_t> Recorder::droppedCount{0};
+std::atomic<uint64_t> Recorder::writtenCount{0};
+
+/**
+ * @internal
+ * Returns the bits of a chunk's known word that a range covers.
+ * @param chunk The address of the chunk.
+ * @param from The start of the range.
+ * @param to The end of the range.
+ * @return The mask, one bit per byte of the chunk.
+ */
+static uint32_t ChunkMask(uint64_t chunk, uint64_t from, uint64_t to) {
+    uint64_t first = std::max(chunk, from) - chunk;
+    uint64_t last = std::min(chunk + Recorder::CHUNK_SIZE, to) - chunk;
+    uint64_t bits = last - first == Recorder::CHUNK_SIZE ? ~0ull : (1ull << (last - first)) - 1;
+    return (uint32_t) (bits << first);
+}
+
+/**
+ * @internal
+ * Finds the chunks of a page that changed, comparing blocks of chunks first.
+ * @param before The page before.
+ * @param after The page after.
+ * @param changed (out) The indices of the chunks that changed, in order.
+ * @return The number of chunks that changed.
+ */
+static size_t FindChangedChunksScalar(const BYTE *before, const BYTE *after, uint8_t *changed) {
+    const size_t blockSize = BLOCK_CHUNKS * Recorder::CHUNK_SIZE;
+    size_t count = 0;
+    for (size_t block = 0; block < Recorder::PAGE_SIZE; block += blockSize) {
+        if (std::memcmp(before + block, after + block, blockSize) == 0) {
+            continue;
+        }
+        for (size_t chunk = block; chunk < block + blockSize; chunk += Recorder::CHUNK_SIZE) {
+            if (std::memcmp(before + chunk, after + chunk, Recorder::CHUNK_SIZE) != 0) {
+                changed[count++] = (uint8_t) (chunk / Recorder::CHUNK_SIZE);
+            }
+        }
+    }
+    return count;
+}
+
+#ifdef BS3BOT_X86_KERNELS
+
+/**
+ * @internal
+ * Finds the chunks of a page that changed, one chunk in two registers.
+ */
+__attribute__((target("sse2")))
+static size_t FindChangedChunksSSE2(const BYTE *before, const BYTE *after, uint8_t *changed) {
+    const __m128i *a = reinterpret_cast<const __m128i *>(before);
+    const __m128i *b = reinterpret_cast<const __m128i *>(after);
+    size_t count = 0;
+    for (size_t block = 0; block < Recorder::PAGE_SIZE / Recorder::CHUNK_SIZE; block += BLOCK_CHUNKS) {
+        __m128i differences[BLOCK_CHUNKS];
+        __m128i any = _mm_setzero_si128();
+        for (size_t i = 0; i < BLOCK_CHUNKS; i++) {
+            size_t chunk = block + i;
+            __m128i low = _mm_xor_si128(_mm_loadu_si128(a + 2 * chunk), _mm_loadu_si128(b + 2 * chunk));
+            __m128i high = _mm_xor_si128(_mm_loadu_si128(a + 2 * chunk + 1), _mm_loadu_si128(b + 2 * chunk + 1));
+            differences[i] = _mm_or_si128(low, high);
+            any = _mm_or_si128(any, differences[i]);
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) == 0xFFFF) {
+            continue;
+        }
+        for (size_t i = 0; i < BLOCK_CHUNKS; i++) {
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(differences[i], _mm_setzero_si128())) != 0xFFFF) {
+                changed[count++] = (uint8_t) (block + i);
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @internal
+ * Finds the chunks of a page that changed, one chunk in one register.
+ */
+__attribute__((target("avx2")))
+static size_t FindChangedChunksAVX2(const BYTE *before, const BYTE *after, uint8_t *changed) {
+    const __m256i *a = reinterpret_cast<const __m256i *>(before);
+    const __m256i *b = reinterpret_cast<const __m256i *>(after);
+    size_t count = 0;
+    for (size_t block = 0; block < Recorder::PAGE_SIZE / Recorder::CHUNK_SIZE; block += BLOCK_CHUNKS) {
+        __m256i differences[BLOCK_CHUNKS];
+        __m256i any = _mm256_setzero_si256();
+        for (size_t i = 0; i < BLOCK_CHUNKS; i++) {
+            differences[i] = _mm256_xor_si256(_mm256_loadu_si256(a + block + i), _mm256_loadu_si256(b + block + i));
+            any = _mm256_or_si256(any, differences[i]);
+        }
+        if (_mm256_testz_si256(any, any)) {
+            continue;
+        }
+        for (size_t i = 0; i < BLOCK_CHUNKS; i++) {
+            if (!_mm256_testz_si256(differences[i], differences[i])) {
+                changed[count++] = (uint8_t) (block + i);
+            }
+        }
+    }
+    return count;
+}
+
+#endif
+
+/**
+ * @internal
+ * Selects the fastest kernel this CPU supports to find the chunks of a page that changed.
+ * @return The kernel.
+ */
+static FindChangedChunksFunction SelectFindChangedChunks() {
+#ifdef BS3BOT_X86_KERNELS
+    if (__builtin_cpu_supports("avx2")) {
+        return FindChangedChunksAVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return FindChangedChunksSSE2;
+    }
+#endif
+    return FindChangedChunksScalar;
+}
+
+/**
+ * Starts recording to a file, replacing it.
+ * @param filename The file to record to.
+ * @return Whether the file could be opened. Fails if a recording is already running.
+ */
+bool Recorder::Start(const std::string &filename) {
+    if (session.load() != 0) {
+        std::cout << "Error: A session is already being recorded." << std::endl;
+        return false;
+    }
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cout << "Error: Could not open " << filename << " for recording." << std::endl;
+        return false;
+    }
+    uint32_t header[2] = {SESSION_VERSION, (uint32_t) sizeof(SessionRecord)};
+    file.write(SESSION_MAGIC, sizeof(SESSION_MAGIC));
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    // The flush thread is not running yet. Entries an earlier recording left queued have its number and are skipped
+    shadow.clear();
+    lastPage = nullptr;
+    items.clear();
+    customers.clear();
+    nextTicket = 0;
+    stalledTicket = 0;
+    lastTimeNanos = ChangeSignal::NowNanos();
+    ticketCount = 0;
+    comparedCount = 0;
+    snapshotCount = 0;
+    droppedCount = 0;
+    writtenCount = 0;
+    lastSession = lastSession % 255 + 1;
+    session = lastSession;
+    thread = std::thread(FlushThread);
+    return true;
+}
+
+/**
+ * Stops recording, writing every record still queued to the file.
+ */
+void Recorder::Stop() {
+    if (session.exchange(0) == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(flushMutex);
+    }
+    flushSignal.notify_one();
+    thread.join();
+    file.close();
+}
+
+/**
+ * Returns whether a session is being recorded.
+ * @return Whether a recording is running.
+ */
+bool Recorder::IsRecording() {
+    return session.load(std::memory_order_relaxed) != 0;
+}
+
+/**
+ * Records a breakpoint hit, with the registers its handler reads.
+ * @param event The event, whose timestamp becomes the time of the record.
+ */
+void Recorder::RecordBreakpoint(const BreakpointEvent &event) {
+    uint32_t current = session.load(std::memory_order_relaxed);
+    if (current == 0) {
+        return;
+    }
+    SessionRecord record = MakeRecord(RecordKind::Breakpoint, 0, (int64_t) event.timestamp);
+    record.breakpoint = {static_cast<uint32_t>(event.id), event.threadId, event.eax, event.ebx, event.ecx, event.esi,
+                         event.edi};
+    Push(record, current);
+}
+
+/**
+ * Queues the bytes of a read. The flush thread records the ones that differ from what earlier reads saw.
+ * @param address The address that was read.
+ * @param buffer The bytes that were read.
+ * @param size The number of bytes.
+ */
+void Recorder::RecordMemory(DWORD address, const void *buffer, SIZE_T size) {
+    uint32_t current = session.load(std::memory_order_relaxed);
+    if (current == 0) {
+        return;
+    }
+    uint64_t order = ticketCount.load(std::memory_order_relaxed);
+    const BYTE *bytes = static_cast<const BYTE *>(buffer);
+    while (size > 0) {
+        SIZE_T count = std::min<SIZE_T>(size, MAX_READ_SIZE);
+        Entry *entry = Reserve(count);
+        if (entry == nullptr) {
+            return;
+        }
+        entry->order = order;
+        entry->address = address;
+        entry->session = (uint8_t) current;
+        entry->kind = EntryKind::Read;
+        std::memcpy(entry + 1, bytes, count);
+        Commit(entry);
+        address += (DWORD) count;
+        bytes += count;
+        size -= count;
+    }
+}
+
+/**
+ * Queues the chunks of a page the page cache fetched that changed since its previous fetch, or the whole page if that
+ * was not queued in this recording, and brings the cache's copy of the page up to date. The flush thread records the
+ * bytes that differ from what earlier pages and reads saw.
+ * @param address The address of the page.
+ * @param bytes The bytes of the page, PAGE_SIZE of them.
+ * @param copy (in/out) The page as it was last fetched, which receives the bytes.
+ * @param copySession The recording the copy was queued in, or 0 if it was not.
+ * @return The recording the page was queued in, or 0 if it was not, in which case its next fetch is queued whole.
+ */
+uint32_t Recorder::RecordPage(DWORD address, const BYTE *bytes, BYTE *copy, uint32_t copySession) {
+    static_assert(PAGE_CHUNKS / 8 + PAGE_SIZE <= MAX_SNAPSHOT_SIZE, "A whole page must fit an entry");
+    uint32_t current = session.load(std::memory_order_relaxed);
+    uint64_t changed[PAGE_CHUNKS / 64] = {};
+    uint8_t changedChunks[PAGE_CHUNKS];
+    size_t changedCount = PAGE_CHUNKS;
+    if (current != 0 && current == copySession) {
+        static const FindChangedChunksFunction findChangedChunks = SelectFindChangedChunks();
+        // Most pages do not change between fetches, and the rest only in a few chunks
+        changedCount = findChangedChunks(copy, bytes, changedChunks);
+        if (changedCount == 0) {
+            return current;
+        }
+        for (size_t i = 0; i < changedCount; i++) {
+            changed[changedChunks[i] / 64] |= 1ull << (changedChunks[i] % 64);
+        }
+    } else {
+        std::fill(std::begin(changed), std::end(changed), ~0ull);
+    }
+    Entry *entry = current != 0 ? Reserve(sizeof(changed) + changedCount * CHUNK_SIZE) : nullptr;
+    if (entry == nullptr) {
+        std::memcpy(copy, bytes, PAGE_SIZE);
+        return 0;
+    }
+    entry->order = ticketCount.load(std::memory_order_relaxed);
+    entry->address = address;
+    entry->session = (uint8_t) current;
+    entry->kind = EntryKind::Page;
+    uint8_t *out = reinterpret_cast<uint8_t *>(entry + 1);
+    std::memcpy(out, changed, sizeof(changed));
+    out += sizeof(changed);
+    if (changedCount == PAGE_CHUNKS) {
+        std::memcpy(out, bytes, PAGE_SIZE);
+        std::memcpy(copy, bytes, PAGE_SIZE);
+    } else {
+        for (size_t i = 0; i < changedCount; i++) {
+            size_t offset = changedChunks[i] * CHUNK_SIZE;
+            std::memcpy(out, bytes + offset, CHUNK_SIZE);
+            std::memcpy(copy + offset, bytes + offset, CHUNK_SIZE);
+            out += CHUNK_SIZE;
+        }
+    }
+    Commit(entry);
+    return current;
+}
+
+/**
+ * Queues the conveyor items and customers of a snapshot, if the game state version changed since the last snapshot
+ * queued. The flush thread records the ones that were added, removed or changed since that snapshot; items moving along
+ * the conveyor is not a change, and their positions are recorded with every other change.
+ * @param snapshot The snapshot that is about to be published.
+ * @note Must only be called by the thread that publishes snapshots.
+ */
+void Recorder::RecordSnapshot(const WorldSnapshot &snapshot) {
+    uint32_t current = session.load(std::memory_order_relaxed);
+    if (current == 0 || (current == snapshotSession && snapshot.version == snapshotVersion)) {
+        return;
+    }
+    const ConveyorTable &conveyor = snapshot.conveyor;
+    size_t size = sizeof(SnapshotHeader) + conveyor.Size() * sizeof(ItemState) +
+                  snapshot.customers.size() * sizeof(CustomerState);
+    if (size > MAX_SNAPSHOT_SIZE) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Entry *entry = Reserve(size);
+    if (entry == nullptr) {
+        return;
+    }
+    SnapshotHeader *header = reinterpret_cast<SnapshotHeader *>(entry + 1);
+    header->timeNanos = snapshot.timeNanos;
+    header->itemCount = (uint32_t) conveyor.Size();
+    header->customerCount = (uint32_t) snapshot.customers.size();
+    ItemState *itemStates = reinterpret_cast<ItemState *>(header + 1);
+    for (size_t i = 0; i < conveyor.Size(); i++) {
+        itemStates[i] = {conveyor.address[i],
+                         {conveyor.itemId[i], conveyor.ingredientId[i], static_cast<int32_t>(conveyor.kind[i]),
+                          conveyor.subItemCount[i], conveyor.x[i], conveyor.y[i], (uint32_t) conveyor.generation[i]}};
+    }
+    CustomerState *customerStates = reinterpret_cast<CustomerState *>(itemStates + conveyor.Size());
+    for (const CustomerEntry &customer: snapshot.customers) {
+        CustomerState &state = *customerStates++;
+        state = {customer.address, {customer.id, customer.orderCount, 0, 0}};
+        for (int i = customer.firstOrder; i < customer.firstOrder + customer.orderCount; i++) {
+            state.record.ingredientCount += snapshot.orders[i].ingredientCount;
+            if ((size_t) i < snapshot.missingIngredients.size()) {
+                state.record.missingCount += snapshot.missingIngredients[i];
+            }
+        }
+    }
+    entry->order = ticketCount.fetch_add(1, std::memory_order_relaxed);
+    entry->address = 0;
+    entry->session = (uint8_t) current;
+    entry->kind = EntryKind::Snapshot;
+    Commit(entry);
+    snapshotVersion = snapshot.version;
+    snapshotSession = current;
+}
+
+/**
+ * Records a command the planner submitted.
+ * @param command The command.
+ */
+void Recorder::RecordAction(const ActuatorCommand &command) {
+    uint32_t current = session.load(std::memory_order_relaxed);
+    if (current == 0) {
+        return;
+    }
+    SessionRecord record = MakeRecord(RecordKind::Action, command.item, ChangeSignal::NowNanos());
+    record.action = {static_cast<uint32_t>(command.type), command.x, command.y, (uint32_t) command.sequence};
+    Push(record, current);
+}
+
+/**
+ * Records a run of the planner.
+ * @param version The game state version the planner runs at.
+ */
+void Recorder::RecordTick(uint64_t version) {
+    uint32_t current = session.load(std::memory_order_relaxed);
+    if (current == 0) {
+        return;
+    }
+    SessionRecord record = MakeRecord(RecordKind::Tick, 0, ChangeSignal::NowNanos());
+    record.tick.version = version;
+    Push(record, current);
+}
+
+/**
+ * Returns the number of records made since the recording started, including dropped ones. Memory, Item and Customer
+ * records count once the flush thread has made them from the pages, reads and snapshots.
+ * @return The number of records.
+ */
+uint64_t Recorder::GetRecordCount() {
+    return ticketCount.load(std::memory_order_relaxed) - snapshotCount.load(std::memory_order_relaxed) +
+           comparedCount.load(std::memory_order_relaxed) + droppedCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * Returns the number of records, pages, reads and snapshots dropped because a ring was full, or a snapshot too large to
+ * queue.
+ * @return The number of records, pages, reads and snapshots.
+ */
+uint64_t Recorder::GetDroppedCount() {
+    return droppedCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * Returns the number of records written to the file.
+ * @return The number of records.
+ */
+uint64_t Recorder::GetWrittenCount() {
+    return writtenCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * Reads a recorded session.
+ * @param filename The session file.
+ * @param records (out) The records, in the order they were recorded.
+ * @return Whether the file is a complete session recording.
+ */
+bool Recorder::Load(const std::string &filename, std::vector<SessionRecord> &records) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        std::cout << "Error: Could not open " << filename << "." << std::endl;
+        return false;
+    }
+    char magic[4];
+    uint32_t header[2];
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char *>(header), sizeof(header));
+    if (!in || std::memcmp(magic, SESSION_MAGIC, sizeof(magic)) != 0 || header[0] != SESSION_VERSION ||
+        header[1] != sizeof(SessionRecord)) {
+        std::cout << "Error: " << filename << " is not a session recording." << std::endl;
+        return false;
+    }
+    records.clear();
+    SessionRecord record;
+    while (in.read(reinterpret_cast<char *>(&record), sizeof(record))) {
+        records.push_back(record);
+    }
+    if (in.gcount() != 0) {
+        std::cout << "Error: " << filename << " ends in a partial record." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @internal
+ * Returns the ring of the calling thread, taking over the ring of a thread that exited or making a new one.
+ * @return The ring, or @c nullptr if too many threads record.
+ */
+Recorder::Producer *Recorder::GetProducer() {
+    // Gives the ring back when the thread exits
+    struct Lease {
+        Producer *producer = nullptr;
+
+        ~Lease() {
+            if (producer != nullptr) {
+                producer->owned.store(false, std::memory_order_release);
+            }
+        }
+    };
+    static thread_local Lease lease;
+    if (lease.producer != nullptr) {
+        return lease.producer;
+    }
+    std::lock_guard<std::mutex> lock(producersMutex);
+    size_t count = producerCount.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count && lease.producer == nullptr; i++) {
+        bool owned = false;
+        if (producers[i]->owned.compare_exchange_strong(owned, true, std::memory_order_acquire)) {
+            lease.producer = producers[i].get();
+        }
+    }
+    if (lease.producer == nullptr) {
+        if (count == MAX_PRODUCERS) {
+            return nullptr;
+        }
+        producers[count] = std::make_unique<Producer>();
+        lease.producer = producers[count].get();
+        producerCount.store(count + 1, std::memory_order_release);
+    }
+    localProducer = lease.producer;
+    return lease.producer;
+}
+
+/**
+ * @internal
+ * Reserves an entry on the calling thread's ring. Its ticket is taken after this, so every ticket taken is queued.
+ * @param size The number of bytes that follow the entry.
+ * @return The entry, with its size set, or @c nullptr if it does not fit; the drop is counted.
+ */
+Recorder::Entry *Recorder::Reserve(size_t size) {
+    Producer *producer = localProducer != nullptr ? localProducer : GetProducer();
+    uint8_t *slot = producer != nullptr ? producer->ring.Reserve(sizeof(Entry) + ((size + 7) & ~(size_t) 7)) : nullptr;
+    if (slot == nullptr) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Entry *entry = reinterpret_cast<Entry *>(slot);
+    entry->size = (uint16_t) size;
+    return entry;
+}
+
+/**
+ * @internal
+ * Hands a reserved entry to the flush thread.
+ * @param entry The entry, written.
+ */
+void Recorder::Commit(const Entry *entry) {
+    localProducer->ring.Commit(GetEntrySize(*entry));
+}
+
+/**
+ * @internal
+ * Queues a record on the calling thread's ring, with the next ticket.
+ * @param record The record.
+ * @param current The recording it belongs to.
+ */
+void Recorder::Push(const SessionRecord &record, uint32_t current) {
+    Entry *entry = Reserve(sizeof(SessionRecord));
+    if (entry == nullptr) {
+        return;
+    }
+    entry->order = ticketCount.fetch_add(1, std::memory_order_relaxed);
+    entry->address = record.address;
+    entry->session = (uint8_t) current;
+    entry->kind = EntryKind::Record;
+    std::memcpy(entry + 1, &record, sizeof(SessionRecord));
+    Commit(entry);
+}
+
+/**
+ * @internal
+ * Returns an empty record of a kind.
+ * @param kind The kind of record.
+ * @param address The address of the record.
+ * @param timeNanos The time of the record.
+ * @return The record, with every other byte zero so that files are reproducible.
+ */
+SessionRecord Recorder::MakeRecord(RecordKind kind, DWORD address, int64_t timeNanos) {
+    SessionRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.timeNanos = timeNanos;
+    record.kind = kind;
+    record.address = address;
+    return record;
+}
+
+/**
+ * @internal
+ * Returns the number of bytes an entry takes in its ring.
+ * @param entry The entry.
+ * @return The number of bytes.
+ */
+size_t Recorder::GetEntrySize(const Entry &entry) {
+    return sizeof(Entry) + ((entry.size + 7) & ~(size_t) 7);
+}
+
+/**
+ * @internal
+ * Writes the queued records to the file every few milliseconds, and once more after the recording stopped.
+ */
+void Recorder::FlushThread() {
+    std::unique_lock<std::mutex> lock(flushMutex);
+    while (session.load() != 0) {
+        flushSignal.wait_for(lock, std::chrono::milliseconds(FLUSH_MILLIS), [] { return session.load() == 0; });
+        lock.unlock();
+        Drain(false);
+        lock.lock();
+    }
+    Drain(true);
+    file.flush();
+}
+
+/**
+ * @internal
+ * Writes the queued records to the file in ticket order, each after the pages and reads that came before it.
+ * A ticket still missing after two drains was taken by a thread that stopped before queueing its record, e.g. as the
+ * recording stopped, and is skipped. Must only be called by the flush thread.
+ * @param stopping Whether the recording stopped, in which case everything left is written.
+ */
+void Recorder::Drain(bool stopping) {
+    size_t count = producerCount.load(std::memory_order_acquire);
+    uint8_t current = (uint8_t) lastSession;
+    while (true) {
+        // The pages and reads of every thread that come before the next record
+        uint64_t nextOrder = UINT64_MAX;
+        for (size_t i = 0; i < count; i++) {
+            ByteRing &ring = producers[i]->ring;
+            while (const uint8_t *slot = ring.Front()) {
+                const Entry &entry = *reinterpret_cast<const Entry *>(slot);
+                bool read = entry.kind == EntryKind::Read || entry.kind == EntryKind::Page;
+                if (entry.session == current && (!read || entry.order > nextTicket)) {
+                    nextOrder = std::min(nextOrder, entry.order);
+                    break;
+                }
+                if (entry.session == current && entry.kind == EntryKind::Read) {
+                    Compare(entry.address, slot + sizeof(Entry), entry.size);
+                } else if (entry.session == current) {
+                    ComparePage(entry.address, slot + sizeof(Entry));
+                }
+                ring.Release(GetEntrySize(entry));
+            }
+        }
+        // The next record
+        bool found = false;
+        for (size_t i = 0; i < count && !found; i++) {
+            ByteRing &ring = producers[i]->ring;
+            const uint8_t *slot = ring.Front();
+            if (slot == nullptr) {
+                continue;
+            }
+            const Entry &entry = *reinterpret_cast<const Entry *>(slot);
+            bool read = entry.kind == EntryKind::Read || entry.kind == EntryKind::Page;
+            if (!read && entry.order <= nextTicket) {
+                if (entry.kind == EntryKind::Snapshot) {
+                    CompareSnapshot(slot + sizeof(Entry));
+                    snapshotCount.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    SessionRecord record;
+                    std::memcpy(&record, slot + sizeof(Entry), sizeof(record));
+                    Write(record);
+                    lastTimeNanos = record.timeNanos;
+                }
+                nextTicket = std::max(nextTicket, entry.order + 1);
+                ring.Release(GetEntrySize(entry));
+                found = true;
+            }
+        }
+        if (found) {
+            continue;
+        }
+        if (nextOrder == UINT64_MAX) {
+            stalledTicket = 0;
+            break;
+        }
+        // The next ticket is not queued yet; it is waited for until the next drain
+        if (!stopping && stalledTicket != nextTicket + 1) {
+            stalledTicket = nextTicket + 1;
+            break;
+        }
+        nextTicket = nextOrder;
+    }
+    WriteBatch();
+}
+
+/**
+ * @internal
+ * Returns the shadow of a page, creating it if the recording has not seen the page yet.
+ * Must only be called by the flush thread.
+ * @param base The address of the page.
+ * @return The shadow of the page.
+ */
+Recorder::ShadowPage &Recorder::GetShadowPage(uint64_t base) {
+    // Reads cluster on a few pages, so the last page is looked up without the map
+    if (lastPage == nullptr || base != lastPageBase) {
+        std::unique_ptr<ShadowPage> &slot = shadow[(DWORD) base];
+        if (slot == nullptr) {
+            slot = std::make_unique<ShadowPage>();
+        }
+        lastPage = slot.get();
+        lastPageBase = base;
+    }
+    return *lastPage;
+}
+
+/**
+ * @internal
+ * Records the bytes of a read that differ from what earlier pages and reads saw, one record per changed chunk.
+ * Must only be called by the flush thread.
+ * @param address The address that was read.
+ * @param bytes The bytes that were read.
+ * @param size The number of bytes.
+ */
+void Recorder::Compare(DWORD address, const BYTE *bytes, SIZE_T size) {
+    uint64_t end = (uint64_t) address + size;
+    for (uint64_t segment = address; segment < end;) {
+        uint64_t base = segment & ~(uint64_t) (PAGE_SIZE - 1);
+        uint64_t segmentEnd = std::min<uint64_t>(base + PAGE_SIZE, end);
+        ShadowPage &page = GetShadowPage(base);
+        const BYTE *source = bytes + (segment - address);
+        BYTE *seen = page.data + (segment - base);
+        // Most reads see nothing new, which one comparison of the whole range finds
+        bool known = true;
+        uint64_t first = segment & ~(uint64_t) (CHUNK_SIZE - 1);
+        for (uint64_t chunk = first; known && chunk < segmentEnd; chunk += CHUNK_SIZE) {
+            known = (~page.known[(chunk - base) / CHUNK_SIZE] & ChunkMask(chunk, segment, segmentEnd)) == 0;
+        }
+        if (!known || std::memcmp(seen, source, segmentEnd - segment) != 0) {
+            for (uint64_t chunk = first; chunk < segmentEnd; chunk += CHUNK_SIZE) {
+                uint64_t from = std::max(chunk, segment);
+                size_t count = std::min(chunk + CHUNK_SIZE, segmentEnd) - from;
+                uint32_t mask = ChunkMask(chunk, segment, segmentEnd);
+                size_t index = (chunk - base) / CHUNK_SIZE;
+                const BYTE *chunkSource = bytes + (from - address);
+                BYTE *chunkSeen = page.data + (from - base);
+                if ((page.known[index] & mask) == mask && std::memcmp(chunkSeen, chunkSource, count) == 0) {
+                    continue;
+                }
+                std::memcpy(chunkSeen, chunkSource, count);
+                page.known[index] |= mask;
+                // The page cache's next fetch of the page may not see this chunk change back
+                page.diverged[index / 64] |= 1ull << (index % 64);
+                SessionRecord record = MakeRecord(RecordKind::Memory, (DWORD) from, lastTimeNanos);
+                record.size = (uint16_t) count;
+                std::memcpy(record.bytes, chunkSource, count);
+                comparedCount.fetch_add(1, std::memory_order_relaxed);
+                Write(record);
+            }
+        }
+        segment = segmentEnd;
+    }
+}
+
+/**
+ * @internal
+ * Records the bytes of a fetched page that differ from what earlier pages and reads saw, one record per changed chunk.
+ * Only the chunks the page cache queued as changed, and those that reads changed since its previous fetch, can differ.
+ * Must only be called by the flush thread.
+ * @param address The address of the page.
+ * @param bytes The page, as RecordPage queued it.
+ */
+void Recorder::ComparePage(DWORD address, const uint8_t *bytes) {
+    ShadowPage &page = GetShadowPage(address);
+    uint64_t changed[PAGE_CHUNKS / 64];
+    std::memcpy(changed, bytes, sizeof(changed));
+    const BYTE *source = bytes + sizeof(changed);
+    for (size_t word = 0; word < PAGE_CHUNKS / 64; word++) {
+        if ((changed[word] | page.diverged[word]) == 0) {
+            continue;
+        }
+        for (size_t index = word * 64; index < word * 64 + 64; index++) {
+            uint64_t bit = 1ull << (index % 64);
+            if (changed[word] & bit) {
+                std::memcpy(page.fetched + index * CHUNK_SIZE, source, CHUNK_SIZE);
+                source += CHUNK_SIZE;
+            } else if (!(page.diverged[word] & bit)) {
+                continue;
+            }
+            BYTE *seen = page.data + index * CHUNK_SIZE;
+            const BYTE *chunkSource = page.fetched + index * CHUNK_SIZE;
+            if (page.known[index] == ~0u && std::memcmp(seen, chunkSource, CHUNK_SIZE) == 0) {
+                continue;
+            }
+            std::memcpy(seen, chunkSource, CHUNK_SIZE);
+            page.known[index] = ~0u;
+            DWORD chunkAddress = address + (DWORD) (index * CHUNK_SIZE);
+            SessionRecord record = MakeRecord(RecordKind::Memory, chunkAddress, lastTimeNanos);
+            record.size = (uint16_t) CHUNK_SIZE;
+            std::memcpy(record.bytes, chunkSource, CHUNK_SIZE);
+            comparedCount.fetch_add(1, std::memory_order_relaxed);
+            Write(record);
+        }
+    }
+    std::fill(std::begin(page.diverged), std::end(page.diverged), 0);
+}
+
+/**
+ * @internal
+ * Records the conveyor items and customers of a snapshot that were added, removed or changed since the previous one.
+ * Must only be called by the flush thread.
+ * @param bytes The snapshot, as RecordSnapshot queued it.
+ */
+void Recorder::CompareSnapshot(const uint8_t *bytes) {
+    const SnapshotHeader *header = reinterpret_cast<const SnapshotHeader *>(bytes);
+    int64_t timeNanos = header->timeNanos;
+    const ItemState *itemStates = reinterpret_cast<const ItemState *>(header + 1);
+    nextItems.assign(itemStates, itemStates + header->itemCount);
+    const CustomerState *customerStates = reinterpret_cast<const CustomerState *>(itemStates + header->itemCount);
+    nextCustomers.assign(customerStates, customerStates + header->customerCount);
+    auto byAddress = [](const auto &a, const auto &b) { return a.address < b.address; };
+    std::sort(nextItems.begin(), nextItems.end(), byAddress);
+    std::sort(nextCustomers.begin(), nextCustomers.end(), byAddress);
+
+    // Both lists are sorted by address, so one merge finds the additions, removals and changes
+    size_t i = 0;
+    size_t j = 0;
+    while (i < items.size() || j < nextItems.size()) {
+        SessionRecord record;
+        if (j == nextItems.size() || (i < items.size() && items[i].address < nextItems[j].address)) {
+            record = MakeRecord(RecordKind::Item, items[i].address, timeNanos);
+            record.flags = RECORD_REMOVED;
+            record.item = items[i++].record;
+        } else if (i == items.size() || nextItems[j].address < items[i].address) {
+            record = MakeRecord(RecordKind::Item, nextItems[j].address, timeNanos);
+            record.flags = RECORD_ADDED;
+            record.item = nextItems[j++].record;
+        } else {
+            const ItemRecord &before = items[i++].record;
+            const ItemRecord &after = nextItems[j++].record;
+            if (before.itemId == after.itemId && before.ingredientId == after.ingredientId &&
+                before.kind == after.kind && before.subItemCount == after.subItemCount) {
+                continue;
+            }
+            record = MakeRecord(RecordKind::Item, nextItems[j - 1].address, timeNanos);
+            record.flags = RECORD_CHANGED;
+            record.item = after;
+        }
+        comparedCount.fetch_add(1, std::memory_order_relaxed);
+        Write(record);
+    }
+    i = 0;
+    j = 0;
+    while (i < customers.size() || j < nextCustomers.size()) {
+        SessionRecord record;
+        if (j == nextCustomers.size() || (i < customers.size() && customers[i].address < nextCustomers[j].address)) {
+            record = MakeRecord(RecordKind::Customer, customers[i].address, timeNanos);
+            record.flags = RECORD_REMOVED;
+            record.customer = customers[i++].record;
+        } else if (i == customers.size() || nextCustomers[j].address < customers[i].address) {
+            record = MakeRecord(RecordKind::Customer, nextCustomers[j].address, timeNanos);
+            record.flags = RECORD_ADDED;
+            record.customer = nextCustomers[j++].record;
+        } else {
+            const CustomerRecord &before = customers[i++].record;
+            const CustomerRecord &after = nextCustomers[j++].record;
+            if (std::memcmp(&before, &after, sizeof(CustomerRecord)) == 0) {
+                continue;
+            }
+            record = MakeRecord(RecordKind::Customer, nextCustomers[j - 1].address, timeNanos);
+            record.flags = RECORD_CHANGED;
+            record.customer = after;
+        }
+        comparedCount.fetch_add(1, std::memory_order_relaxed);
+        Write(record);
+    }
+    items.swap(nextItems);
+    customers.swap(nextCustomers);
+}
+
+/**
+ * @internal
+ * Adds a record to the batch for the file, writing the batch once it is full. Must only be called by the flush thread.
+ * @param record The record.
+ */
+void Recorder::Write(const SessionRecord &record) {
+    batch.push_back(record);
+    if (batch.size() == BATCH_SIZE) {
+        WriteBatch();
+    }
+}
+
+/**
+ * @internal
+ * Writes the batched records to the file. Must only be called by the flush thread.
+ */
+void Recorder::WriteBatch() {
+    if (batch.empty()) {
+        return;
+    }
+    file.write(reinterpret_cast<const char *>(batch.data()), batch.size() * sizeof(SessionRecord));
+    writtenCount.fetch_add(batch.size(), std::memory_order_relaxed);
+    batch.clear();
+}
+
+/**
+ * Reads from the backend.
+ * @param address The address to read from.
+ * @param buffer (out) The buffer to read into.
+ * @param size The size of the buffer.
+ * @return Whether the backend read the whole range.
+ */
+bool RecordingProcessMemory::ReadImpl(DWORD address, LPVOID buffer, SIZE_T size) {
+    return backend.Read(address, buffer, size);
+}
+
+/**
+ * Writes to the backend.
+ * @param address The address to write to.
+ * @param buffer The buffer to write.
+ * @param size The size of the buffer.
+ * @return Whether the backend wrote the whole range.
+ */
+bool RecordingProcessMemory::WriteImpl(DWORD address, LPCVOID buffer, SIZE_T size) {
+    return backend.Write(address, buffer, size);
+}
@@ -0,0 +1,258 @@
+#include <Replayer.h>
+#include <BreakpointHandlers.h>
+#include <ChangeSignal.h>
+#include <Managers.h>
+#include <World.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+static Replayer *attachedReplayer = nullptr;
+
+/**
+ * @internal
+ * Returns whether a command is the one an Action record recorded. Sequence numbers and send times are not compared.
+ */
+static bool IsRecordedCommand(const SessionRecord &record, const ActuatorCommand &command) {
+    return record.action.type == static_cast<uint32_t>(command.type) && record.action.x == command.x &&
+           record.action.y == command.y && record.address == command.item;
+}
+
+/**
+ * Creates a replay of a recorded session. Nothing happens until it is attached.
+ * @param records The records, as Recorder::Load read them.
+ */
+Replayer::Replayer(std::vector<SessionRecord> records) : records(std::move(records)) {
+}
+
+/**
+ * Detaches the replay if it is attached.
+ */
+Replayer::~Replayer() {
+    Detach();
+}
+
+/**
+ * Makes the replay the game the bot plays: hands an empty memory image and a ReplayActuator to GameState, replaces
+ * the clock, and resets the game state, the planner and the world reader.
+ * @return Whether the replay could be attached.
+ */
+bool Replayer::Attach() {
+    if (attached) {
+        return true;
+    }
+    if (attachedReplayer != nullptr) {
+        std::cout << "Error: Another replay is attached." << std::endl;
+        return false;
+    }
+    std::unique_ptr<ImageProcessMemory> memory = std::make_unique<ImageProcessMemory>();
+    image = memory.get();
+    attachedReplayer = this;
+    attached = true;
+    nowNanos = records.empty() ? 0 : records.front().timeNanos;
+    ChangeSignal::SetClock(&Replayer::NowNanos);
+    GameState::SetMemory(std::move(memory));
+    GameState::SetActuator(std::make_unique<ReplayActuator>(*this));
+    GameState::Reset();
+    GameState::ResetActions();
+    GameState::GetTickClock().Reset();
+    WorldReader::Reset();
+    return true;
+}
+
+/**
+ * Stops the bot from playing the replay: removes the actuator and restores the steady clock. The memory image stays
+ * with GameState until it is replaced.
+ */
+void Replayer::Detach() {
+    if (!attached) {
+        return;
+    }
+    GameState::SetActuator(nullptr);
+    ChangeSignal::SetClock(nullptr);
+    attachedReplayer = nullptr;
+    attached = false;
+    image = nullptr;
+}
+
+/**
+ * Replays the whole session.
+ * @param speed How fast to replay: 1 keeps the recorded pace, 2 replays twice as fast, and 0 as fast as possible.
+ * @return Whether every planner run submitted the commands it submitted in the recording.
+ */
+bool Replayer::Run(double speed) {
+    if (!attached) {
+        std::cout << "Error: The replay is not attached." << std::endl;
+        return false;
+    }
+    int64_t wallStart = ChangeSignal::SteadyNanos();
+    int64_t firstNanos = nowNanos;
+    size_t i = 0;
+    while (i < records.size()) {
+        const SessionRecord &record = records[i];
+        if (record.kind == RecordKind::Memory) {
+            i = ApplyMemory(i, false);
+            continue;
+        }
+        // Snapshot changes are what the planner runs capture again, and commands are compared by their run
+        if (record.kind != RecordKind::Breakpoint && record.kind != RecordKind::Tick) {
+            i++;
+            continue;
+        }
+        if (speed > 0.0) {
+            int64_t wallNanos = wallStart + (int64_t) ((double) (record.timeNanos - firstNanos) / speed);
+            std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(wallNanos)));
+        }
+        nowNanos = std::max(nowNanos, record.timeNanos);
+        if (record.kind == RecordKind::Tick) {
+            i = Tick(i);
+            continue;
+        }
+        // The handler's reads are recorded after the hit
+        size_t next = ApplyMemory(i + 1, false);
+        BreakpointEvent event = {static_cast<BreakpointId>(record.breakpoint.id), record.breakpoint.threadId,
+                                 record.breakpoint.eax, record.breakpoint.ebx, record.breakpoint.ecx,
+                                 record.breakpoint.esi, record.breakpoint.edi, (uint64_t) record.timeNanos};
+        BreakpointHandlers::Dispatch(event, GameState::GetDirectMemory());
+        stats.breakpoints++;
+        i = next;
+    }
+    stats.wallNanos = ChangeSignal::SteadyNanos() - wallStart;
+    return stats.divergentTicks == 0;
+}
+
+/**
+ * Receives a command the planner sent, to compare it to the recording.
+ * @param command The command.
+ */
+void Replayer::Send(const ActuatorCommand &command) {
+    sent.push_back(command);
+}
+
+/**
+ * Returns what the replay did so far.
+ * @return The counts.
+ */
+const ReplayStats &Replayer::GetStats() const {
+    return stats;
+}
+
+/**
+ * Returns the recorded time the attached replay is at; this is the clock of ChangeSignal while one is attached.
+ * @return The time in nanoseconds.
+ */
+int64_t Replayer::NowNanos() {
+    return attachedReplayer != nullptr ? attachedReplayer->nowNanos : 0;
+}
+
+/**
+ * @internal
+ * Writes the bytes of a Memory record into the image, mapping the blocks it touches.
+ */
+void Replayer::Apply(const SessionRecord &record) {
+    SIZE_T size = std::min<SIZE_T>(record.size, SessionRecord::PAYLOAD_SIZE);
+    SIZE_T done = 0;
+    while (done < size) {
+        uint64_t address = (uint64_t) record.address + done;
+        uint64_t block = address & ~(uint64_t) (BLOCK_SIZE - 1);
+        SIZE_T count = std::min<SIZE_T>(size - done, block + BLOCK_SIZE - address);
+        BYTE *data = image->Translate((DWORD) address, count);
+        if (data == nullptr) {
+            data = image->MapRegion((DWORD) block, BLOCK_SIZE);
+            if (data == nullptr) {
+                return;
+            }
+            data += address - block;
+        }
+        memcpy(data, record.bytes + done, count);
+        done += count;
+    }
+}
+
+/**
+ * @internal
+ * Applies the Memory records from an index on.
+ * @param index The index of the first record.
+ * @param wholeTick Whether to apply the memory a planner run read: past its commands and snapshot changes, up to the
+ * next breakpoint or run. Otherwise only up to the next record of another kind.
+ * @return The index of the first record that was not applied or skipped.
+ */
+size_t Replayer::ApplyMemory(size_t index, bool wholeTick) {
+    for (; index < records.size(); index++) {
+        RecordKind kind = records[index].kind;
+        if (kind == RecordKind::Memory) {
+            Apply(records[index]);
+            stats.memoryRecords++;
+        } else if (!wholeTick || kind == RecordKind::Breakpoint || kind == RecordKind::Tick) {
+            break;
+        }
+    }
+    return index;
+}
+
+/**
+ * @internal
+ * Runs the planner for a Tick record and compares the commands it sends to the Action records of the run.
+ * The image gets every byte the run read first, and the page cache starts over. The bot read through the page cache,
+ * so it saw a page as it was when the page was fetched, possibly runs ago; the recording has those bytes as the run
+ * read them, but the pages the replay fetched earlier do not.
+ * @param index The index of the Tick record.
+ * @return The index of the first record after the run.
+ */
+size_t Replayer::Tick(size_t index) {
+    size_t next = ApplyMemory(index + 1, true);
+    GameState::GetPageCache().Invalidate();
+    int64_t start = ChangeSignal::SteadyNanos();
+    WorldReader::PublishIfStale();
+    sent.clear();
+    GameState::PerformActions();
+    GameState::GetActuator().Flush();
+    stats.tickLatency.Record(ChangeSignal::SteadyNanos() - start);
+
+    bool divergent = false;
+    size_t position = 0;
+    for (size_t i = index + 1; i < records.size() && records[i].kind != RecordKind::Tick; i++) {
+        if (records[i].kind != RecordKind::Action) {
+            continue;
+        }
+        if (position < sent.size() && IsRecordedCommand(records[i], sent[position])) {
+            stats.matchedActions++;
+        } else {
+            divergent = true;
+        }
+        position++;
+    }
+    stats.recordedActions += position;
+    stats.replayedActions += sent.size();
+    if (divergent || position != sent.size()) {
+        if (stats.divergentTicks == 0) {
+            stats.firstDivergentTick = stats.ticks;
+            stats.firstDivergenceNanos = records[index].timeNanos;
+        }
+        stats.divergentTicks++;
+    }
+    stats.ticks++;
+    return next;
+}
+
+/**
+ * Stops the actuator thread if it was ever started.
+ */
+ReplayActuator::~ReplayActuator() {
+    Stop();
+}
+
+/**
+ * Hands a batch to the replayer.
+ * @param commands The commands.
+ * @param count The number of commands.
+ * @return @c true.
+ */
+bool ReplayActuator::SendBatch(const ActuatorCommand *commands, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        replayer.Send(commands[i]);
+    }
+    return true;
+}
@@ -0,0 +1,766 @@
+#include <Simulator.h>
+#include <BreakpointHandlers.h>
+#include <ChangeSignal.h>
+#include <Managers.h>
+#include <TypeCache.h>
+#include <World.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+// The synthetic image: the vtables and the code they point to, the objects the breakpoints pass, a heap of items and a
+// heap of customers
+static const DWORD CODE_BASE = 0x00400000;
+static const SIZE_T CODE_SIZE = 0x1000;
+static const DWORD SIMPLE_VTABLE = CODE_BASE;
+static const DWORD COMPLEX_VTABLE = CODE_BASE + 0x10;
+static const DWORD SIMPLE_FUNCTION = CODE_BASE + 0x100;
+static const DWORD COMPLEX_FUNCTION = CODE_BASE + 0x200;
+static const DWORD GAME_BASE = 0x01000000;
+static const SIZE_T GAME_SIZE = 0x1000;
+static const DWORD CONVEYOR_OBJECT = GAME_BASE;
+static const DWORD BB_PERCENT = GAME_BASE + 0x200;
+// The list node the conveyor breakpoints pass; it is rewritten for every hit
+static const DWORD CONVEYOR_NODE = GAME_BASE + 0x300;
+static const DWORD ITEM_BASE = 0x02000000;
+static const DWORD ITEM_SLOT_SIZE = 0x100;
+static const DWORD NUM_ITEM_SLOTS = 16384;
+static const DWORD CUSTOMER_BASE = 0x04000000;
+static const DWORD CUSTOMER_SLOT_SIZE = 0x800;
+static const DWORD NUM_CUSTOMER_SLOTS = 256;
+
+// The offsets of the fields the bot reads, see Content.cpp
+static const DWORD ITEM_X = 0x24;
+static const DWORD ITEM_Y = 0x28;
+static const DWORD ITEM_ID = 0x2C;
+static const DWORD ITEM_INGREDIENT = 0x30;
+static const DWORD ITEM_CONVEYOR_INDEX = 0x38;
+static const DWORD ITEM_TERMINATOR = 0x44;
+static const DWORD COMPLEX_COUNT = 0x58;
+static const DWORD COMPLEX_LIST = 0x78;
+// A complex item's list of sub-items follows it in its slot
+static const DWORD COMPLEX_LIST_DATA = 0x80;
+static const DWORD CUSTOMER_ORDERS = 0x15C;
+static const DWORD CUSTOMER_ID = 0x488;
+static const DWORD CUSTOMER_ORDER_DATA = 0x500;
+static const int MAX_CUSTOMER_ORDERS = (CUSTOMER_SLOT_SIZE - CUSTOMER_ORDER_DATA) / sizeof(ItemInfo);
+
+static const int BOTTOM_BUN = 1;
+static const int TOP_BUN = 8;
+
+static Simulator *attachedSimulator = nullptr;
+
+/**
+ * Returns the number of orders served per minute of a game.
+ * @param durationNanos The duration of the game in simulated time.
+ * @return The rate.
+ */
+double SimulatorStats::GetOrdersPerMinute(int64_t durationNanos) const {
+    return durationNanos > 0 ? ordersServed * 60e9 / durationNanos : 0.0;
+}
+
+/**
+ * Creates a simulated game. Nothing happens until it is attached.
+ * @param config The parameters of the game.
+ */
+Simulator::Simulator(const SimulatorConfig &config) : config(config), rng(config.seed) {
+}
+
+/**
+ * Detaches the game if it is attached.
+ */
+Simulator::~Simulator() {
+    Detach();
+}
+
+/**
+ * Sets up the game and makes it the one the bot plays: builds the memory image, hands it and a SimulatorActuator to
+ * GameState, replaces the clock, and resets the game state, the planner and the world reader.
+ * The menu is drawn from the item catalog, so ItemManager must have loaded the content.
+ * @return Whether the game could be attached.
+ */
+bool Simulator::Attach() {
+    if (attached) {
+        return true;
+    }
+    if (attachedSimulator != nullptr) {
+        std::cout << "Error: Another simulator is attached." << std::endl;
+        return false;
+    }
+    ChooseMenu();
+    if (menuBases.empty() || menuFillings.empty()) {
+        std::cout << "Error: The item catalog has no conveyor items to simulate. Load the content first." << std::endl;
+        return false;
+    }
+    std::unique_ptr<ImageProcessMemory> memory = std::make_unique<ImageProcessMemory>();
+    BYTE *code = memory->MapRegion(CODE_BASE, CODE_SIZE);
+    memory->MapRegion(GAME_BASE, GAME_SIZE);
+    memory->MapRegion(ITEM_BASE, NUM_ITEM_SLOTS * ITEM_SLOT_SIZE);
+    memory->MapRegion(CUSTOMER_BASE, NUM_CUSTOMER_SLOTS * CUSTOMER_SLOT_SIZE);
+    // Each vtable points to a function whose code carries the signature the type cache looks for
+    DWORD simpleFunction = SIMPLE_FUNCTION;
+    DWORD complexFunction = COMPLEX_FUNCTION;
+    int simpleSignature = TypeCache::SIMPLE_ITEM_SIGNATURE;
+    int complexSignature = TypeCache::COMPLEX_ITEM_SIGNATURE;
+    memcpy(code + (SIMPLE_VTABLE - CODE_BASE), &simpleFunction, sizeof(DWORD));
+    memcpy(code + (COMPLEX_VTABLE - CODE_BASE), &complexFunction, sizeof(DWORD));
+    memcpy(code + (SIMPLE_FUNCTION - CODE_BASE) + 4, &simpleSignature, sizeof(int));
+    memcpy(code + (COMPLEX_FUNCTION - CODE_BASE) + 4, &complexSignature, sizeof(int));
+    image = memory.get();
+
+    attachedSimulator = this;
+    attached = true;
+    ChangeSignal::SetClock(&Simulator::NowNanos);
+    GameState::SetMemory(std::move(memory));
+    GameState::SetActuator(std::make_unique<SimulatorActuator>(*this));
+    Hit(BreakpointId::Reset, 0);
+    GameState::ResetActions();
+    GameState::GetTickClock().Reset();
+    WorldReader::Reset();
+
+    std::uniform_int_distribution<int> firstArrival(0, config.arrivalFrames);
+    slots.resize(config.numSlots);
+    for (Slot &slot: slots) {
+        slot.occupied = false;
+        slot.nextArrival = firstArrival(rng);
+    }
+    return true;
+}
+
+/**
+ * Stops the bot from playing the game: removes the actuator and restores the steady clock. The memory image stays
+ * with GameState until it is replaced.
+ */
+void Simulator::Detach() {
+    if (!attached) {
+        return;
+    }
+    GameState::SetActuator(nullptr);
+    ChangeSignal::SetClock(nullptr);
+    attachedSimulator = nullptr;
+    attached = false;
+    image = nullptr;
+}
+
+/**
+ * Plays the game with the bot's planner for a while, the way the bot's main loop does: the planner runs whenever the
+ * game state changed, after the world reader published it, and at the latest when the planner asked to run again.
+ * The planner's own run time is not charged to the game, so the results do not depend on the machine.
+ * @param durationNanos The simulated time to play for.
+ */
+void Simulator::Run(int64_t durationNanos) {
+    if (!attached) {
+        std::cout << "Error: The simulator is not attached." << std::endl;
+        return;
+    }
+    int64_t endNanos = nowNanos + durationNanos;
+    while (nowNanos < endNanos) {
+        WorldReader::PublishIfStale();
+        int64_t deadlineNanos = GameState::PerformActions();
+        GameState::GetActuator().Flush();
+        int64_t next = std::min(std::min(deadlineNanos, GetNextEventNanos()), endNanos);
+        AdvanceTo(std::max(next, nowNanos + 1));
+    }
+}
+
+/**
+ * Advances the game to a time, applying the input that reaches the game and playing every frame until then.
+ * @param timeNanos The simulated time.
+ */
+void Simulator::AdvanceTo(int64_t timeNanos) {
+    while (true) {
+        bool input = !inputs.empty() && inputs.front().timeNanos <= nextFrameNanos;
+        int64_t next = input ? inputs.front().timeNanos : nextFrameNanos;
+        if (next > timeNanos) {
+            break;
+        }
+        nowNanos = next;
+        if (input) {
+            ActuatorCommand command = inputs.front().command;
+            inputs.pop_front();
+            Apply(command);
+        } else {
+            Frame();
+            nextFrameNanos += config.framePeriodNanos;
+        }
+    }
+    nowNanos = std::max(nowNanos, timeNanos);
+}
+
+/**
+ * Sends a command to the game. It takes effect after the input latency.
+ * @param command The command, in game positions.
+ */
+void Simulator::Send(const ActuatorCommand &command) {
+    inputs.push_back({nowNanos + config.inputLatencyNanos, command});
+}
+
+/**
+ * Returns the current simulated time.
+ * @return The time in nanoseconds.
+ */
+int64_t Simulator::GetNowNanos() const {
+    return nowNanos;
+}
+
+/**
+ * Returns the time of the next thing the game does on its own: a frame, or input taking effect.
+ * @return The simulated time in nanoseconds.
+ */
+int64_t Simulator::GetNextEventNanos() const {
+    return inputs.empty() ? nextFrameNanos : std::min(nextFrameNanos, inputs.front().timeNanos);
+}
+
+/**
+ * Returns what happened in the game so far.
+ * @return The counts.
+ */
+const SimulatorStats &Simulator::GetStats() const {
+    return stats;
+}
+
+/**
+ * Returns the ingredients the conveyor brings in this game.
+ * @return The ingredient ids.
+ */
+const std::vector<int> &Simulator::GetMenu() const {
+    return menu;
+}
+
+/**
+ * Returns the simulated time of the attached simulator; this is the clock of ChangeSignal while one is attached.
+ * @return The time in nanoseconds.
+ */
+int64_t Simulator::NowNanos() {
+    return attachedSimulator != nullptr ? attachedSimulator->nowNanos : START_NANOS;
+}
+
+/**
+ * @internal
+ * Draws the ingredients of the level from the conveyor items of the catalog, with at least one base. A bottom bun
+ * comes with a top bun.
+ */
+void Simulator::ChooseMenu() {
+    std::vector<int> candidates;
+    for (int id = 0; id < ItemManager::GetNumItems(); id++) {
+        if (ItemManager::GetItemData(id).type == ItemType::Conveyor && ItemManager::IngredientLimit(id) != 0) {
+            candidates.push_back(id);
+        }
+    }
+    std::shuffle(candidates.begin(), candidates.end(), rng);
+    menu.assign(candidates.begin(), candidates.begin() + std::min<size_t>(config.menuSize, candidates.size()));
+    auto isBase = [](int id) {
+        return ItemManager::GetStackingLayer(id) == StackingLayer::Base;
+    };
+    if (!menu.empty() && std::none_of(menu.begin(), menu.end(), isBase)) {
+        auto base = std::find_if(candidates.begin(), candidates.end(), isBase);
+        if (base != candidates.end()) {
+            menu.back() = *base;
+        }
+    }
+    bool hasBottomBun = std::find(menu.begin(), menu.end(), BOTTOM_BUN) != menu.end();
+    if (hasBottomBun && std::find(menu.begin(), menu.end(), TOP_BUN) == menu.end()) {
+        menu.push_back(TOP_BUN);
+    }
+    menuBases.clear();
+    menuFillings.clear();
+    for (int id: menu) {
+        StackingLayer layer = ItemManager::GetStackingLayer(id);
+        if (layer == StackingLayer::Base) {
+            menuBases.push_back(id);
+        } else if (layer == StackingLayer::Filling) {
+            menuFillings.push_back(id);
+        }
+    }
+}
+
+/**
+ * @internal
+ * Plays a frame: customers arrive and leave, the conveyor moves and brings a new item, and the frame breakpoint fires.
+ */
+void Simulator::Frame() {
+    frame++;
+    stats.frames++;
+    for (Slot &slot: slots) {
+        if (slot.occupied) {
+            if (frame >= slot.customer.leaveFrame) {
+                Leave(slot);
+            }
+        } else if (frame >= slot.nextArrival) {
+            Arrive(slot);
+        }
+    }
+    for (BeltItem &item: belt) {
+        item.x += config.conveyorSpeed;
+        WritePosition(item.address, item.x, config.conveyorY);
+    }
+    while (!belt.empty() && belt.front().x > config.conveyorEndX) {
+        Hit(BreakpointId::RemoveFromConveyor, belt.front().address);
+        Free(belt.front().address);
+        belt.erase(belt.begin());
+        stats.itemsDropped++;
+    }
+    if (frame % config.spawnFrames == 0) {
+        Spawn();
+    }
+    int conveyorSize = belt.size();
+    memcpy(At(CONVEYOR_OBJECT + BreakpointHandlers::CONVEYOR_SIZE_OFFSET, sizeof(int)), &conveyorSize, sizeof(int));
+    Hit(BreakpointId::ConveyorSize, CONVEYOR_OBJECT);
+    Hit(BreakpointId::BBPercent, BB_PERCENT);
+}
+
+/**
+ * @internal
+ * Puts a new item at the start of the conveyor. Most items are ones an open order needs, like the game does.
+ */
+void Simulator::Spawn() {
+    static std::vector<int> needed;
+    needed.clear();
+    for (const Slot &slot: slots) {
+        for (size_t o = 0; slot.occupied && o < slot.customer.orders.size(); o++) {
+            const Order &order = slot.customer.orders[o];
+            if (!order.complete) {
+                needed.insert(needed.end(), order.ingredients.begin(), order.ingredients.end());
+            }
+        }
+    }
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    int ingredient;
+    if (!needed.empty() && chance(rng) < config.demandShare) {
+        ingredient = needed[std::uniform_int_distribution<size_t>(0, needed.size() - 1)(rng)];
+    } else {
+        ingredient = menu[std::uniform_int_distribution<size_t>(0, menu.size() - 1)(rng)];
+    }
+    DWORD address = WriteSimpleItem(ingredient, 0.0f, config.conveyorY, nextConveyorIndex);
+    if (address == 0) {
+        return;
+    }
+    nextConveyorIndex++;
+    belt.push_back({address, ingredient, 0.0f});
+    stats.itemsSpawned++;
+    Hit(BreakpointId::AddToConveyor, address);
+}
+
+/**
+ * @internal
+ * Seats a new customer with one or more orders.
+ * @param slot The empty slot.
+ */
+void Simulator::Arrive(Slot &slot) {
+    DWORD address = AllocateCustomer();
+    if (address == 0) {
+        return;
+    }
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    std::uniform_int_distribution<int> numOrders(1, std::min(std::max(config.maxOrders, 1), MAX_CUSTOMER_ORDERS));
+    std::uniform_int_distribution<int> numFillings(1, std::max(config.maxFillings, 1));
+    std::uniform_int_distribution<size_t> base(0, menuBases.size() - 1);
+    std::uniform_int_distribution<size_t> filling(0, menuFillings.size() - 1);
+    bool hasTopBun = std::find(menu.begin(), menu.end(), TOP_BUN) != menu.end();
+    SimCustomer &customer = slot.customer;
+    customer.address = address;
+    customer.served = false;
+    customer.orders.clear();
+    for (int o = numOrders(rng); o > 0; o--) {
+        Order order;
+        order.complete = false;
+        if (chance(rng) < config.singleItemShare) {
+            order.ingredients.push_back(menuFillings[filling(rng)]);
+        } else {
+            int bottom = menuBases[base(rng)];
+            order.ingredients.push_back(bottom);
+            for (int f = numFillings(rng); f > 0; f--) {
+                int ingredient = menuFillings[filling(rng)];
+                bool limited = ItemManager::IngredientLimit(ingredient) == 1;
+                if (!limited || std::find(order.ingredients.begin(), order.ingredients.end(), ingredient) ==
+                                order.ingredients.end()) {
+                    order.ingredients.push_back(ingredient);
+                }
+            }
+            if (bottom == BOTTOM_BUN && hasTopBun) {
+                order.ingredients.push_back(TOP_BUN);
+            }
+        }
+        if (WriteRecipe(order)) {
+            customer.orders.push_back(std::move(order));
+        }
+    }
+    int id = nextCustomerId++;
+    DWORD vtable = COMPLEX_VTABLE;
+    memcpy(At(address + CUSTOMER_ID, sizeof(int)), &id, sizeof(int));
+    WriteOrders(customer);
+    memcpy(At(address, sizeof(DWORD)), &vtable, sizeof(DWORD));
+    std::uniform_int_distribution<int> patience(-20, 20);
+    customer.leaveFrame = frame + config.patienceFrames + (int64_t) config.patienceFrames * patience(rng) / 100;
+    slot.occupied = true;
+    stats.customersArrived++;
+    Hit(BreakpointId::AddCustomer, address);
+}
+
+/**
+ * @internal
+ * Lets a customer walk off, served or not. The bot notices when the customer object is no longer valid.
+ * @param slot The slot of the customer.
+ */
+void Simulator::Leave(Slot &slot) {
+    SimCustomer &customer = slot.customer;
+    if (customer.served) {
+        stats.customersServed++;
+    } else {
+        stats.customersLost++;
+    }
+    for (const Order &order: customer.orders) {
+        for (DWORD object: order.objects) {
+            Free(object);
+        }
+    }
+    Free(customer.address);
+    customer.orders.clear();
+    slot.occupied = false;
+    std::uniform_int_distribution<int> gap(config.arrivalFrames / 2, config.arrivalFrames * 3 / 2);
+    slot.nextArrival = frame + gap(rng);
+}
+
+/**
+ * @internal
+ * Carries out a command that reached the game.
+ * @param command The command.
+ */
+void Simulator::Apply(const ActuatorCommand &command) {
+    if (command.type == ActuatorCommandType::Click) {
+        stats.clicks++;
+        Click((float) command.x, (float) command.y);
+    } else if (command.type == ActuatorCommandType::RightClick) {
+        Deliver();
+    }
+}
+
+/**
+ * @internal
+ * Clicks a game position: the trash throws away the tray, a conveyor item goes onto the tray if it fits the stack.
+ * @param x The x coordinate.
+ * @param y The y coordinate.
+ */
+void Simulator::Click(float x, float y) {
+    float dx = x - TRASH_X;
+    float dy = y - TRASH_Y;
+    if (dx * dx + dy * dy <= TRASH_RADIUS * TRASH_RADIUS) {
+        if (!tray.empty()) {
+            stats.discards++;
+            ClearTray();
+        }
+        return;
+    }
+    int best = -1;
+    float bestDistance = config.clickRadius * config.clickRadius;
+    for (size_t i = 0; i < belt.size(); i++) {
+        dx = x - belt[i].x;
+        dy = y - config.conveyorY;
+        if (dx * dx + dy * dy <= bestDistance) {
+            bestDistance = dx * dx + dy * dy;
+            best = i;
+        }
+    }
+    if (best == -1) {
+        stats.missedClicks++;
+        return;
+    }
+    if (!TrayAccepts(belt[best].ingredient)) {
+        stats.rejectedClicks++;
+        return;
+    }
+    tray.push_back(belt[best].address);
+    trayIngredients.push_back(belt[best].ingredient);
+    Hit(BreakpointId::RemoveFromConveyor, belt[best].address);
+    belt.erase(belt.begin() + best);
+}
+
+/**
+ * @internal
+ * Hands the tray to the first customer with an open order of exactly the ingredients on it. A tray no order matches
+ * stays as it is.
+ */
+void Simulator::Deliver() {
+    if (tray.empty()) {
+        return;
+    }
+    std::vector<int> onTray = trayIngredients;
+    std::sort(onTray.begin(), onTray.end());
+    for (Slot &slot: slots) {
+        if (!slot.occupied || slot.customer.served) {
+            continue;
+        }
+        SimCustomer &customer = slot.customer;
+        for (Order &order: customer.orders) {
+            if (order.complete || order.ingredients.size() != onTray.size()) {
+                continue;
+            }
+            std::vector<int> wanted = order.ingredients;
+            std::sort(wanted.begin(), wanted.end());
+            if (wanted != onTray) {
+                continue;
+            }
+            order.complete = true;
+            stats.ordersServed++;
+            customer.served = std::all_of(customer.orders.begin(), customer.orders.end(), [](const Order &o) {
+                return o.complete;
+            });
+            if (customer.served) {
+                customer.leaveFrame = frame + SERVED_FRAMES;
+            }
+            WriteOrders(customer);
+            ClearTray();
+            return;
+        }
+    }
+    stats.wrongDeliveries++;
+}
+
+/**
+ * @internal
+ * Empties the tray, freeing its items.
+ */
+void Simulator::ClearTray() {
+    for (DWORD address: tray) {
+        Free(address);
+    }
+    tray.clear();
+    trayIngredients.clear();
+}
+
+/**
+ * @internal
+ * Returns whether an ingredient can go onto the tray: a base only at the bottom, and nothing on top of a top.
+ * @param ingredient The ingredient id.
+ * @return Whether the tray takes the ingredient.
+ */
+bool Simulator::TrayAccepts(int ingredient) const {
+    if (tray.size() >= MAX_TRAY_ITEMS) {
+        return false;
+    }
+    if (!trayIngredients.empty() && ItemManager::GetStackingLayer(trayIngredients.back()) == StackingLayer::Top) {
+        return false;
+    }
+    return tray.empty() || ItemManager::GetStackingLayer(ingredient) != StackingLayer::Base;
+}
+
+/**
+ * @internal
+ * Finds a free item slot, going round the heap so that freed addresses are not reused right away.
+ * @return The zeroed slot, or 0 if the heap is full.
+ */
+DWORD Simulator::AllocateItem() {
+    for (DWORD i = 0; i < NUM_ITEM_SLOTS; i++) {
+        DWORD address = ITEM_BASE + ((nextItemSlot + i) % NUM_ITEM_SLOTS) * ITEM_SLOT_SIZE;
+        BYTE *slot = At(address, ITEM_SLOT_SIZE);
+        DWORD vtable;
+        memcpy(&vtable, slot, sizeof(DWORD));
+        if (vtable == 0) {
+            nextItemSlot = (nextItemSlot + i + 1) % NUM_ITEM_SLOTS;
+            memset(slot, 0, ITEM_SLOT_SIZE);
+            return address;
+        }
+    }
+    std::cout << "Error: The simulated item heap is full." << std::endl;
+    return 0;
+}
+
+/**
+ * @internal
+ * Finds a free customer slot, going round the heap so that freed addresses are not reused right away.
+ * @return The zeroed slot, or 0 if the heap is full.
+ */
+DWORD Simulator::AllocateCustomer() {
+    for (DWORD i = 0; i < NUM_CUSTOMER_SLOTS; i++) {
+        DWORD address = CUSTOMER_BASE + ((nextCustomerSlot + i) % NUM_CUSTOMER_SLOTS) * CUSTOMER_SLOT_SIZE;
+        BYTE *slot = At(address, CUSTOMER_SLOT_SIZE);
+        DWORD vtable;
+        memcpy(&vtable, slot, sizeof(DWORD));
+        if (vtable == 0) {
+            nextCustomerSlot = (nextCustomerSlot + i + 1) % NUM_CUSTOMER_SLOTS;
+            memset(slot, 0, CUSTOMER_SLOT_SIZE);
+            return address;
+        }
+    }
+    std::cout << "Error: The simulated customer heap is full." << std::endl;
+    return 0;
+}
+
+/**
+ * @internal
+ * Writes a simple item.
+ * @param ingredient The ingredient id.
+ * @param x The x coordinate.
+ * @param y The y coordinate.
+ * @param conveyorIndex The position in the order the conveyor brought its items, or -1.
+ * @return The address of the item, or 0 if the heap is full.
+ */
+DWORD Simulator::WriteSimpleItem(int ingredient, float x, float y, int conveyorIndex) {
+    DWORD address = AllocateItem();
+    if (address == 0) {
+        return 0;
+    }
+    BYTE *item = At(address, ITEM_SLOT_SIZE);
+    DWORD vtable = SIMPLE_VTABLE;
+    int terminator = 0;
+    memcpy(item + ITEM_ID, &ingredient, sizeof(int));
+    memcpy(item + ITEM_INGREDIENT, &ingredient, sizeof(int));
+    memcpy(item + ITEM_CONVEYOR_INDEX, &conveyorIndex, sizeof(int));
+    memcpy(item + ITEM_TERMINATOR, &terminator, sizeof(int));
+    memcpy(item, &vtable, sizeof(DWORD));
+    WritePosition(address, x, y);
+    return address;
+}
+
+/**
+ * @internal
+ * Writes the recipe of an order: a simple item for a single ingredient, a complex item with its sub-items otherwise.
+ * @param order (in, out) The order. Its objects are filled in.
+ * @return Whether the recipe could be written.
+ */
+bool Simulator::WriteRecipe(Order &order) {
+    order.objects.clear();
+    if (order.ingredients.size() == 1) {
+        DWORD address = WriteSimpleItem(order.ingredients[0], 0.0f, 0.0f, -1);
+        if (address != 0) {
+            order.objects.push_back(address);
+        }
+        return address != 0;
+    }
+    DWORD address = AllocateItem();
+    if (address == 0) {
+        return false;
+    }
+    // Holds the slot until the recipe is complete, so its sub-items do not take it
+    DWORD vtable = COMPLEX_VTABLE;
+    memcpy(At(address, sizeof(DWORD)), &vtable, sizeof(DWORD));
+    order.objects.push_back(address);
+    for (int ingredient: order.ingredients) {
+        DWORD subItem = WriteSimpleItem(ingredient, 0.0f, 0.0f, -1);
+        if (subItem == 0) {
+            for (DWORD object: order.objects) {
+                Free(object);
+            }
+            order.objects.clear();
+            return false;
+        }
+        order.objects.push_back(subItem);
+    }
+    BYTE *recipe = At(address, ITEM_SLOT_SIZE);
+    int count = order.ingredients.size();
+    int conveyorIndex = -1;
+    DWORD list = address + COMPLEX_LIST_DATA;
+    memcpy(recipe + ITEM_CONVEYOR_INDEX, &conveyorIndex, sizeof(int));
+    memcpy(recipe + COMPLEX_COUNT, &count, sizeof(int));
+    memcpy(recipe + COMPLEX_LIST, &list, sizeof(DWORD));
+    memcpy(recipe + COMPLEX_LIST_DATA, order.objects.data() + 1, count * sizeof(DWORD));
+    return true;
+}
+
+/**
+ * @internal
+ * Writes the order vector of a customer, with the completed orders marked.
+ * @param customer The customer.
+ */
+void Simulator::WriteOrders(const SimCustomer &customer) {
+    BYTE *entries = At(customer.address + CUSTOMER_ORDER_DATA, customer.orders.size() * sizeof(ItemInfo));
+    for (size_t o = 0; o < customer.orders.size(); o++) {
+        ItemInfo info;
+        info.mNumCopies = 1;
+        info.mNumComplete = customer.orders[o].complete ? 1 : 0;
+        info.mItem = customer.orders[o].objects[0];
+        memcpy(entries + o * sizeof(ItemInfo), &info, sizeof(ItemInfo));
+    }
+    DWORD bounds[2] = {customer.address + CUSTOMER_ORDER_DATA,
+                       (DWORD) (customer.address + CUSTOMER_ORDER_DATA + customer.orders.size() * sizeof(ItemInfo))};
+    memcpy(At(customer.address + CUSTOMER_ORDERS, sizeof(bounds)), bounds, sizeof(bounds));
+}
+
+/**
+ * @internal
+ * Hits a breakpoint of the game, and runs its handler on the simulator's thread.
+ * @param id The breakpoint.
+ * @param object What the breakpoint passes: the item for the conveyor list breakpoints, which pass it in a list node,
+ * the customer, the conveyor, or the BB percentage.
+ */
+void Simulator::Hit(BreakpointId id, DWORD object) {
+    BreakpointEvent event = {id, 0, 0, 0, 0, 0, 0, (uint64_t) nowNanos};
+    Node node = {0, 0, object};
+    switch (id) {
+        case BreakpointId::BBPercent:
+            event.ecx = object;
+            break;
+        case BreakpointId::ConveyorSize:
+            event.edi = object;
+            break;
+        case BreakpointId::AddToConveyor:
+            memcpy(At(CONVEYOR_NODE, sizeof(Node)), &node, sizeof(Node));
+            event.eax = CONVEYOR_NODE;
+            break;
+        case BreakpointId::RemoveFromConveyor:
+            memcpy(At(CONVEYOR_NODE, sizeof(Node)), &node, sizeof(Node));
+            event.esi = CONVEYOR_NODE;
+            break;
+        case BreakpointId::AddCustomer:
+            event.ebx = object;
+            break;
+        default:
+            break;
+    }
+    BreakpointHandlers::Dispatch(event, GameState::GetDirectMemory());
+}
+
+/**
+ * @internal
+ * Writes the position of an item.
+ * @param address The address of the item.
+ * @param x The x coordinate.
+ * @param y The y coordinate.
+ */
+void Simulator::WritePosition(DWORD address, float x, float y) {
+    BYTE *item = At(address, ITEM_SLOT_SIZE);
+    memcpy(item + ITEM_X, &x, sizeof(float));
+    memcpy(item + ITEM_Y, &y, sizeof(float));
+}
+
+/**
+ * @internal
+ * Frees an object. Its vtable is cleared, so the bot no longer takes it for an item or a customer.
+ * @param address The address of the object.
+ */
+void Simulator::Free(DWORD address) {
+    DWORD vtable = 0;
+    memcpy(At(address, sizeof(DWORD)), &vtable, sizeof(DWORD));
+}
+
+/**
+ * @internal
+ * Returns the local memory of an address range of the image. Ranges of the simulator's own objects are always mapped.
+ * @param address The address.
+ * @param size The size of the range.
+ * @return The local memory.
+ */
+BYTE *Simulator::At(DWORD address, SIZE_T size) {
+    return image->Translate(address, size);
+}
+
+/**
+ * Stops the actuator before it goes away.
+ */
+SimulatorActuator::~SimulatorActuator() {
+    Stop();
+}
+
+/**
+ * Hands a batch to the simulator.
+ * @param commands The commands.
+ * @param count The number of commands.
+ * @return @c true.
+ */
+bool SimulatorActuator::SendBatch(const ActuatorCommand *commands, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        simulator.Send(commands[i]);
+    }
+    return true;
+}
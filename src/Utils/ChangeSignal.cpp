@@ -0,0 +1,82 @@
+#include <ChangeSignal.h>
+#include <chrono>
+
+std::atomic<int64_t (*)()> ChangeSignal::clock{nullptr};
+
+/**
+ * Advances the version and wakes every waiting thread.
+ * @return The new version.
+ */
+uint64_t ChangeSignal::Notify() {
+    changeNanos.store(NowNanos());
+    uint64_t newVersion;
+    {
+        // Taking the lock orders the change before a waiter's check, so the wakeup cannot be lost
+        std::lock_guard<std::mutex> lock(mutex);
+        newVersion = version.fetch_add(1) + 1;
+    }
+    condition.notify_all();
+    return newVersion;
+}
+
+/**
+ * Returns the current version.
+ * @return The version.
+ */
+uint64_t ChangeSignal::GetVersion() const {
+    return version.load();
+}
+
+/**
+ * Returns the time of the most recent change.
+ * @return The time in nanoseconds, or 0 if nothing has changed yet.
+ */
+int64_t ChangeSignal::GetChangeNanos() const {
+    return changeNanos.load();
+}
+
+/**
+ * Blocks until the version differs from a seen one, or until a deadline.
+ * @param seenVersion The last version the caller has seen.
+ * @param deadlineNanos The time to stop waiting at.
+ * @return The current version, which equals seenVersion if the deadline passed without a change.
+ */
+uint64_t ChangeSignal::Wait(uint64_t seenVersion, int64_t deadlineNanos) {
+    std::chrono::steady_clock::time_point deadline{std::chrono::nanoseconds(deadlineNanos)};
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait_until(lock, deadline, [this, seenVersion]() {
+        return version.load() != seenVersion;
+    });
+    return version.load();
+}
+
+/**
+ * Returns the current steady clock time, or the time of the clock that replaced it.
+ * @return The time in nanoseconds.
+ */
+int64_t ChangeSignal::NowNanos() {
+    int64_t (*replacement)() = clock.load();
+    if (replacement != nullptr) {
+        return replacement();
+    }
+    return SteadyNanos();
+}
+
+/**
+ * Returns the current steady clock time, which keeps running while a simulation replaces the clock, e.g. to measure
+ * how long a simulation takes.
+ * @return The time in nanoseconds.
+ */
+int64_t ChangeSignal::SteadyNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Replaces the steady clock, e.g. with the virtual time of a simulation. Waits still end at steady clock deadlines, so
+ * a replaced clock is only for code that does not block.
+ * @param replacement The clock, or @c nullptr to go back to the steady clock.
+ */
+void ChangeSignal::SetClock(int64_t (*replacement)()) {
+    clock = replacement;
+}
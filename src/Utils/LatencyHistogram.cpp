@@ -0,0 +1,114 @@
+#include <LatencyHistogram.h>
+#include <iomanip>
+
+LatencyHistogram::LatencyHistogram() {
+    Reset();
+}
+
+/**
+ * Records a duration.
+ * @param nanos The duration in nanoseconds.
+ */
+void LatencyHistogram::Record(uint64_t nanos) {
+    uint64_t micros = nanos / 1000;
+    int bucket = 0;
+    while (micros != 0 && bucket < NUM_BUCKETS - 1) {
+        micros >>= 1;
+        bucket++;
+    }
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    totalNanos.fetch_add(nanos, std::memory_order_relaxed);
+    uint64_t max = maxNanos.load(std::memory_order_relaxed);
+    while (nanos > max && !maxNanos.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * Returns the number of recorded durations.
+ * @return The number of durations.
+ */
+uint64_t LatencyHistogram::GetCount() const {
+    return count.load(std::memory_order_relaxed);
+}
+
+/**
+ * Returns the number of durations recorded in a bucket.
+ * @param bucket The bucket, between 0 and NUM_BUCKETS - 1.
+ * @return The number of durations.
+ */
+uint64_t LatencyHistogram::GetBucket(int bucket) const {
+    return buckets[bucket].load(std::memory_order_relaxed);
+}
+
+/**
+ * Returns the longest recorded duration.
+ * @return The duration in nanoseconds.
+ */
+uint64_t LatencyHistogram::GetMaxNanos() const {
+    return maxNanos.load(std::memory_order_relaxed);
+}
+
+/**
+ * Returns the mean of the recorded durations.
+ * @return The duration in nanoseconds, or 0 if nothing was recorded.
+ */
+uint64_t LatencyHistogram::GetMeanNanos() const {
+    uint64_t n = GetCount();
+    return n == 0 ? 0 : totalNanos.load(std::memory_order_relaxed) / n;
+}
+
+/**
+ * Returns an upper bound of a percentile of the recorded durations.
+ * @param fraction The percentile as a fraction, e.g. 0.99 for p99.
+ * @return The upper edge of the bucket containing the percentile, capped at the maximum, in nanoseconds.
+ */
+uint64_t LatencyHistogram::GetPercentileNanos(double fraction) const {
+    uint64_t n = GetCount();
+    if (n == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(fraction * n);
+    if (rank >= n) {
+        rank = n - 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        seen += GetBucket(i);
+        if (seen > rank) {
+            uint64_t upper = (1ULL << i) * 1000;
+            return upper < GetMaxNanos() ? upper : GetMaxNanos();
+        }
+    }
+    return GetMaxNanos();
+}
+
+/**
+ * Prints a summary line and the non-empty buckets.
+ * @param out The stream to print to.
+ * @param name The name of the measured duration.
+ */
+void LatencyHistogram::Print(std::ostream &out, const std::string &name) const {
+    out << name << ": n=" << GetCount() << " mean=" << GetMeanNanos() / 1000 << "us p50<="
+        << GetPercentileNanos(0.5) / 1000 << "us p99<=" << GetPercentileNanos(0.99) / 1000 << "us max="
+        << GetMaxNanos() / 1000 << "us" << std::endl;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        uint64_t n = GetBucket(i);
+        if (n == 0) {
+            continue;
+        }
+        out << "  < " << std::setw(10) << (1ULL << i) << "us: " << n << std::endl;
+    }
+}
+
+/**
+ * Clears all recorded durations.
+ */
+void LatencyHistogram::Reset() {
+    for (std::atomic<uint64_t> &bucket: buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    totalNanos.store(0, std::memory_order_relaxed);
+    maxNanos.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,191 @@
+#include <TickClock.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// The weights of a new observation in the moving averages of the period and the jitter, as reciprocals
+static const int64_t PERIOD_WEIGHT = 8;
+static const int64_t JITTER_WEIGHT = 16;
+// The share of a frame's prediction error that corrects the phase, as a reciprocal
+static const int64_t PHASE_WEIGHT = 4;
+
+/**
+ * Records a frame of the game.
+ * Hits closer together than a quarter of the frame period belong to the same frame and are ignored.
+ * @param timestampNanos The steady clock time of the frame.
+ * @return Whether the bot should act on this frame.
+ */
+bool TickClock::OnFrame(int64_t timestampNanos) {
+    int64_t last = lastFrameNanos.load();
+    int64_t period = periodNanos.load();
+    int64_t interval = timestampNanos - last;
+    if (last != 0 && interval < period / 4) {
+        return false;
+    }
+    frameCount.fetch_add(1);
+    lastFrameNanos = timestampNanos;
+    if (last == 0 || interval > STALL_NANOS) {
+        if (last != 0) {
+            stallCount.fetch_add(1);
+        }
+        nextFrameNanos = timestampNanos + period;
+    } else {
+        frameIntervals.Record(interval);
+        // A gap of several periods means breakpoint hits were missed, unless every gap is like that: then the game
+        // slowed down
+        int64_t frames = std::max<int64_t>(std::llround((double) interval / period), 1);
+        if (frames > 1 && ++gapRun <= MAX_COASTED_FRAMES) {
+            missedFrameCount.fetch_add(frames - 1);
+        } else {
+            if (frames == 1) {
+                gapRun = 0;
+            }
+            frames = 1;
+        }
+        int64_t frameInterval = interval / frames;
+        period += (frameInterval - period) / PERIOD_WEIGHT;
+        int64_t jitter = jitterNanos.load();
+        jitterNanos = jitter + (std::llabs(frameInterval - period) - jitter) / JITTER_WEIGHT;
+        periodNanos = period;
+        // The prediction was for this frame; one further off than half a period was for another frame
+        int64_t next = nextFrameNanos.load();
+        int64_t error = timestampNanos - next;
+        if (std::llabs(error) > period / 2) {
+            nextFrameNanos = timestampNanos + period;
+        } else {
+            nextFrameNanos = next + period + error / PHASE_WEIGHT;
+        }
+    }
+    actCredit += actFraction.load();
+    if (actCredit < 1.0) {
+        return false;
+    }
+    actCredit -= 1.0;
+    tickCount.fetch_add(1);
+    return true;
+}
+
+/**
+ * Sets the share of the frames the bot acts on, e.g. 0.5 for every other frame.
+ * @param fraction The share, between 0 exclusive and 1 inclusive.
+ */
+void TickClock::SetActFraction(double fraction) {
+    actFraction = std::min(std::max(fraction, 0.01), 1.0);
+}
+
+/**
+ * Returns how long to wait for the next frame before acting without it.
+ * While frames arrive, this is half a period after the next predicted frame, so a missed breakpoint hit is stood in
+ * for without getting ahead of the real one. Once the game has stalled, or before any frame was seen, the waits are
+ * long or the default cadence respectively.
+ * @param nowNanos The current steady clock time.
+ * @return The steady clock time to stop waiting at.
+ */
+int64_t TickClock::GetDeadlineNanos(int64_t nowNanos) const {
+    int64_t last = lastFrameNanos.load();
+    if (last == 0) {
+        return nowNanos + DEFAULT_PERIOD_NANOS;
+    }
+    int64_t period = periodNanos.load();
+    if (nowNanos - last > MAX_COASTED_FRAMES * period) {
+        return nowNanos + STALL_NANOS;
+    }
+    int64_t next = nextFrameNanos.load();
+    while (next <= nowNanos) {
+        next += period;
+    }
+    return next + period / 2;
+}
+
+/**
+ * Returns the predicted time of the next frame.
+ * @return The steady clock time, or 0 if no frame was seen yet.
+ */
+int64_t TickClock::GetNextFrameNanos() const {
+    return lastFrameNanos.load() == 0 ? 0 : nextFrameNanos.load();
+}
+
+/**
+ * Returns the measured frame period.
+ * @return The period in nanoseconds.
+ */
+int64_t TickClock::GetFramePeriodNanos() const {
+    return periodNanos.load();
+}
+
+/**
+ * Returns the measured jitter, the average deviation of frame intervals from the period.
+ * @return The jitter in nanoseconds.
+ */
+int64_t TickClock::GetJitterNanos() const {
+    return jitterNanos.load();
+}
+
+/**
+ * Returns the number of frames seen.
+ * @return The number of frames.
+ */
+uint64_t TickClock::GetFrameCount() const {
+    return frameCount.load();
+}
+
+/**
+ * Returns the number of frames the bot was told to act on.
+ * @return The number of frames.
+ */
+uint64_t TickClock::GetTickCount() const {
+    return tickCount.load();
+}
+
+/**
+ * Returns the number of frames whose breakpoint hit was missed, judged by the gaps between the seen ones.
+ * @return The number of frames.
+ */
+uint64_t TickClock::GetMissedFrameCount() const {
+    return missedFrameCount.load();
+}
+
+/**
+ * Returns the number of times the game stalled.
+ * @return The number of stalls.
+ */
+uint64_t TickClock::GetStallCount() const {
+    return stallCount.load();
+}
+
+/**
+ * Returns the distribution of the intervals between frames, stalls excluded.
+ * @return The histogram.
+ */
+const LatencyHistogram &TickClock::GetFrameIntervals() const {
+    return frameIntervals;
+}
+
+/**
+ * Prints the frame metrics.
+ * @param out The stream to print to.
+ */
+void TickClock::Print(std::ostream &out) const {
+    out << "Game frames: " << GetFrameCount() << " seen, " << GetMissedFrameCount() << " missed, " << GetStallCount()
+        << " stalls, " << GetTickCount() << " acted on. Period " << GetFramePeriodNanos() / 1000 << "us, jitter "
+        << GetJitterNanos() / 1000 << "us" << std::endl;
+    frameIntervals.Print(out, "Game frame interval");
+}
+
+/**
+ * Forgets the frames seen, e.g. when a simulated game starts over. The share of frames acted on is kept.
+ * @note Must not be called while OnFrame runs.
+ */
+void TickClock::Reset() {
+    lastFrameNanos = 0;
+    nextFrameNanos = 0;
+    periodNanos = DEFAULT_PERIOD_NANOS;
+    jitterNanos = 0;
+    frameCount = 0;
+    tickCount = 0;
+    missedFrameCount = 0;
+    stallCount = 0;
+    actCredit = 0.0;
+    gapRun = 0;
+    frameIntervals.Reset();
+}
@@ -9,6 +9,7 @@
 #include <string>
 #include <utility>
 #include <Utils.h>
+#include <TypeCache.h>
 
 /**
  * Get the base address of a module in a process.
@@ -104,34 +105,16 @@ bool Utils::WriteBufferToProcessMemory(HANDLE processHandle, DWORD address, LPCV
 
 /**
  * Check if a node is an item.
- * @param hProcess The process handle.
+ * @param memory The memory of the game process.
  * @param address The address of the node.
  * @param node The node.
  * @return @c true if the node is not an item. @c false if the node is an item.
  * @note This function is intended for determining sentinel nodes in doubly-linked lists of items.
  */
-bool Utils::IsNotItem(HANDLE hProcess, DWORD address, const Node &node) {
-    // 1. Try reading content. If it fails, we know it's not an item.
-    int value;
-    if (!ReadMemoryToBuffer(hProcess, node.content, &value, sizeof(value))) {
-        return true;
-    }
-    // 2. Try reading the value as a pointer. If it fails, we know it's not an item.
-    int pointer;
-    if (!ReadMemoryToBuffer(hProcess, value, &pointer, sizeof(pointer))) {
-        return true;
-    }
-    // 3. Try reading the pointer + 0x4 as pointer. If it fails or is not 1317794187 or 113766795, we know it's not an
-    // item.
-    int pointerToPointer;
-    if (!ReadMemoryToBuffer(hProcess, pointer + 0x4, &pointerToPointer, sizeof(pointerToPointer))) {
-        return true;
-    }
-    if (pointerToPointer != 1317794187 && pointerToPointer != 113766795) {
-        return true;
-    }
-    // Otherwise, it's an item.
-    return false;
+bool Utils::IsNotItem(ProcessMemory &memory, DWORD address, const Node &node) {
+    // The content is an item if its vtable classifies as a simple or complex item. Unreadable content is not an item.
+    ObjectKind kind = TypeCache::ClassifyObject(memory, node.content);
+    return kind != ObjectKind::Simple && kind != ObjectKind::Complex;
 }
 
 /**
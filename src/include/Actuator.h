@@ -0,0 +1,166 @@
+#ifndef BS3BOT_ACTUATOR_H
+#define BS3BOT_ACTUATOR_H
+
+#include <Platform.h>
+#include <LatencyHistogram.h>
+#include <RingBuffer.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum class ActuatorCommandType : uint8_t {
+    Move,
+    Click,
+    RightClick
+};
+
+/**
+ * A mouse action for the actuator.
+ */
+struct ActuatorCommand {
+    ActuatorCommandType type;
+    // Absolute screen coordinates. Right clicks happen wherever the cursor is.
+    int x;
+    int y;
+    // The conveyor item a click should take off the conveyor, or 0 if it is not expected to take one
+    DWORD item;
+    uint64_t sequence;
+    uint64_t submitNanos;
+};
+
+/**
+ * Sends mouse input to the game from its own thread.
+ * The planner submits commands without waiting for them; the actuator sends everything queued at once, so a click
+ * and the move before it reach the game in the same batch. Clicks that take a conveyor item are confirmed when the
+ * game removes that item, rather than by watching the cursor.
+ * Submit must only be called from one thread, the planner's. Subclasses must call Stop in their destructor.
+ */
+class Actuator {
+public:
+    static const size_t QUEUE_CAPACITY = 64;
+    // Clicks sent more than this many clicks ago without a confirmation are forgotten
+    static const size_t MAX_PENDING = 16;
+
+    virtual ~Actuator() = default;
+
+    void Start();
+
+    void Stop();
+
+    uint64_t Submit(ActuatorCommandType type, int x, int y, DWORD item = 0);
+
+    bool Confirm(DWORD item);
+
+    bool WaitIdle(int64_t timeoutNanos);
+
+    size_t Flush();
+
+    uint64_t GetSubmittedCount() const;
+
+    uint64_t GetSentCount() const;
+
+    uint64_t GetBatchCount() const;
+
+    uint64_t GetConfirmedCount() const;
+
+    uint64_t GetUnconfirmedCount() const;
+
+    int64_t GetLastSendLatencyNanos() const;
+
+    const LatencyHistogram &GetSendLatency() const;
+
+    const LatencyHistogram &GetConfirmLatency() const;
+
+protected:
+    /**
+     * Sends a batch of commands to the game.
+     * @param commands The commands, in submission order.
+     * @param count The number of commands.
+     * @return Whether every command was sent.
+     */
+    virtual bool SendBatch(const ActuatorCommand *commands, size_t count) = 0;
+
+private:
+    struct PendingClick {
+        DWORD item;
+        uint64_t sentNanos;
+    };
+
+    void WorkerThread();
+
+    RingBuffer<ActuatorCommand, QUEUE_CAPACITY> queue;
+    std::mutex signalMutex;
+    std::condition_variable signal;
+    std::condition_variable idleSignal;
+    bool running = false;
+    std::thread thread;
+
+    std::mutex pendingMutex;
+    std::vector<PendingClick> pending;
+
+    std::atomic<uint64_t> submittedCount{0};
+    std::atomic<uint64_t> sentCount{0};
+    std::atomic<uint64_t> batchCount{0};
+    std::atomic<uint64_t> confirmedCount{0};
+    std::atomic<uint64_t> unconfirmedCount{0};
+    std::atomic<int64_t> lastSendLatency{0};
+    LatencyHistogram sendLatency;
+    LatencyHistogram confirmLatency;
+};
+
+#ifdef _WIN32
+
+/**
+ * Sends the commands to the game window with @c SendInput, one call per batch.
+ */
+class Win32Actuator : public Actuator {
+public:
+    explicit Win32Actuator(HWND window) : window(window) {}
+
+    ~Win32Actuator() override;
+
+protected:
+    bool SendBatch(const ActuatorCommand *commands, size_t count) override;
+
+private:
+    HWND window;
+    std::vector<INPUT> inputs;
+};
+
+#endif
+
+/**
+ * Records the commands instead of sending them, so the actuator can be run and measured without a game.
+ */
+class RecordingActuator : public Actuator {
+public:
+    /**
+     * A recorded command and the time its batch was sent.
+     */
+    struct Record {
+        ActuatorCommand command;
+        uint64_t batch;
+        uint64_t sentNanos;
+    };
+
+    explicit RecordingActuator(int64_t batchNanos = 0) : batchNanos(batchNanos) {}
+
+    ~RecordingActuator() override;
+
+    std::vector<Record> GetRecords();
+
+protected:
+    bool SendBatch(const ActuatorCommand *commands, size_t count) override;
+
+private:
+    // Time each batch takes to send, to stand in for SendInput
+    int64_t batchNanos;
+    uint64_t batches = 0;
+    std::mutex recordsMutex;
+    std::vector<Record> records;
+};
+
+#endif //BS3BOT_ACTUATOR_H
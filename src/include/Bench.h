@@ -0,0 +1,28 @@
+#ifndef BS3BOT_BENCH_H
+#define BS3BOT_BENCH_H
+
+#include <Platform.h>
+#include <cstdint>
+#include <vector>
+
+/*
+ * What the benchmarks share. Linked into the benchmarks only, not into the bot.
+ */
+
+// The simulated time the benchmarks that measure the planner playing let it play
+const int64_t PLAY_NANOS = 2LL * 60 * 1000000000;
+
+/**
+ * The position of one conveyor item in one snapshot of a recorded trace.
+ * A trace file has one point per line, "timeNanos,address,x,y", with the address in decimal or 0x-hex.
+ */
+struct TracePoint {
+    int64_t timeNanos;
+    DWORD address;
+    float x;
+    float y;
+};
+
+bool LoadTrace(const char *path, std::vector<TracePoint> &trace);
+
+#endif //BS3BOT_BENCH_H
@@ -0,0 +1,35 @@
+#ifndef BS3BOT_BREAKPOINTEVENT_H
+#define BS3BOT_BREAKPOINTEVENT_H
+
+#include <Platform.h>
+#include <cstdint>
+
+/**
+ * The breakpoints the bot sets in the game. Each one has a fixed handler.
+ */
+enum class BreakpointId : uint32_t {
+    BBPercent,
+    ConveyorSize,
+    AddToConveyor,
+    RemoveFromConveyor,
+    AddCustomer,
+    Reset,
+    Count
+};
+
+/**
+ * A breakpoint hit, with the registers its handler needs captured while the game thread was suspended.
+ */
+struct BreakpointEvent {
+    BreakpointId id;
+    DWORD threadId;
+    DWORD eax;
+    DWORD ebx;
+    DWORD ecx;
+    DWORD esi;
+    DWORD edi;
+    // Steady clock time of the hit, in nanoseconds
+    uint64_t timestamp;
+};
+
+#endif //BS3BOT_BREAKPOINTEVENT_H
@@ -0,0 +1,35 @@
+#ifndef BS3BOT_BREAKPOINTHANDLERS_H
+#define BS3BOT_BREAKPOINTHANDLERS_H
+
+#include <Platform.h>
+#include <BreakpointEvent.h>
+#include <ProcessMemory.h>
+
+/**
+ * A node of the game's linked lists.
+ */
+struct Node {
+public:
+    DWORD prev;
+    DWORD next;
+    DWORD content;
+};
+
+/**
+ * A breakpoint handler. Runs on the worker thread, after the game thread has resumed.
+ */
+typedef void (*BreakpointHandler)(const BreakpointEvent &event, ProcessMemory &memory);
+
+/**
+ * Turns breakpoint events into GameState updates, reading what the registers point to from the game's memory.
+ * The debugger, the simulator and the replay of a recording all dispatch their events here.
+ */
+class BreakpointHandlers {
+public:
+    // The offset of the item count in the conveyor object
+    static const DWORD CONVEYOR_SIZE_OFFSET = 0x10C;
+
+    static void Dispatch(const BreakpointEvent &event, ProcessMemory &memory);
+};
+
+#endif //BS3BOT_BREAKPOINTHANDLERS_H
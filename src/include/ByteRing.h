@@ -0,0 +1,98 @@
+#ifndef BS3BOT_BYTERING_H
+#define BS3BOT_BYTERING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * A bounded single-producer single-consumer queue of variable-size entries, written and read in place.
+ * The producer reserves space for an entry, writes it and commits it; the consumer looks at the committed bytes and
+ * releases what it has read. The queue does not frame entries, so they must tell their own size.
+ * An entry is always contiguous: one that would wrap around the end continues into spare bytes past the end instead,
+ * and the bytes it covers at the start are skipped.
+ * Like RingBuffer, neither side allocates or locks, and each side only writes its own index.
+ */
+class ByteRing {
+public:
+    /**
+     * Allocates the queue. The bytes are zeroed, so the system maps every page of it now rather than on the producer's
+     * first pass through it.
+     * @param capacity The number of bytes queued at most. Must be a power of two.
+     * @param maxEntrySize The size of the largest entry.
+     */
+    ByteRing(size_t capacity, size_t maxEntrySize) : capacity(capacity), data(new uint8_t[capacity + maxEntrySize]()) {}
+
+    /**
+     * Reserves space for an entry. Must only be called by the producer.
+     * @param size The size of the entry, at most the largest entry size.
+     * @return Where to write the entry, or @c nullptr if the queue is too full.
+     * @note Once reserved, the space stays available until it is committed, since only the consumer frees space.
+     */
+    uint8_t *Reserve(size_t size) {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        if (tail + size - cachedHead > capacity) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (tail + size - cachedHead > capacity) {
+                return nullptr;
+            }
+        }
+        return data.get() + (tail & (capacity - 1));
+    }
+
+    /**
+     * Makes the entry written to the reserved space visible to the consumer. Must only be called by the producer.
+     * @param size The size of the entry.
+     */
+    void Commit(size_t size) {
+        tail.store(tail.load(std::memory_order_relaxed) + size, std::memory_order_release);
+    }
+
+    /**
+     * Returns the number of queued bytes as the producer last saw them; at least the actual number.
+     * Must only be called by the producer.
+     * @return The number of bytes.
+     */
+    size_t GetProducerFill() const {
+        return tail.load(std::memory_order_relaxed) - cachedHead;
+    }
+
+    /**
+     * Returns the oldest committed entry. Must only be called by the consumer.
+     * @return The entry, or @c nullptr if the queue is empty. Its bytes stay valid until it is released.
+     */
+    const uint8_t *Front() {
+        size_t head = this->head.load(std::memory_order_relaxed);
+        if (head == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (head == cachedTail) {
+                return nullptr;
+            }
+        }
+        return data.get() + (head & (capacity - 1));
+    }
+
+    /**
+     * Frees the oldest entry. Must only be called by the consumer.
+     * @param size The size of the entry.
+     */
+    void Release(size_t size) {
+        head.store(head.load(std::memory_order_relaxed) + size, std::memory_order_release);
+    }
+
+    size_t GetCapacity() const {
+        return capacity;
+    }
+
+private:
+    // As in RingBuffer, the indices and the copies of the other side's index live on separate cache lines
+    alignas(64) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+    alignas(64) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+    alignas(64) const size_t capacity;
+    std::unique_ptr<uint8_t[]> data;
+};
+
+#endif //BS3BOT_BYTERING_H
@@ -0,0 +1,38 @@
+#ifndef BS3BOT_CHANGESIGNAL_H
+#define BS3BOT_CHANGESIGNAL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * A version counter that threads can block on until it advances.
+ * Times are steady clock nanoseconds, like the rest of the bot's timestamps, unless a simulation replaces the clock.
+ * @note Notify may be called from any thread, including while holding other locks; it only takes its own mutex.
+ */
+class ChangeSignal {
+public:
+    uint64_t Notify();
+
+    uint64_t GetVersion() const;
+
+    int64_t GetChangeNanos() const;
+
+    uint64_t Wait(uint64_t seenVersion, int64_t deadlineNanos);
+
+    static int64_t NowNanos();
+
+    static int64_t SteadyNanos();
+
+    static void SetClock(int64_t (*replacement)());
+
+private:
+    static std::atomic<int64_t (*)()> clock;
+    std::atomic<uint64_t> version{0};
+    std::atomic<int64_t> changeNanos{0};
+    std::mutex mutex;
+    std::condition_variable condition;
+};
+
+#endif //BS3BOT_CHANGESIGNAL_H
@@ -0,0 +1,91 @@
+#ifndef BS3BOT_CLICKORDER_H
+#define BS3BOT_CLICKORDER_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Where an ingredient goes in the stack of an order. Bases (buns, cups, plates, trays) go first, tops (the top bun)
+ * go last, and fillings go in any order in between.
+ */
+enum class StackingLayer {
+    Base,
+    Filling,
+    Top
+};
+
+/**
+ * An ingredient to click and the conveyor item reserved for it, as predicted for the time of the first click.
+ */
+struct ClickTarget {
+    int ingredient;
+    StackingLayer layer;
+    // Whether an item is reserved; ingredients without one cannot be clicked, but still block later layers
+    bool available;
+    float x;
+    float y;
+    // Game units per nanosecond
+    float vx;
+    float vy;
+};
+
+/**
+ * The estimated outcome of clicking targets in a given order.
+ */
+struct ClickCost {
+    // Items that leave the screen before their click
+    int lost;
+    int64_t nanos;
+    float travel;
+
+    bool operator<(const ClickCost &other) const {
+        return lost != other.lost ? lost < other.lost : nanos < other.nanos;
+    }
+};
+
+/**
+ * Chooses the order to click the ingredients of an order in.
+ * The order respects the stacking layers, and minimizes first the number of items that drift off the screen before
+ * they are clicked, then the time until the last click. Each click takes a fixed time plus the cursor travel to the
+ * item, which keeps moving along the conveyor meanwhile. Orders of up to MAX_EXACT clickable ingredients are solved
+ * exactly over subsets; longer ones greedily.
+ */
+class ClickOrder {
+public:
+    static const int MAX_EXACT = 10;
+    // Targets beyond this are never sequenced
+    static const int MAX_TARGETS = 32;
+    // The game area, in game units
+    static constexpr float SCREEN_WIDTH = 800.0f;
+    static constexpr float SCREEN_HEIGHT = 600.0f;
+    // Time between clicks, which the planner spends waiting for the game to take the item
+    static const int64_t CLICK_NANOS = 51000000;
+    // Game units per nanosecond the cursor is assumed to travel, 800 units in 100 ms
+    static constexpr float CURSOR_SPEED = 8e-6f;
+
+    int Plan(const ClickTarget *targets, int count, float cursorX, float cursorY, int *sequence);
+
+    static ClickCost Evaluate(const ClickTarget *targets, const int *sequence, int length, float cursorX,
+                              float cursorY);
+
+    static int RecipeOrder(const ClickTarget *targets, int count, int *sequence);
+
+    static bool IsAllowed(const ClickTarget *targets, int count, uint32_t clicked, int next);
+
+private:
+    struct State {
+        ClickCost cost;
+        float x;
+        float y;
+        int previous;
+    };
+
+    static void Step(const ClickTarget &target, float &x, float &y, ClickCost &cost);
+
+    static int PlanGreedy(const ClickTarget *targets, int count, float cursorX, float cursorY, int *sequence);
+
+    // Indexed by subset of the clickable targets, then by the target clicked last
+    std::vector<State> states;
+};
+
+#endif //BS3BOT_CLICKORDER_H
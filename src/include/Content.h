@@ -1,20 +1,21 @@
 #ifndef BS3BOT_CONTENT_H
 #define BS3BOT_CONTENT_H
 
+#include <Platform.h>
+#include <ProcessMemory.h>
+#include <cstdint>
 #include <atomic>
-#include <objidl.h>
-#include <windows.h>
 #include <mutex>
 #include <thread>
 #include <list>
 #include <vector>
+#include <memory>
+#include <string>
+#include <string_view>
 #include <functional>
 #include <unordered_map>
-#include <ntstatus.h>
-#include <tlhelp32.h>
 #include <fstream>
 #include <iostream>
-#include <filesystem>
 
 class MemoryProbe {
 public:
@@ -24,15 +25,19 @@ public:
 
     DWORD GetAddress();
 
-    void PrintInts(int length);
+    uint64_t GetGeneration();
 
-    void PrintBytes(int length);
+    void PrintInts(ProcessMemory &memory, int length);
 
-    void PrintFloats(int length);
+    void PrintBytes(ProcessMemory &memory, int length);
+
+    void PrintFloats(ProcessMemory &memory, int length);
 
 protected:
     DWORD address;
-    int hash = 0;
+    // Hash of the state seen by the last HasChanged, and the number of changes seen so far
+    uint64_t hash = 0;
+    uint64_t generation = 0;
 };
 
 class ItemBase : public MemoryProbe {
@@ -40,78 +45,136 @@ public:
     explicit ItemBase(DWORD address) : MemoryProbe(address) {}
 };
 
+/**
+ * The fields of a simple item, decoded from a single read of the item.
+ */
+struct SimpleItemSnapshot {
+    static const SIZE_T SIZE = 0x48;
+
+    DWORD vtable = 0;
+    float x = -1;
+    float y = -1;
+    int itemId = -1;
+    int ingredientId = -1;
+    int conveyorIndex = -1;
+    int terminator = -1;
+    // Hash of the raw bytes of the decoded fields
+    uint64_t hash = 0;
+
+    bool Read(ProcessMemory &memory, DWORD address);
+};
+
+/**
+ * The fields of a complex item, decoded from a single read of the item.
+ */
+struct ComplexItemSnapshot {
+    static const SIZE_T SIZE = 0x80;
+    static const int MAX_ITEMS = 32;
+
+    DWORD vtable = 0;
+    float x = -1;
+    float y = -1;
+    int conveyorIndex = -1;
+    int itemCount = 0;
+    DWORD itemList = 0;
+    // Hash of the raw bytes of the decoded fields, not including the sub-items
+    uint64_t hash = 0;
+
+    bool Read(ProcessMemory &memory, DWORD address);
+
+    int ReadItemAddresses(ProcessMemory &memory, DWORD *addresses) const;
+};
+
 class SimpleItem : public ItemBase {
 public:
     explicit SimpleItem(DWORD address) : ItemBase(address) {}
 
-    bool isValid(HANDLE hProcess);
+    bool Refresh(ProcessMemory &memory);
 
-    int GetItemId(HANDLE hProcess);
+    const SimpleItemSnapshot *GetSnapshot(ProcessMemory &memory);
 
-    int GetIngredientId(HANDLE hProcess);
+    bool isValid(ProcessMemory &memory);
 
-    int GetConveyorIndex(HANDLE hProcess);
+    int GetItemId(ProcessMemory &memory);
 
-    std::string GetName(HANDLE hProcess);
+    int GetIngredientId(ProcessMemory &memory);
 
-    std::string GetIngredientName(HANDLE hProcess);
+    int GetConveyorIndex(ProcessMemory &memory);
 
-    float GetX(HANDLE hProcess);
+    std::string_view GetName(ProcessMemory &memory);
 
-    float GetY(HANDLE hProcess);
+    std::string_view GetIngredientName(ProcessMemory &memory);
 
-    std::pair<float, float> GetPos(HANDLE hProcess);
+    float GetX(ProcessMemory &memory);
 
-    float GetMouseX(HANDLE hProcess);
+    float GetY(ProcessMemory &memory);
 
-    float GetMouseY(HANDLE hProcess);
+    std::pair<float, float> GetPos(ProcessMemory &memory);
 
-    std::pair<float, float> GetMousePos(HANDLE hProcess);
+    int GetLayer(ProcessMemory &memory);
 
-    int GetLayer(HANDLE hProcess);
+    void SetItemId(ProcessMemory &memory, int value);
 
-    void SetItemId(HANDLE hProcess, int value);
+    void SetIngredientId(ProcessMemory &memory, int value);
 
-    void SetIngredientId(HANDLE hProcess, int value);
-
-    bool HasChanged();
+    bool HasChanged(ProcessMemory &memory);
 
 private:
-    int _itemId = -1;
-    int _ingredientId = -1;
+    SimpleItemSnapshot snapshot;
+    bool hasSnapshot = false;
 };
 
 class ComplexItem : public ItemBase {
 public:
     explicit ComplexItem(DWORD address) : ItemBase(address) {}
 
-    bool isValid(HANDLE hProcess);
+    bool Refresh(ProcessMemory &memory);
 
-    std::list<SimpleItem> GetItems(HANDLE hProcess);
+    const ComplexItemSnapshot *GetSnapshot(ProcessMemory &memory);
 
-    int GetConveyorIndex(HANDLE hProcess);
+    bool isValid(ProcessMemory &memory);
 
-    float GetX(HANDLE hProcess);
+    std::list<SimpleItem> GetItems(ProcessMemory &memory);
 
-    float GetY(HANDLE hProcess);
+    int GetConveyorIndex(ProcessMemory &memory);
 
-    bool HasChanged();
-};
+    float GetX(ProcessMemory &memory);
 
-struct ItemData {
-    int id;
-    std::string name;
-    std::string type;
-    std::string oven = "";
-    std::string pot = "";
-    std::string pan = "";
+    float GetY(ProcessMemory &memory);
 
-    ItemData(int id, const std::string &name, const std::string &type, const std::string &oven, const std::string &pot,
-             const std::string &pan) : id(id), name(name), type(type), oven(oven), pot(pot), pan(pan) {}
+    bool HasChanged(ProcessMemory &memory);
 
-    ItemData() : id(-1), name(""), type("") {}
+private:
+    ComplexItemSnapshot snapshot;
+    bool hasSnapshot = false;
 };
 
+/**
+ * Where an item comes from.
+ */
+enum class ItemType : uint8_t {
+    None,
+    Conveyor,
+    Machine
+};
+
+/**
+ * An entry of the item catalog. The name is a range of the catalog's string pool; what an oven, pot or pan turns the
+ * item into is the id of that item, or -1 if it turns into nothing the catalog has.
+ */
+struct ItemData {
+    uint32_t nameOffset;
+    uint16_t nameLength;
+    // -1 for ids the catalog skips
+    int16_t id;
+    int16_t oven;
+    int16_t pot;
+    int16_t pan;
+    ItemType type;
+};
+
+static_assert(sizeof(ItemData) == 16, "Item data must stay four entries per cache line");
+
 struct Point {
     float x;
     float y;
@@ -134,23 +197,29 @@ struct ItemInfo {
     bool mHiliteAll;
     bool mSpecialDraw;
     int mCustomParam;
+    int mReserved;
 
     ItemInfo() : mNumCopies(0), mNumComplete(0), mRobotComplete(false), mItem(0), mFlyList(0), mDraw(false),
                  mInThoughtBubble(false), mRequired(false), mIsFree(false), mHideCount(0), mGroupOffset(
-                    Point(0, 0)), mHiliteAll(false), mSpecialDraw(false), mCustomParam(0) {}
+                    Point(0, 0)), mHiliteAll(false), mSpecialDraw(false), mCustomParam(0), mReserved(0) {}
 
-    std::unique_ptr<ItemBase> GetItem();
+    std::unique_ptr<ItemBase> GetItem(ProcessMemory &memory);
 };
 
+// ItemInfo mirrors the game's 48-byte element, so an order vector can be read straight into an array of them.
+static_assert(sizeof(ItemInfo) == 48, "ItemInfo must match the layout of the game's order entries");
+
 class Customer : public MemoryProbe {
 public:
+    static const int MAX_ORDER_ITEMS = 64;
+
     Customer(DWORD address) : MemoryProbe(address) {}
 
-    bool isValid(HANDLE hProcess);
+    bool isValid(ProcessMemory &memory);
 
-    int GetId(HANDLE hProcess);
+    int GetId(ProcessMemory &memory);
 
-    std::list<ItemInfo> GetItems(HANDLE hProcess);
+    bool GetItems(ProcessMemory &memory, std::vector<ItemInfo> &items);
 };
 
 #endif // BS3BOT_CONTENT_H
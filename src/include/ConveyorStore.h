@@ -0,0 +1,75 @@
+#ifndef BS3BOT_CONVEYORSTORE_H
+#define BS3BOT_CONVEYORSTORE_H
+
+#include <Platform.h>
+#include <TypeCache.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * A conveyor item tracked by the ConveyorStore.
+ */
+struct ConveyorSlot {
+    DWORD address;
+    ObjectKind kind;
+    // Hash of the item's state when it was last checked for changes, and the number of changes seen so far
+    uint64_t hash;
+    uint64_t generation;
+    uint32_t prev;
+    uint32_t next;
+};
+
+/**
+ * The items on the conveyor, in the order they were added.
+ * Items live in a slot array threaded by a doubly linked list, with a hash index from address to slot, so adding,
+ * removing, moving and looking up an item are all O(1). Freed slots are recycled, so removal leaves no tombstones
+ * for iteration to skip.
+ * @note This class never reads game memory and is not thread-safe; the owner is expected to lock around it.
+ */
+class ConveyorStore {
+public:
+    static const uint32_t NONE = UINT32_MAX;
+
+    bool Insert(DWORD address, ObjectKind kind);
+
+    bool Remove(DWORD address);
+
+    const ConveyorSlot *Find(DWORD address) const;
+
+    const ConveyorSlot *Front() const;
+
+    bool MoveToBack(DWORD address);
+
+    bool UpdateHash(DWORD address, uint64_t hash);
+
+    void Clear();
+
+    size_t Size() const;
+
+    bool IsEmpty() const;
+
+    /**
+     * Calls a function for every item, front to back.
+     * @param function The function, taking a <tt>const ConveyorSlot &</tt>.
+     */
+    template<typename Function>
+    void ForEach(Function function) const {
+        for (uint32_t i = head; i != NONE; i = slots[i].next) {
+            function(slots[i]);
+        }
+    }
+
+private:
+    void Link(uint32_t slot);
+
+    void Unlink(uint32_t slot);
+
+    std::vector<ConveyorSlot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<DWORD, uint32_t> index;
+    uint32_t head = NONE;
+    uint32_t tail = NONE;
+};
+
+#endif //BS3BOT_CONVEYORSTORE_H
@@ -0,0 +1,51 @@
+#ifndef BS3BOT_CONVEYORTABLE_H
+#define BS3BOT_CONVEYORTABLE_H
+
+#include <Platform.h>
+#include <ProcessMemory.h>
+#include <TypeCache.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * An item inside a complex conveyor item.
+ */
+struct SubItemEntry {
+    DWORD address;
+    int itemId;
+    int ingredientId;
+};
+
+/**
+ * The decoded conveyor items, stored as one column per field.
+ * Row @c i of every column describes the same item. Complex items have no item or ingredient id (both are -1) and
+ * reference the range <tt>[firstSubItem, firstSubItem + subItemCount)</tt> of the shared @c subItems array; simple
+ * items have an empty range. Once the columns have grown, rebuilding the table does not allocate.
+ */
+struct ConveyorTable {
+    std::vector<DWORD> address;
+    std::vector<ObjectKind> kind;
+    std::vector<int> itemId;
+    std::vector<int> ingredientId;
+    std::vector<int> conveyorIndex;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<int> firstSubItem;
+    std::vector<int> subItemCount;
+    // Hash of the raw bytes of the item and its sub-items
+    std::vector<uint64_t> hash;
+    // How often the item has changed while on the conveyor, as tracked by the ConveyorStore
+    std::vector<uint64_t> generation;
+    std::vector<SubItemEntry> subItems;
+
+    size_t Size() const;
+
+    void Clear();
+
+    void Resize(size_t size);
+
+    bool Decode(ProcessMemory &memory, size_t from, size_t to);
+};
+
+#endif //BS3BOT_CONVEYORTABLE_H
@@ -1,13 +1,73 @@
 #ifndef BS3BOT_DEBUGGING_H
 #define BS3BOT_DEBUGGING_H
 
+#include <windows.h>
+#include <BreakpointEvent.h>
+#include <LatencyHistogram.h>
+#include <RingBuffer.h>
+#include <ProcessMemory.h>
+#include <atomic>
+#include <unordered_map>
+
+class Breakpoint {
+
+public:
+    LPVOID address;
+
+    Breakpoint() : id(BreakpointId::Count), originalByte(0), isActive(false) {}
+
+    BreakpointId id;
+    BYTE originalByte;
+    bool isActive;
+};
+
+class BreakpointManager {
+private:
+    HANDLE processHandle;
+    std::unordered_map<LPVOID, Breakpoint> breakpoints;
+    Breakpoint *lastBreakpoint;
+    HANDLE threadHandle;
+
+public:
+    BreakpointManager(HANDLE process) : processHandle(process), lastBreakpoint(nullptr) {}
+
+    bool SetBreakpoint(LPVOID address, BreakpointId id);
+
+    bool HandleBreakpoint(const DEBUG_EVENT &debugEvent);
+
+    void ReinstateBreakpoint();
+
+    void ClearSingleStep();
+};
 
 class Debugging {
 public:
-    static void EnqueueEvent(const DEBUG_EVENT &debugEvent, std::function<void(const DEBUG_EVENT &, HANDLE)> callback,
-                             HANDLE handle);
+    static const size_t EVENT_QUEUE_SIZE = 256;
+
+    static bool EnqueueEvent(const BreakpointEvent &event);
+
+    static const LatencyHistogram &GetHandleLatency();
+
+    static const LatencyHistogram &GetSuspendLatency();
+
+    static uint64_t GetDroppedEvents();
+
+    static void CountUnreadableEvent();
+
+    static uint64_t GetUnreadableEvents();
 
     static void DebugLoop();
+
+private:
+    static void WorkerThread();
+
+    static RingBuffer<BreakpointEvent, EVENT_QUEUE_SIZE> eventQueue;
+    static HANDLE eventSignal;
+    static std::atomic<bool> workerRunning;
+    static std::atomic<uint64_t> droppedEvents;
+    static std::atomic<uint64_t> unreadableEvents;
+    static LatencyHistogram handleLatency;
+    static LatencyHistogram suspendLatency;
 };
 
 
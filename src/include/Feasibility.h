@@ -0,0 +1,46 @@
+#ifndef BS3BOT_FEASIBILITY_H
+#define BS3BOT_FEASIBILITY_H
+
+#include <ConveyorTable.h>
+#include <IngredientCounts.h>
+#include <World.h>
+#include <vector>
+
+/**
+ * The implementations of the multi-order feasibility kernel.
+ */
+enum class FeasibilityKernel {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+/**
+ * Decides which orders can be built from the items on the conveyor.
+ */
+class Feasibility {
+public:
+    static void CountConveyor(const ConveyorTable &conveyor, IngredientCounts &available);
+
+    static void CollectIngredients(const WorldSnapshot &world, const OrderEntry &order, std::vector<int> &ingredients);
+
+    static void CountIngredients(const std::vector<int> &ingredients, IngredientCounts &required);
+
+    static bool IsFeasible(const IngredientCounts &available, const IngredientCounts &required);
+
+    static int CountMissing(const IngredientCounts &available, const IngredientCounts &required);
+
+    static int CheckAll(const IngredientCounts &available, const std::vector<IngredientCounts> &required,
+                        std::vector<int> &missing);
+
+    static int CheckAll(FeasibilityKernel kernel, const IngredientCounts &available, const IngredientCounts *required,
+                        size_t numOrders, int *missing);
+
+    static bool IsSupported(FeasibilityKernel kernel);
+
+    static FeasibilityKernel GetBestKernel();
+
+    static const char *GetKernelName(FeasibilityKernel kernel);
+};
+
+#endif //BS3BOT_FEASIBILITY_H
@@ -0,0 +1,42 @@
+#ifndef BS3BOT_HASH_H
+#define BS3BOT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 64-bit FNV-1a hashing, used to detect changes in raw game memory.
+ */
+class Hash {
+public:
+    static const uint64_t OFFSET_BASIS = 14695981039346656037ULL;
+    static const uint64_t PRIME = 1099511628211ULL;
+
+    /**
+     * Hashes a block of bytes.
+     * @param data The bytes.
+     * @param size The number of bytes.
+     * @param hash The hash to continue from, for hashing several blocks as one.
+     * @return The hash.
+     */
+    static uint64_t Bytes(const void *data, size_t size, uint64_t hash = OFFSET_BASIS) {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= PRIME;
+        }
+        return hash;
+    }
+
+    /**
+     * Mixes a value into a hash.
+     * @param hash The hash.
+     * @param value The value.
+     * @return The combined hash.
+     */
+    static uint64_t Combine(uint64_t hash, uint64_t value) {
+        return Bytes(&value, sizeof(value), hash);
+    }
+};
+
+#endif //BS3BOT_HASH_H
@@ -0,0 +1,26 @@
+#ifndef BS3BOT_INGREDIENTCOUNTS_H
+#define BS3BOT_INGREDIENTCOUNTS_H
+
+#include <cstdint>
+
+/**
+ * A dense count of ingredients, indexed by ingredient id.
+ * Used both for what is available on the conveyor and for what an order requires, so checking an order is a
+ * comparison of two fixed-size arrays.
+ */
+struct IngredientCounts {
+    // Covers every id in food.xml with room to spare; a power of two so rows stay aligned for vector loads
+    static const int MAX_INGREDIENTS = 256;
+
+    alignas(32) uint8_t counts[MAX_INGREDIENTS];
+    // Set when an ingredient id outside [0, MAX_INGREDIENTS) was added. Such a requirement can never be met.
+    bool overflow;
+
+    IngredientCounts();
+
+    void Clear();
+
+    void Add(int ingredientId);
+};
+
+#endif //BS3BOT_INGREDIENTCOUNTS_H
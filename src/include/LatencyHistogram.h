@@ -0,0 +1,43 @@
+#ifndef BS3BOT_LATENCYHISTOGRAM_H
+#define BS3BOT_LATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * A histogram of durations with power-of-two microsecond buckets.
+ * Bucket 0 counts durations below 1 us, bucket i counts durations in [2^(i-1), 2^i) us.
+ * @note Recording is lock-free and may happen on any thread.
+ */
+class LatencyHistogram {
+public:
+    static const int NUM_BUCKETS = 32;
+
+    LatencyHistogram();
+
+    void Record(uint64_t nanos);
+
+    uint64_t GetCount() const;
+
+    uint64_t GetBucket(int bucket) const;
+
+    uint64_t GetMaxNanos() const;
+
+    uint64_t GetMeanNanos() const;
+
+    uint64_t GetPercentileNanos(double fraction) const;
+
+    void Print(std::ostream &out, const std::string &name) const;
+
+    void Reset();
+
+private:
+    std::atomic<uint64_t> buckets[NUM_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> totalNanos;
+    std::atomic<uint64_t> maxNanos;
+};
+
+#endif //BS3BOT_LATENCYHISTOGRAM_H
@@ -1,23 +1,29 @@
 #ifndef BS3BOT_MANAGERS_H
 #define BS3BOT_MANAGERS_H
 
+#include <Platform.h>
 #include <atomic>
 #include <mutex>
 #include <thread>
 #include <list>
 #include <vector>
+#include <memory>
+#include <string>
+#include <string_view>
 #include <functional>
 #include <unordered_map>
-#include <ntstatus.h>
-#include <tlhelp32.h>
-#include <windows.h>
 #include <fstream>
 #include <iostream>
 #include <filesystem>
-#include <list>
-#include <vector>
-#include <mutex>
 #include <Content.h>
+#include <ProcessMemory.h>
+#include <PageCache.h>
+#include <ConveyorStore.h>
+#include <ConveyorTable.h>
+#include <ClickOrder.h>
+#include <Actuator.h>
+#include <ChangeSignal.h>
+#include <TickClock.h>
 
 class GameState {
 public:
@@ -25,14 +31,24 @@ public:
 
     static float GetNumConveyorItems();
 
-    static std::vector<std::unique_ptr<ItemBase>> GetConveyorItems();
+    static void GetConveyorItems(ConveyorTable &table);
 
     static std::vector<Customer> GetCustomers();
 
     static bool IsDirty();
 
+    static bool HasConveyorItem(DWORD address);
+
     static HANDLE GetHandle();
 
+    static ProcessMemory &GetMemory();
+
+    static ProcessMemory &GetDirectMemory();
+
+    static PageCache &GetPageCache();
+
+    static Actuator &GetActuator();
+
     static HWND GetWindowHandle();
 
     static void SetBBPercent(float value);
@@ -45,6 +61,10 @@ public:
 
     static void SetHandle(HANDLE pVoid);
 
+    static void SetMemory(std::unique_ptr<ProcessMemory> pMemory);
+
+    static void SetActuator(std::unique_ptr<Actuator> pActuator);
+
     static void SetWindowHandle(HWND pVoid);
 
     static void SortConveyorItems();
@@ -63,71 +83,80 @@ public:
 
     static bool CheckItemsDirty();
 
-    static std::vector<std::unique_ptr<ItemBase>> conveyorItems;
+    static bool UpdateItemGenerations(ConveyorTable &table);
+
+    static bool UpdateOrdersHash(uint64_t hash);
+
+    static uint64_t GetStateVersion();
+
+    static uint64_t GetLevelCount();
+
+    static int64_t GetChangeNanos();
+
+    static uint64_t WaitForChange(uint64_t version, int64_t deadlineNanos);
+
+    static uint64_t WaitForWake(uint64_t count, int64_t deadlineNanos);
+
+    static uint64_t GetWakeCount();
 
-    static void PerformActions();
+    static void OnFrame(int64_t timestampNanos);
+
+    static TickClock &GetTickClock();
+
+    static int64_t PerformActions();
+
+    static void ResetActions();
 
 private:
+    static ConveyorStore conveyorItems;
     static std::mutex conveyorItemsMutex;
     static std::mutex customersMutex;
     static float bbPercent;
     static int numConveyorItems;
     static std::vector<Customer> customers;
+    static void MarkChanged();
+
     static bool dirty;
+    static ChangeSignal stateSignal;
+    // Advances with the state version and on every frame the bot acts on
+    static ChangeSignal wakeSignal;
+    static TickClock tickClock;
+    static std::atomic<uint64_t> ordersHash;
+    static std::atomic<uint64_t> levelCount;
     static bool needsSorting;
     static void *handle;
+    static std::unique_ptr<ProcessMemory> memory;
+    static std::unique_ptr<PageCache> pageCache;
+    // Records the direct reads while a session is being recorded; the page cache records its own
+    static std::unique_ptr<ProcessMemory> recordedMemory;
+    static std::unique_ptr<Actuator> actuator;
     static HWND windowHandle;
-    static int timeWithNoCustomers;
 };
 
+/**
+ * The item catalog, indexed by item id. Lookups are a bounds check and one load; names are views of one string pool.
+ * @note The catalog must be loaded before the threads that read it start; the returned names and entries stay valid
+ * until the next load.
+ */
 class ItemManager {
 public:
-    static std::vector<std::string> itemNames;
-    static std::unordered_map<int, ItemData> itemData;
-    static std::unordered_map<std::string, ItemData> itemDataByName;
-
     static bool LoadItems(const std::string &filename);
 
-    static std::string GetItemName(int id);
+    static std::string_view GetItemName(int id);
 
-    static ItemData GetItemData(int id);
+    static const ItemData &GetItemData(int id);
 
     static int GetNumItems();
 
     static bool LoadContent();
 
     static int IngredientLimit(int id);
-};
-
-class Breakpoint {
-
-public:
-    LPVOID address;
 
-    Breakpoint() : originalByte(0), isActive(false) {}
+    static StackingLayer GetStackingLayer(int id);
 
-    std::function<void(const DEBUG_EVENT &, HANDLE)> callback;
-    BYTE originalByte;
-    bool isActive;
-};
-
-class BreakpointManager {
 private:
-    HANDLE processHandle;
-    std::unordered_map<LPVOID, Breakpoint> breakpoints;
-    Breakpoint *lastBreakpoint;
-    HANDLE threadHandle;
-
-public:
-    BreakpointManager(HANDLE process) : processHandle(process), lastBreakpoint(nullptr) {}
-
-    bool SetBreakpoint(LPVOID address, std::function<void(const DEBUG_EVENT &, HANDLE)> callback);
-
-    bool HandleBreakpoint(const DEBUG_EVENT &debugEvent);
-
-    void ReinstateBreakpoint();
-
-    void ClearSingleStep();
+    static std::vector<ItemData> items;
+    static std::string namePool;
 };
 
 #endif // BS3BOT_MANAGERS_H
@@ -0,0 +1,65 @@
+#ifndef BS3BOT_MOTIONPREDICTOR_H
+#define BS3BOT_MOTIONPREDICTOR_H
+
+#include <Platform.h>
+#include <ConveyorTable.h>
+#include <cstdint>
+#include <unordered_map>
+
+/**
+ * Predicts where conveyor items will be when a click lands.
+ * Every item gets a constant-velocity model, fitted by least squares to its last few positions. A click is aimed at
+ * the position the model predicts for the time the click is sent, which lags the decision by the measured input
+ * latency.
+ */
+class MotionPredictor {
+public:
+    // Positions per item used for the fit, about 100 ms of snapshots
+    static const int MAX_SAMPLES = 6;
+    // A position further than this from the prediction restarts the model, e.g. after the item was dropped back
+    static constexpr float JUMP_DISTANCE = 24.0f;
+    // Assumed input latency until the first click was measured
+    static const int64_t DEFAULT_LATENCY_NANOS = 30000000;
+
+    void Update(const ConveyorTable &conveyor, int64_t timeNanos);
+
+    bool Predict(DWORD address, int64_t timeNanos, float &x, float &y) const;
+
+    bool GetVelocity(DWORD address, float &vx, float &vy) const;
+
+    void RecordLatency(int64_t nanos);
+
+    int64_t GetLatencyNanos() const;
+
+    void Clear();
+
+private:
+    struct Sample {
+        int64_t timeNanos;
+        float x;
+        float y;
+    };
+
+    struct Track {
+        Sample samples[MAX_SAMPLES];
+        int count;
+        int next;
+        int64_t lastSeenNanos;
+        // The fitted line, relative to the newest sample's time
+        float x;
+        float y;
+        float vx;
+        float vy;
+    };
+
+    static void Fit(Track &track);
+
+    static void Evaluate(const Track &track, int64_t timeNanos, float &x, float &y);
+
+    std::unordered_map<DWORD, Track> tracks;
+    int64_t lastUpdateNanos = 0;
+    int64_t latencyNanos = DEFAULT_LATENCY_NANOS;
+    bool measuredLatency = false;
+};
+
+#endif //BS3BOT_MOTIONPREDICTOR_H
@@ -0,0 +1,87 @@
+#ifndef BS3BOT_PAGECACHE_H
+#define BS3BOT_PAGECACHE_H
+
+#include <Platform.h>
+#include <ProcessMemory.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * A page-granular read cache in front of another ProcessMemory.
+ * Reads fetch whole 4 KiB pages from the backend once per epoch and serve every other read of that page from local
+ * memory until the next epoch starts. A page that cannot be read as a whole is remembered as such for the epoch, and
+ * its reads go to the backend for just the requested bytes. Writes go straight to the backend and drop the affected
+ * pages. Marked as recording its fetches, it hands every page it fetches to the Recorder, which queues what changed
+ * since the page's previous fetch.
+ * @note This class is thread-safe. Backend reads happen outside the lock, so readers only wait for each other's copies.
+ */
+class PageCache : public ProcessMemory {
+public:
+    static const DWORD PAGE_SIZE = 0x1000;
+
+    explicit PageCache(ProcessMemory &backend) : backend(backend) {}
+
+    void BeginEpoch();
+
+    uint64_t GetEpoch();
+
+    void Invalidate();
+
+    void Invalidate(DWORD address, SIZE_T size);
+
+    bool ReadUncached(DWORD address, LPVOID buffer, SIZE_T size);
+
+    ProcessMemory &GetBackend();
+
+    uint64_t GetHits() const;
+
+    uint64_t GetMisses() const;
+
+    uint64_t GetBytesFetched() const;
+
+    void ResetCacheCounters();
+
+    void SetFetchesRecorded(bool value);
+
+protected:
+    bool ReadImpl(DWORD address, LPVOID buffer, SIZE_T size) override;
+
+    bool WriteImpl(DWORD address, LPCVOID buffer, SIZE_T size) override;
+
+private:
+    static const size_t MAX_PAGES = 1024;
+
+    struct Page {
+        uint64_t epoch;
+        bool readable;
+        // The recording the data was queued in, or 0 if it was not
+        uint32_t recordedSession;
+        BYTE data[PAGE_SIZE];
+    };
+
+    enum class PageState {
+        Cached,
+        Unreadable,
+        Missing
+    };
+
+    PageState CopyCached(DWORD pageAddress, DWORD offset, BYTE *out, SIZE_T size, std::unique_ptr<Page> &stale);
+
+    PageState Fetch(DWORD pageAddress, DWORD offset, BYTE *out, SIZE_T size, std::unique_ptr<Page> page);
+
+    ProcessMemory &backend;
+    std::mutex mutex;
+    std::unordered_map<DWORD, std::unique_ptr<Page>> pages;
+    uint64_t epoch = 1;
+    // Counts invalidations, so that a fetch that overlapped one does not cache what it read
+    uint64_t invalidations = 0;
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> bytesFetched{0};
+    bool fetchesRecorded = false;
+};
+
+#endif //BS3BOT_PAGECACHE_H
@@ -0,0 +1,50 @@
+#ifndef BS3BOT_PATIENCE_H
+#define BS3BOT_PATIENCE_H
+
+#include <Platform.h>
+#include <World.h>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Estimates when each customer will run out of patience and leave.
+ * The game does not expose a wait timer the bot knows how to read, so every customer is timed from the frame it is
+ * first seen, and the patience of the level is learned from the customers that leave before being served.
+ */
+class PatienceTracker {
+public:
+    // Assumed patience until the first customer is lost, about a minute at one frame per 17 ms
+    static const uint64_t DEFAULT_PATIENCE_FRAMES = 3600;
+
+    void Observe(uint64_t frame, std::vector<CustomerEntry> &customers, const std::vector<OrderEntry> &orders);
+
+    uint64_t GetPatienceFrames() const;
+
+    bool HasLearned() const;
+
+    uint64_t GetServedCount() const;
+
+    uint64_t GetLostCount() const;
+
+    void Reset();
+
+private:
+    struct TrackedCustomer {
+        DWORD address;
+        int id;
+        uint64_t arrivalFrame;
+        uint64_t lastSeenFrame;
+        // Customers already waiting when tracking started have an unknown arrival, so they are not learned from
+        bool arrivalKnown;
+        bool complete;
+    };
+
+    std::vector<TrackedCustomer> tracked;
+    uint64_t patienceFrames = DEFAULT_PATIENCE_FRAMES;
+    bool learned = false;
+    bool started = false;
+    uint64_t servedCount = 0;
+    uint64_t lostCount = 0;
+};
+
+#endif //BS3BOT_PATIENCE_H
@@ -0,0 +1,30 @@
+#ifndef BS3BOT_PLATFORM_H
+#define BS3BOT_PLATFORM_H
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+#else
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Minimal stand-ins for the Win32 types used by the data layer, so that it can be built and benchmarked without the
+ * Windows SDK. The sizes match the 32-bit game process the bot reads from (DWORD must stay 4 bytes, as the in-game
+ * structures are decoded with it).
+ */
+typedef uint32_t DWORD;
+typedef uint8_t BYTE;
+typedef int BOOL;
+typedef size_t SIZE_T;
+typedef uintptr_t DWORD_PTR;
+typedef void *LPVOID;
+typedef const void *LPCVOID;
+typedef void *HANDLE;
+typedef struct HWND__ *HWND;
+
+#endif
+
+#endif //BS3BOT_PLATFORM_H
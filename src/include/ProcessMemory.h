@@ -0,0 +1,124 @@
+#ifndef BS3BOT_PROCESSMEMORY_H
+#define BS3BOT_PROCESSMEMORY_H
+
+#include <Platform.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Access to the address space of the game process.
+ * All reads and writes go through @c Read and @c Write, which keep counters so that the number of remote reads and the
+ * time spent in them can be measured per tick, regardless of the backend. The reads of a memory marked as recorded are
+ * also passed to the Recorder.
+ */
+class ProcessMemory {
+public:
+    virtual ~ProcessMemory() = default;
+
+    bool Read(DWORD address, LPVOID buffer, SIZE_T size);
+
+    bool Write(DWORD address, LPCVOID buffer, SIZE_T size);
+
+    uint64_t GetReadCount() const;
+
+    uint64_t GetBytesRead() const;
+
+    uint64_t GetReadNanos() const;
+
+    uint64_t GetWriteCount() const;
+
+    void ResetCounters();
+
+    void SetRecorded(bool value);
+
+protected:
+    virtual bool ReadImpl(DWORD address, LPVOID buffer, SIZE_T size) = 0;
+
+    virtual bool WriteImpl(DWORD address, LPCVOID buffer, SIZE_T size) = 0;
+
+private:
+    std::atomic<uint64_t> readCount{0};
+    std::atomic<uint64_t> bytesRead{0};
+    std::atomic<uint64_t> readNanos{0};
+    std::atomic<uint64_t> writeCount{0};
+    bool recorded = false;
+};
+
+#ifdef _WIN32
+
+/**
+ * Reads and writes the memory of a live process through @c ReadProcessMemory and @c WriteProcessMemory.
+ */
+class Win32ProcessMemory : public ProcessMemory {
+public:
+    explicit Win32ProcessMemory(HANDLE processHandle) : processHandle(processHandle) {}
+
+    HANDLE GetHandle();
+
+protected:
+    bool ReadImpl(DWORD address, LPVOID buffer, SIZE_T size) override;
+
+    bool WriteImpl(DWORD address, LPCVOID buffer, SIZE_T size) override;
+
+private:
+    HANDLE processHandle;
+};
+
+#endif
+
+/**
+ * A sparse image of a 32-bit address space, made up of non-overlapping regions.
+ * Regions are either mapped from a dump file or allocated in memory (e.g. for a synthetic heap).
+ * @note Regions must be set up before the image is read from concurrently.
+ */
+class ImageProcessMemory : public ProcessMemory {
+public:
+    ImageProcessMemory() = default;
+
+    ImageProcessMemory(const ImageProcessMemory &) = delete;
+
+    ImageProcessMemory &operator=(const ImageProcessMemory &) = delete;
+
+    ~ImageProcessMemory() override;
+
+    BYTE *MapRegion(DWORD base, SIZE_T size);
+
+    bool LoadDump(const std::string &filename);
+
+    bool SaveDump(const std::string &filename) const;
+
+    BYTE *Translate(DWORD address, SIZE_T size);
+
+    void Clear();
+
+protected:
+    bool ReadImpl(DWORD address, LPVOID buffer, SIZE_T size) override;
+
+    bool WriteImpl(DWORD address, LPCVOID buffer, SIZE_T size) override;
+
+private:
+    struct Region {
+        DWORD base;
+        SIZE_T size;
+        BYTE *data;
+    };
+
+    struct FileMapping {
+        void *data;
+        SIZE_T size;
+    };
+
+    bool AddRegion(DWORD base, SIZE_T size, BYTE *data);
+
+    bool AddDumpRegions(BYTE *data, SIZE_T fileSize, const std::string &filename);
+
+    std::map<DWORD, Region> regions;
+    std::vector<std::unique_ptr<BYTE[]>> ownedBuffers;
+    std::vector<FileMapping> fileMappings;
+};
+
+#endif //BS3BOT_PROCESSMEMORY_H
@@ -0,0 +1,312 @@
+#ifndef BS3BOT_RECORDER_H
+#define BS3BOT_RECORDER_H
+
+#include <Platform.h>
+#include <Actuator.h>
+#include <BreakpointEvent.h>
+#include <ProcessMemory.h>
+#include <ByteRing.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct WorldSnapshot;
+
+enum class RecordKind : uint8_t {
+    // A breakpoint hit, recorded before its handler runs
+    Breakpoint,
+    // Bytes of the game's memory that a read saw change
+    Memory,
+    // A conveyor item that was added, removed or changed between two snapshots
+    Item,
+    // A customer that arrived, left or whose orders changed between two snapshots
+    Customer,
+    // A command the planner submitted to the actuator
+    Action,
+    // A run of the planner
+    Tick
+};
+
+enum RecordFlags : uint8_t {
+    RECORD_ADDED = 1,
+    RECORD_REMOVED = 2,
+    RECORD_CHANGED = 4
+};
+
+/*
+ * The payloads of the record kinds. They only have 4-byte fields, or 8-byte fields at offset 0, so that a session
+ * recorded by the 32-bit bot has the same layout on a 64-bit replay host.
+ */
+
+struct BreakpointRecord {
+    uint32_t id;
+    DWORD threadId;
+    DWORD eax;
+    DWORD ebx;
+    DWORD ecx;
+    DWORD esi;
+    DWORD edi;
+};
+
+struct ItemRecord {
+    int32_t itemId;
+    int32_t ingredientId;
+    int32_t kind;
+    int32_t subItemCount;
+    float x;
+    float y;
+    uint32_t generation;
+};
+
+struct CustomerRecord {
+    int32_t id;
+    int32_t orderCount;
+    int32_t ingredientCount;
+    // Ingredients the orders need that are not on the conveyor
+    int32_t missingCount;
+};
+
+struct ActionRecord {
+    uint32_t type;
+    int32_t x;
+    int32_t y;
+    uint32_t sequence;
+};
+
+struct TickRecord {
+    uint64_t version;
+};
+
+/**
+ * One entry of a session recording. Every record has the same size, so the ring and the file hold plain arrays.
+ * @c address is the memory address for Memory records, the item or customer for Item and Customer records, and the
+ * item a click should take for Action records.
+ */
+struct alignas(8) SessionRecord {
+    static constexpr size_t PAYLOAD_SIZE = 48;
+
+    // Steady clock time, or the time of the clock that replaced it; the hit time for breakpoints, and the time of the
+    // record before them for Memory records
+    int64_t timeNanos;
+    RecordKind kind;
+    uint8_t flags;
+    // The number of bytes in a Memory record
+    uint16_t size;
+    DWORD address;
+    union {
+        BreakpointRecord breakpoint;
+        ItemRecord item;
+        CustomerRecord customer;
+        ActionRecord action;
+        TickRecord tick;
+        BYTE bytes[PAYLOAD_SIZE];
+    };
+};
+
+static_assert(sizeof(SessionRecord) == 64, "Session records must keep their file layout");
+
+/**
+ * Records a session of the bot to a binary file: breakpoint events, the bytes of the game's memory the bot read as they
+ * change, the decoded conveyor items and customers as changes between snapshots, and every planner run and command.
+ * Every recording thread appends to a ring of its own, without locks: records as they are, the chunks of each page the
+ * page cache fetched that changed since its previous fetch, the bytes of each read that bypassed the cache, and the
+ * items and customers of each snapshot whose game state version changed. A background thread drains the rings every
+ * few milliseconds, finds the bytes and the items and customers that changed since they were last seen, and writes the
+ * records to the file in the order they were made, so recording never waits for the disk on the recording threads. If
+ * a ring is full, what does not fit is dropped and counted.
+ * Records are ordered by a ticket each one takes; a read is ordered after the records whose tickets were taken before
+ * it. Reads and records of different threads that happened at the same time are written in either order.
+ * @note Every function is thread-safe. The record functions return immediately if no recording is running.
+ */
+class Recorder {
+public:
+    // The bytes each recording thread can queue
+    static constexpr size_t RING_BYTES = 1 << 22;
+    static constexpr int FLUSH_MILLIS = 5;
+    // The size of the pages RecordPage takes
+    static constexpr size_t PAGE_SIZE = 4096;
+    // Memory is compared and recorded in aligned chunks of this many bytes
+    static constexpr size_t CHUNK_SIZE = 32;
+    // Longer reads are queued in parts of this many bytes
+    static constexpr size_t MAX_READ_SIZE = 1024;
+    static constexpr size_t MAX_PRODUCERS = 16;
+
+    static bool Start(const std::string &filename);
+
+    static void Stop();
+
+    static bool IsRecording();
+
+    static void RecordBreakpoint(const BreakpointEvent &event);
+
+    static void RecordMemory(DWORD address, const void *buffer, SIZE_T size);
+
+    static uint32_t RecordPage(DWORD address, const BYTE *bytes, BYTE *copy, uint32_t copySession);
+
+    static void RecordSnapshot(const WorldSnapshot &snapshot);
+
+    static void RecordAction(const ActuatorCommand &command);
+
+    static void RecordTick(uint64_t version);
+
+    static uint64_t GetRecordCount();
+
+    static uint64_t GetDroppedCount();
+
+    static uint64_t GetWrittenCount();
+
+    static bool Load(const std::string &filename, std::vector<SessionRecord> &records);
+
+private:
+    static constexpr size_t PAGE_CHUNKS = PAGE_SIZE / CHUNK_SIZE;
+
+    // The memory the recording has seen, to find the bytes a read changed
+    struct ShadowPage {
+        BYTE data[PAGE_SIZE];
+        // One bit per byte, one word per chunk
+        uint32_t known[PAGE_CHUNKS];
+        // The page as the page cache last fetched it, which the changed chunks it queues apply to
+        BYTE fetched[PAGE_SIZE];
+        // One bit per chunk a read that bypassed the cache changed since then
+        uint64_t diverged[PAGE_CHUNKS / 64];
+    };
+
+    struct ItemState {
+        DWORD address;
+        ItemRecord record;
+    };
+
+    struct CustomerState {
+        DWORD address;
+        CustomerRecord record;
+    };
+
+    enum class EntryKind : uint8_t {
+        // A record
+        Record,
+        // The bytes of a read
+        Read,
+        // The chunks of a fetched page that changed: one bit per chunk, then the chunks that are set
+        Page,
+        // The items and customers of a snapshot: a SnapshotHeader, then the ItemStates and the CustomerStates
+        Snapshot
+    };
+
+    // What a recording thread queues. The bytes it describes follow it, padded to 8 bytes
+    struct Entry {
+        // The ticket of a record or a snapshot, or the number of tickets taken before a read
+        uint64_t order;
+        DWORD address;
+        uint16_t size;
+        // The recording the entry belongs to
+        uint8_t session;
+        EntryKind kind;
+    };
+
+    struct SnapshotHeader {
+        int64_t timeNanos;
+        uint32_t itemCount;
+        uint32_t customerCount;
+    };
+
+    // Larger snapshots are dropped
+    static constexpr size_t MAX_SNAPSHOT_SIZE = 16384;
+
+    // The ring of one recording thread. When the thread exits, another one takes it over
+    struct Producer {
+        Producer() : ring(RING_BYTES, sizeof(Entry) + std::max(MAX_READ_SIZE, MAX_SNAPSHOT_SIZE)) {}
+
+        ByteRing ring;
+        std::atomic<bool> owned{true};
+    };
+
+    static Producer *GetProducer();
+
+    static Entry *Reserve(size_t size);
+
+    static void Commit(const Entry *entry);
+
+    static void Push(const SessionRecord &record, uint32_t current);
+
+    static SessionRecord MakeRecord(RecordKind kind, DWORD address, int64_t timeNanos);
+
+    static size_t GetEntrySize(const Entry &entry);
+
+    static void FlushThread();
+
+    static void Drain(bool stopping);
+
+    static ShadowPage &GetShadowPage(uint64_t base);
+
+    static void Compare(DWORD address, const BYTE *bytes, SIZE_T size);
+
+    static void ComparePage(DWORD address, const uint8_t *bytes);
+
+    static void CompareSnapshot(const uint8_t *bytes);
+
+    static void Write(const SessionRecord &record);
+
+    static void WriteBatch();
+
+    // The current recording, numbered from 1 to 255, or 0 if none is running
+    static std::atomic<uint32_t> session;
+    static uint32_t lastSession;
+    static std::atomic<uint64_t> ticketCount;
+    static std::unique_ptr<Producer> producers[MAX_PRODUCERS];
+    static std::atomic<size_t> producerCount;
+    static std::mutex producersMutex;
+    static thread_local Producer *localProducer;
+    // The game state version of the last snapshot queued, and its recording. Only the publishing thread uses these
+    static uint64_t snapshotVersion;
+    static uint32_t snapshotSession;
+    // Only the flush thread uses these
+    static std::vector<ItemState> items;
+    static std::vector<ItemState> nextItems;
+    static std::vector<CustomerState> customers;
+    static std::vector<CustomerState> nextCustomers;
+    static std::unordered_map<DWORD, std::unique_ptr<ShadowPage>> shadow;
+    static ShadowPage *lastPage;
+    static uint64_t lastPageBase;
+    static uint64_t nextTicket;
+    static uint64_t stalledTicket;
+    static int64_t lastTimeNanos;
+    static std::vector<SessionRecord> batch;
+    static std::ofstream file;
+    static std::thread thread;
+    static std::mutex flushMutex;
+    static std::condition_variable flushSignal;
+    // The records the flush thread made from pages, reads and snapshots, and the snapshots, which took a ticket each
+    static std::atomic<uint64_t> comparedCount;
+    static std::atomic<uint64_t> snapshotCount;
+    static std::atomic<uint64_t> droppedCount;
+    static std::atomic<uint64_t> writtenCount;
+};
+
+/**
+ * Passes reads and writes through to another ProcessMemory.
+ * Marked as recorded, it records the reads of a memory that is also read without recording, such as the backend of a
+ * page cache, which records the pages it fetches itself.
+ */
+class RecordingProcessMemory : public ProcessMemory {
+public:
+    explicit RecordingProcessMemory(ProcessMemory &backend) : backend(backend) {}
+
+protected:
+    bool ReadImpl(DWORD address, LPVOID buffer, SIZE_T size) override;
+
+    bool WriteImpl(DWORD address, LPCVOID buffer, SIZE_T size) override;
+
+private:
+    ProcessMemory &backend;
+};
+
+#endif //BS3BOT_RECORDER_H
@@ -0,0 +1,104 @@
+#ifndef BS3BOT_REPLAYER_H
+#define BS3BOT_REPLAYER_H
+
+#include <Platform.h>
+#include <Actuator.h>
+#include <LatencyHistogram.h>
+#include <ProcessMemory.h>
+#include <Recorder.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * What a replay did, and how its planner runs compared to the recorded ones.
+ */
+struct ReplayStats {
+    uint64_t breakpoints = 0;
+    uint64_t memoryRecords = 0;
+    uint64_t ticks = 0;
+    uint64_t recordedActions = 0;
+    uint64_t replayedActions = 0;
+    // Replayed commands equal to the recorded command at the same position of their tick
+    uint64_t matchedActions = 0;
+    uint64_t divergentTicks = 0;
+    // The first planner run whose commands differ from the recording, or -1 if none does
+    int64_t firstDivergentTick = -1;
+    int64_t firstDivergenceNanos = 0;
+    // Wall clock time of the replay
+    int64_t wallNanos = 0;
+    // Wall clock time of the planner runs, capturing included
+    LatencyHistogram tickLatency;
+};
+
+/**
+ * Plays a recorded session back through the breakpoint handlers, GameState and the planner, without the game.
+ * Memory records build an image of the game's memory that serves the reads of the handlers and the planner.
+ * Breakpoint records are dispatched at their recorded times, and each Tick record runs the planner like the bot's main
+ * loop did: it captures a snapshot if the game changed, then plans. The commands it submits are compared to the
+ * recorded ones of that tick, so a replay shows whether a change to the planner changed what it does.
+ * Time is the recorded time: the replayer replaces the clock of ChangeSignal while attached, and can either replay as
+ * fast as possible or sleep to keep the recorded pace.
+ * A session recorded from the simulator replays exactly. One recorded from the game replays approximately: the bot
+ * captured snapshots on its own thread, while the replay captures them when the planner runs, and bytes the bot never
+ * read are zero rather than unreadable.
+ * @note Only one replayer or simulator can be attached at a time, and everything runs on the thread that attached it.
+ */
+class Replayer {
+public:
+    // The image is built from blocks of this size, mapped when a memory record first touches them
+    static const DWORD BLOCK_SIZE = 0x10000;
+
+    explicit Replayer(std::vector<SessionRecord> records);
+
+    ~Replayer();
+
+    Replayer(const Replayer &) = delete;
+
+    Replayer &operator=(const Replayer &) = delete;
+
+    bool Attach();
+
+    void Detach();
+
+    bool Run(double speed);
+
+    void Send(const ActuatorCommand &command);
+
+    const ReplayStats &GetStats() const;
+
+    static int64_t NowNanos();
+
+private:
+    void Apply(const SessionRecord &record);
+
+    size_t ApplyMemory(size_t index, bool wholeTick);
+
+    size_t Tick(size_t index);
+
+    std::vector<SessionRecord> records;
+    ReplayStats stats;
+    ImageProcessMemory *image = nullptr;
+    bool attached = false;
+    int64_t nowNanos = 0;
+    std::vector<ActuatorCommand> sent;
+};
+
+/**
+ * Hands the planner's input to a replayer, which compares it to the recording.
+ * The replayer flushes it after each planner run; it is never started.
+ */
+class ReplayActuator : public Actuator {
+public:
+    explicit ReplayActuator(Replayer &replayer) : replayer(replayer) {}
+
+    ~ReplayActuator() override;
+
+protected:
+    bool SendBatch(const ActuatorCommand *commands, size_t count) override;
+
+private:
+    Replayer &replayer;
+};
+
+#endif //BS3BOT_REPLAYER_H
@@ -0,0 +1,80 @@
+#ifndef BS3BOT_RINGBUFFER_H
+#define BS3BOT_RINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * A bounded, preallocated single-producer single-consumer queue.
+ * Push and Pop never allocate or lock; each side only writes its own index, so the producer and the consumer can run
+ * on different threads without further synchronization.
+ * @tparam T The element type. Elements are copied in and out, so it should be small and trivially copyable.
+ * @tparam Capacity The number of slots. Must be a power of two.
+ */
+template<typename T, size_t Capacity>
+class RingBuffer {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    /**
+     * Appends an element. Must only be called by the producer.
+     * @param value The element.
+     * @return @c false if the queue is full.
+     */
+    bool Push(const T &value) {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - cachedHead == Capacity) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (tail - cachedHead == Capacity) {
+                return false;
+            }
+        }
+        slots[tail & (Capacity - 1)] = value;
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes the oldest element. Must only be called by the consumer.
+     * @param value (out) The element.
+     * @return @c false if the queue is empty.
+     */
+    bool Pop(T &value) {
+        size_t head = this->head.load(std::memory_order_relaxed);
+        if (head == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (head == cachedTail) {
+                return false;
+            }
+        }
+        value = slots[head & (Capacity - 1)];
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Returns the number of queued elements.
+     * @return The number of elements.
+     * @note The result is only a snapshot if the other side is running concurrently.
+     */
+    size_t Size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    bool IsEmpty() const {
+        return Size() == 0;
+    }
+
+private:
+    // The indices live on separate cache lines so the producer and the consumer do not invalidate each other's line.
+    // Each side keeps the last index it saw of the other side next to its own, and only reloads it when the queue
+    // looks full or empty, so a busy queue does not move the other side's line on every call.
+    alignas(64) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+    alignas(64) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+    alignas(64) T slots[Capacity];
+};
+
+#endif //BS3BOT_RINGBUFFER_H
@@ -0,0 +1,125 @@
+#ifndef BS3BOT_SCHEDULER_H
+#define BS3BOT_SCHEDULER_H
+
+#include <Platform.h>
+#include <IngredientCounts.h>
+#include <World.h>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Identifies an order across snapshots: the customer that placed it and the item it asks for.
+ */
+struct OrderKey {
+    DWORD customer = 0;
+    DWORD item = 0;
+
+    bool operator==(const OrderKey &other) const {
+        return customer == other.customer && item == other.item;
+    }
+
+    bool operator!=(const OrderKey &other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * An order in a plan and the conveyor items reserved for it.
+ */
+struct ScheduledOrder {
+    // Index into WorldSnapshot::orders of the snapshot the plan was made from
+    int order;
+    OrderKey key;
+    // Range of SchedulePlan::items and SchedulePlan::ingredients, in click order
+    int firstItem;
+    int itemCount;
+};
+
+/**
+ * The orders to build, in the order to build them.
+ * Every ingredient of a scheduled order has a reserved conveyor item, except for the committed order, whose items
+ * are 0 where no conveyor item could be reserved.
+ */
+struct SchedulePlan {
+    uint64_t version = 0;
+    std::vector<ScheduledOrder> orders;
+    std::vector<DWORD> items;
+    std::vector<int> ingredients;
+    // Orders the conveyor could complete that were left out because their customer would leave first
+    int droppedCount = 0;
+};
+
+/**
+ * Assigns conveyor items to pending orders.
+ * Orders compete for the same items, so they are matched as a whole: every scheduled order gets its own items, and
+ * the set of orders is chosen to complete as many orders as possible. Orders are built earliest deadline first; when
+ * not all of them can finish before their customers leave, the longest builds are dropped so the most orders still
+ * make it. The order the planner is building is committed and keeps its items across re-plans.
+ */
+class OrderScheduler {
+public:
+    // Time per re-plan spent improving the greedy assignment
+    static const int64_t BUDGET_NANOS = 200000;
+    // Frames the planner takes per ingredient click and for the delivery click
+    static const int FRAMES_PER_INGREDIENT = 3;
+    static const int DELIVERY_FRAMES = 3;
+
+    bool Update(const WorldSnapshot &world, const OrderKey *committed, const std::vector<int> &committedIngredients);
+
+    const SchedulePlan &GetPlan() const;
+
+    static OrderKey GetKey(const OrderEntry &order);
+
+    static uint64_t GetBuildFrames(int ingredientCount);
+
+    uint64_t GetPlanCount() const;
+
+    uint64_t GetReuseCount() const;
+
+    int64_t GetLastPlanNanos() const;
+
+private:
+    struct Candidate {
+        int order;
+        int firstIngredient;
+        int ingredientCount;
+        uint64_t deadline;
+    };
+
+    void IndexConveyor(const WorldSnapshot &world);
+
+    DWORD Reserve(const WorldSnapshot &world, int ingredient, const std::vector<DWORD> &preferred);
+
+    void Assign(const WorldSnapshot &world, int64_t deadline);
+
+    void Materialize(const WorldSnapshot &world, uint64_t startFrame);
+
+    SchedulePlan plan;
+    OrderKey lastCommitted;
+    std::vector<int> lastCommittedIngredients;
+    bool hasPlan = false;
+
+    // Simple conveyor rows bucketed by ingredient id, and which rows are reserved
+    std::vector<int> bucketStart;
+    std::vector<int> bucketRows;
+    std::vector<int> bucketFill;
+    std::vector<uint8_t> reserved;
+
+    // Orders that could be scheduled, their ingredient lists and requirement rows
+    std::vector<Candidate> candidates;
+    std::vector<int> candidateIngredients;
+    std::vector<uint8_t> assigned;
+    std::vector<int> sequence;
+    std::vector<int> kept;
+    std::vector<uint64_t> orderDeadlines;
+    IngredientCounts available;
+    std::vector<OrderKey> previousOrders;
+    std::vector<DWORD> previousItems;
+    std::vector<int> ingredientBuffer;
+
+    uint64_t planCount = 0;
+    uint64_t reuseCount = 0;
+    int64_t lastPlanNanos = 0;
+};
+
+#endif //BS3BOT_SCHEDULER_H
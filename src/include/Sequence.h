@@ -0,0 +1,122 @@
+#ifndef BS3BOT_SEQUENCE_H
+#define BS3BOT_SEQUENCE_H
+
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+class SequenceRunner;
+
+/**
+ * A sequence of actions written as a coroutine. It runs on a SequenceRunner, which resumes it when what it awaits
+ * happens: a condition becoming true (WaitUntil) or a point in time (WaitFor).
+ * A sequence starts suspended and only runs once spawned on a runner.
+ */
+class Sequence {
+public:
+    struct promise_type {
+        SequenceRunner *runner = nullptr;
+        // What the sequence waits for: a condition, a time, or both, whichever comes first
+        std::function<bool()> condition;
+        int64_t deadlineNanos = 0;
+        // Whether the last wait ended because its condition became true
+        bool conditionMet = false;
+        std::shared_ptr<bool> finished = std::make_shared<bool>(false);
+
+        Sequence get_return_object();
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+
+        void unhandled_exception();
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    explicit Sequence(Handle handle) : handle(handle) {}
+
+    Sequence(Sequence &&other) noexcept;
+
+    Sequence &operator=(Sequence &&other) noexcept;
+
+    Sequence(const Sequence &) = delete;
+
+    Sequence &operator=(const Sequence &) = delete;
+
+    ~Sequence();
+
+private:
+    friend class SequenceRunner;
+
+    Handle handle;
+};
+
+/**
+ * Suspends a sequence until a condition is true, or until a timeout. Resumes to whether the condition became true.
+ * The condition is checked whenever the runner runs, so it should be cheap.
+ * @note Conditions written as lambdas in the co_await expression must capture only trivially destructible values by
+ * copy, and everything else by reference: GCC 12 destroys the captures of such temporaries twice.
+ */
+struct WaitUntil {
+    static const int64_t NO_TIMEOUT = std::numeric_limits<int64_t>::max();
+
+    explicit WaitUntil(std::function<bool()> condition, int64_t timeoutNanos = NO_TIMEOUT)
+            : condition(std::move(condition)), timeoutNanos(timeoutNanos) {}
+
+    bool await_ready() { return condition(); }
+
+    void await_suspend(Sequence::Handle awaiting);
+
+    bool await_resume() const { return !handle || handle.promise().conditionMet; }
+
+    std::function<bool()> condition;
+    int64_t timeoutNanos;
+    Sequence::Handle handle;
+};
+
+/**
+ * Suspends a sequence for a duration, measured from the runner's current time.
+ */
+struct WaitFor {
+    explicit WaitFor(int64_t nanos) : nanos(nanos) {}
+
+    bool await_ready() const { return nanos <= 0; }
+
+    void await_suspend(Sequence::Handle awaiting);
+
+    void await_resume() const {}
+
+    int64_t nanos;
+};
+
+/**
+ * Runs sequences. Each call to Run resumes every sequence whose wait is over, once, so several sequences are in flight
+ * at the same time and waits end at the first run at or after their deadline rather than on a fixed tick.
+ * @note A runner and its sequences belong to one thread.
+ */
+class SequenceRunner {
+public:
+    static const int64_t NO_DEADLINE = std::numeric_limits<int64_t>::max();
+
+    std::shared_ptr<const bool> Spawn(Sequence sequence);
+
+    int64_t Run(int64_t now);
+
+    void Clear();
+
+    size_t GetActiveCount() const;
+
+    int64_t GetNowNanos() const;
+
+private:
+    std::vector<Sequence> sequences;
+    int64_t nowNanos = 0;
+};
+
+#endif //BS3BOT_SEQUENCE_H
@@ -0,0 +1,220 @@
+#ifndef BS3BOT_SIMULATOR_H
+#define BS3BOT_SIMULATOR_H
+
+#include <Platform.h>
+#include <Actuator.h>
+#include <BreakpointEvent.h>
+#include <ProcessMemory.h>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+/**
+ * The parameters of a simulated game. Positions are game positions, times are frames unless noted otherwise.
+ */
+struct SimulatorConfig {
+    uint32_t seed = 1;
+    int64_t framePeriodNanos = 16666667;
+    // The conveyor brings an item every spawnFrames frames; items move right and fall off the end
+    int spawnFrames = 30;
+    float conveyorSpeed = 1.5f;
+    float conveyorY = 480.0f;
+    float conveyorEndX = 800.0f;
+    // The number of conveyor ingredients in the level, drawn from the item catalog
+    int menuSize = 12;
+    // The share of spawned items that an open order needs; the rest are drawn from the menu
+    double demandShare = 0.6;
+    int numSlots = 4;
+    // The mean number of frames until an empty slot gets a new customer
+    int arrivalFrames = 300;
+    int patienceFrames = 1800;
+    int maxOrders = 2;
+    int maxFillings = 3;
+    // The share of orders that are a single ingredient rather than a stack
+    double singleItemShare = 0.15;
+    // Time from sending a command to the game acting on it, in nanoseconds
+    int64_t inputLatencyNanos = 20000000;
+    float clickRadius = 24.0f;
+};
+
+/**
+ * What happened in a simulated game.
+ */
+struct SimulatorStats {
+    uint64_t frames = 0;
+    uint64_t itemsSpawned = 0;
+    uint64_t itemsDropped = 0;
+    uint64_t customersArrived = 0;
+    uint64_t customersServed = 0;
+    uint64_t customersLost = 0;
+    uint64_t ordersServed = 0;
+    uint64_t wrongDeliveries = 0;
+    uint64_t discards = 0;
+    uint64_t clicks = 0;
+    // Clicks that hit no item, and clicks on an item the tray did not take
+    uint64_t missedClicks = 0;
+    uint64_t rejectedClicks = 0;
+
+    double GetOrdersPerMinute(int64_t durationNanos) const;
+};
+
+/**
+ * A headless Burger Shop: a conveyor, customers with orders and the tray, advanced in simulated time.
+ * The game lives in a synthetic image of the game's memory, laid out like the real game's objects, and hits the bot's
+ * breakpoints, whose handlers read the image like they read the game. The bot's planner runs against it unchanged: it
+ * reads WorldReader snapshots, and its input reaches the simulator through a SimulatorActuator.
+ * Time is virtual: the simulator replaces the clock of ChangeSignal while attached, so a game runs as fast as the
+ * planner can keep up with.
+ * @note Only one simulator can be attached at a time, and everything runs on the thread that attached it.
+ */
+class Simulator {
+public:
+    // The first simulated time; 0 means "never" to the clocks of the bot
+    static const int64_t START_NANOS = 1000000000;
+    // Where a click throws away the tray, like the planner does when it gives up
+    static constexpr float TRASH_X = 400.0f;
+    static constexpr float TRASH_Y = 120.0f;
+    static constexpr float TRASH_RADIUS = 40.0f;
+    static const int MAX_TRAY_ITEMS = 8;
+    // Served customers stay this many frames before they walk off
+    static const int SERVED_FRAMES = 30;
+
+    explicit Simulator(const SimulatorConfig &config);
+
+    ~Simulator();
+
+    Simulator(const Simulator &) = delete;
+
+    Simulator &operator=(const Simulator &) = delete;
+
+    bool Attach();
+
+    void Detach();
+
+    void Run(int64_t durationNanos);
+
+    void AdvanceTo(int64_t timeNanos);
+
+    void Send(const ActuatorCommand &command);
+
+    int64_t GetNowNanos() const;
+
+    int64_t GetNextEventNanos() const;
+
+    const SimulatorStats &GetStats() const;
+
+    const std::vector<int> &GetMenu() const;
+
+    static int64_t NowNanos();
+
+private:
+    struct BeltItem {
+        DWORD address;
+        int ingredient;
+        float x;
+    };
+
+    struct Order {
+        // The recipe object first, then its sub-items
+        std::vector<DWORD> objects;
+        std::vector<int> ingredients;
+        bool complete;
+    };
+
+    struct SimCustomer {
+        DWORD address;
+        uint64_t leaveFrame;
+        bool served;
+        std::vector<Order> orders;
+    };
+
+    struct Slot {
+        bool occupied;
+        uint64_t nextArrival;
+        SimCustomer customer;
+    };
+
+    struct PendingInput {
+        int64_t timeNanos;
+        ActuatorCommand command;
+    };
+
+    void ChooseMenu();
+
+    void Frame();
+
+    void Spawn();
+
+    void Arrive(Slot &slot);
+
+    void Leave(Slot &slot);
+
+    void Apply(const ActuatorCommand &command);
+
+    void Click(float x, float y);
+
+    void Deliver();
+
+    void ClearTray();
+
+    bool TrayAccepts(int ingredient) const;
+
+    DWORD AllocateItem();
+
+    DWORD AllocateCustomer();
+
+    DWORD WriteSimpleItem(int ingredient, float x, float y, int conveyorIndex);
+
+    bool WriteRecipe(Order &order);
+
+    void WriteOrders(const SimCustomer &customer);
+
+    void WritePosition(DWORD address, float x, float y);
+
+    void Free(DWORD address);
+
+    void Hit(BreakpointId id, DWORD object);
+
+    BYTE *At(DWORD address, SIZE_T size);
+
+    SimulatorConfig config;
+    SimulatorStats stats;
+    std::mt19937 rng;
+    ImageProcessMemory *image = nullptr;
+    bool attached = false;
+    int64_t nowNanos = START_NANOS;
+    int64_t nextFrameNanos = START_NANOS;
+    uint64_t frame = 0;
+    std::vector<int> menu;
+    std::vector<int> menuBases;
+    std::vector<int> menuFillings;
+    std::vector<BeltItem> belt;
+    int nextConveyorIndex = 0;
+    std::vector<Slot> slots;
+    int nextCustomerId = 1;
+    std::vector<DWORD> tray;
+    std::vector<int> trayIngredients;
+    std::deque<PendingInput> inputs;
+    DWORD nextItemSlot = 0;
+    DWORD nextCustomerSlot = 0;
+};
+
+/**
+ * Hands the planner's input to a simulator instead of the game window.
+ * The simulator flushes it after each planner run; it is never started.
+ */
+class SimulatorActuator : public Actuator {
+public:
+    explicit SimulatorActuator(Simulator &simulator) : simulator(simulator) {}
+
+    ~SimulatorActuator() override;
+
+protected:
+    bool SendBatch(const ActuatorCommand *commands, size_t count) override;
+
+private:
+    Simulator &simulator;
+};
+
+#endif //BS3BOT_SIMULATOR_H
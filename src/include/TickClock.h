@@ -0,0 +1,69 @@
+#ifndef BS3BOT_TICKCLOCK_H
+#define BS3BOT_TICKCLOCK_H
+
+#include <LatencyHistogram.h>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Follows the game's frame cadence from the times of a breakpoint in its update loop, and decides on which frames the
+ * bot acts.
+ * The frame period is a moving average of the observed intervals, the jitter a moving average of their deviation from
+ * it. The predicted time of the next frame is advanced by a period every frame and pulled towards the observed frames,
+ * so it does not drift away from the game when the period estimate is slightly off.
+ * @note OnFrame must only be called from one thread. Everything else may be called from any thread.
+ */
+class TickClock {
+public:
+    // The cadence assumed until frames are observed
+    static const int64_t DEFAULT_PERIOD_NANOS = 16666667;
+    // A gap between frames longer than this is a stall of the game, not a slow frame
+    static const int64_t STALL_NANOS = 250000000;
+    // Missed frames are stood in for by predicted ones for this many frame periods before the game counts as stalled
+    static const int MAX_COASTED_FRAMES = 3;
+    static constexpr double DEFAULT_ACT_FRACTION = 1.0;
+
+    bool OnFrame(int64_t timestampNanos);
+
+    void SetActFraction(double fraction);
+
+    int64_t GetDeadlineNanos(int64_t nowNanos) const;
+
+    int64_t GetNextFrameNanos() const;
+
+    int64_t GetFramePeriodNanos() const;
+
+    int64_t GetJitterNanos() const;
+
+    uint64_t GetFrameCount() const;
+
+    uint64_t GetTickCount() const;
+
+    uint64_t GetMissedFrameCount() const;
+
+    uint64_t GetStallCount() const;
+
+    const LatencyHistogram &GetFrameIntervals() const;
+
+    void Print(std::ostream &out) const;
+
+    void Reset();
+
+private:
+    std::atomic<double> actFraction{DEFAULT_ACT_FRACTION};
+    std::atomic<int64_t> lastFrameNanos{0};
+    std::atomic<int64_t> nextFrameNanos{0};
+    std::atomic<int64_t> periodNanos{DEFAULT_PERIOD_NANOS};
+    std::atomic<int64_t> jitterNanos{0};
+    std::atomic<uint64_t> frameCount{0};
+    std::atomic<uint64_t> tickCount{0};
+    std::atomic<uint64_t> missedFrameCount{0};
+    std::atomic<uint64_t> stallCount{0};
+    // Fraction of a tick owed to the frames not acted on yet
+    double actCredit = 0.0;
+    // Consecutive frames that came several periods after the previous one
+    int gapRun = 0;
+    LatencyHistogram frameIntervals;
+};
+
+#endif //BS3BOT_TICKCLOCK_H
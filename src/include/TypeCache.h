@@ -0,0 +1,52 @@
+#ifndef BS3BOT_TYPECACHE_H
+#define BS3BOT_TYPECACHE_H
+
+#include <Platform.h>
+#include <ProcessMemory.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * The kind of a game object, as determined from its vtable.
+ * @note Customers share the signature of complex items, so a customer's vtable classifies as @c Complex.
+ */
+enum class ObjectKind {
+    Unknown,
+    Simple,
+    Complex
+};
+
+/**
+ * Maps vtable pointers to object kinds.
+ * Classifying a vtable the first time costs two dependent reads (the first virtual function and its code signature);
+ * after that a type check only needs the object header and a lookup.
+ * @note This class is thread-safe.
+ */
+class TypeCache {
+public:
+    static const int SIMPLE_ITEM_SIGNATURE = 1317794187;
+    static const int COMPLEX_ITEM_SIGNATURE = 113766795;
+
+    static ObjectKind Classify(ProcessMemory &memory, DWORD vtable);
+
+    static ObjectKind ClassifyObject(ProcessMemory &memory, DWORD address);
+
+    static void Invalidate();
+
+    static uint64_t GetHits();
+
+    static uint64_t GetMisses();
+
+private:
+    static const size_t MAX_UNKNOWN_ENTRIES = 1024;
+
+    static std::mutex mutex;
+    static std::unordered_map<DWORD, ObjectKind> kinds;
+    static size_t unknownEntries;
+    static std::atomic<uint64_t> hits;
+    static std::atomic<uint64_t> misses;
+};
+
+#endif //BS3BOT_TYPECACHE_H
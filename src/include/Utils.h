@@ -14,13 +14,8 @@
 #include <fstream>
 #include <iostream>
 #include <filesystem>
-
-struct Node {
-public:
-    DWORD prev;
-    DWORD next;
-    DWORD content;
-};
+#include <ProcessMemory.h>
+#include <BreakpointHandlers.h>
 
 class Utils {
 public:
@@ -38,7 +33,7 @@ public:
 
     static bool TryFindFood(HANDLE hProcess, DWORD startAddress, int depth, int width, std::list<std::string> &path);
 
-    static bool IsNotItem(HANDLE hProcess, DWORD address, const Node &node);
+    static bool IsNotItem(ProcessMemory &memory, DWORD address, const Node &node);
 
     static void RecursivePrint(DWORD address, int depth, int items);
 
@@ -0,0 +1,110 @@
+#ifndef BS3BOT_WORLD_H
+#define BS3BOT_WORLD_H
+
+#include <Platform.h>
+#include <Content.h>
+#include <TypeCache.h>
+#include <ConveyorTable.h>
+#include <IngredientCounts.h>
+#include <ChangeSignal.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class PatienceTracker;
+
+/**
+ * An item ordered by a customer, together with the ingredients of the ordered item.
+ */
+struct OrderEntry {
+    ItemInfo info;
+    int firstIngredient;
+    int ingredientCount;
+    // The address of the customer that placed the order
+    DWORD customer;
+};
+
+/**
+ * A customer and the range of its orders.
+ */
+struct CustomerEntry {
+    DWORD address;
+    int id;
+    int firstOrder;
+    int orderCount;
+    // The frame the customer was first seen, and the frame it is expected to leave if not served
+    uint64_t arrivalFrame;
+    uint64_t deadlineFrame;
+};
+
+/**
+ * An immutable, already decoded view of the game at one frame.
+ * Variable-length parts (sub-items, orders, ingredients) are stored in shared arrays and referenced by ranges, so a
+ * snapshot can be rebuilt without allocating once its buffers have grown.
+ */
+struct WorldSnapshot {
+    uint64_t frame = 0;
+    // Steady clock time the capture started
+    int64_t timeNanos = 0;
+    // GameState version after this snapshot was captured
+    uint64_t version = 0;
+    // GameState wake count after this snapshot was captured, which also advances on the frames the bot acts on
+    uint64_t wakes = 0;
+    float bbPercent = 0.0f;
+    ConveyorTable conveyor;
+    std::vector<CustomerEntry> customers;
+    std::vector<OrderEntry> orders;
+    std::vector<int> ingredients;
+    // The simple conveyor items per ingredient id, and what each order needs and lacks, indexed like orders
+    IngredientCounts conveyorCounts;
+    std::vector<IngredientCounts> requirements;
+    std::vector<int> missingIngredients;
+
+    void Clear();
+};
+
+/**
+ * Builds a WorldSnapshot on a background thread and publishes it with an atomic pointer swap.
+ * A snapshot is built every frame, and also as soon as the game state changes.
+ */
+class WorldReader {
+public:
+    static const int FRAME_MILLIS = 17;
+
+    static void Start();
+
+    static void Stop();
+
+    static std::shared_ptr<const WorldSnapshot> GetSnapshot();
+
+    static uint64_t WaitForSnapshot(uint64_t count, int64_t deadlineNanos);
+
+    static void Capture(WorldSnapshot &snapshot);
+
+    static void Publish();
+
+    static bool PublishIfStale();
+
+    static const PatienceTracker &GetPatience();
+
+    static void Reset();
+
+private:
+    static void ReaderThread();
+
+    static std::shared_ptr<WorldSnapshot> current;
+    static std::shared_ptr<WorldSnapshot> spare;
+    static std::atomic<bool> running;
+    static std::thread thread;
+    static uint64_t frame;
+    static int64_t startNanos;
+    static PatienceTracker patience;
+    // The level the patience estimate was learned in, as counted by GameState
+    static uint64_t level;
+    // Advances whenever a snapshot is published
+    static ChangeSignal publishSignal;
+};
+
+#endif //BS3BOT_WORLD_H
@@ -4,11 +4,18 @@
 #include <atomic>
 #include <Managers.h>
 #include <Debugging.h>
+#include <World.h>
+#include <ChangeSignal.h>
+#include <LatencyHistogram.h>
+#include <Recorder.h>
+#include <algorithm>
+#include <cstdlib>
 
 #define BOTMODE
 
-// Main function
-int main() {
+// Main function. The optional arguments are the share of the game's frames the bot acts on, 1 by default, and a file to
+// record the session to.
+int main(int argc, char **argv) {
 
     std::cout << "Starting BS3 Memory Reader" << std::endl;
 
@@ -19,16 +26,49 @@ int main() {
         return -1;
     }
 
-    std::thread debugThread(Debugging::DebugLoop);
-    // Main loop
-    long timeMillis = 0;
-    bool running = true;
+    if (argc > 1) {
+        GameState::GetTickClock().SetActFraction(std::atof(argv[1]));
+    }
+    if (argc > 2 && !Recorder::Start(argv[2])) {
+        return -1;
+    }
+
+    std::atomic<bool> running{true};
+    std::thread debugThread([&running]() {
+        Debugging::DebugLoop();
+        running = false;
+    });
+    // Main loop: the planner sleeps until a snapshot is published, on every acted frame and game state change, or until
+    // the time it asked to run again
+    LatencyHistogram reactionLatency;
+    int64_t startNanos = ChangeSignal::NowNanos();
+    int64_t busyNanos = 0;
+    int64_t wakeNanos = startNanos;
+    uint64_t published = 0;
+    uint64_t version = GameState::GetStateVersion();
     while (running) {
-        long currentTimeMillis = GetTickCount();
-        if (currentTimeMillis - timeMillis > 17) {
-            GameState::PerformActions();
-            timeMillis = currentTimeMillis;
+        int64_t deadlineNanos = GameState::PerformActions();
+        busyNanos += ChangeSignal::NowNanos() - wakeNanos;
+        uint64_t seen = published;
+        published = WorldReader::WaitForSnapshot(seen, deadlineNanos);
+        wakeNanos = ChangeSignal::NowNanos();
+        // Snapshots of frames the game state did not change in have no change to react to
+        uint64_t changed = GameState::GetStateVersion();
+        if (published != seen && changed != version) {
+            reactionLatency.Record(std::max<int64_t>(wakeNanos - GameState::GetChangeNanos(), 0));
+        }
+        version = changed;
+    }
+    debugThread.join();
+    if (Recorder::IsRecording()) {
+        Recorder::Stop();
+        std::cout << "Recorded " << Recorder::GetWrittenCount() << " records to " << argv[2] << std::endl;
+        if (Recorder::GetDroppedCount() > 0) {
+            std::cout << "Warning: Dropped " << Recorder::GetDroppedCount() << " records." << std::endl;
         }
     }
+    reactionLatency.Print(std::cout, "Planner reaction latency");
+    std::cout << "Planner busy " << 100.0 * busyNanos / std::max<int64_t>(ChangeSignal::NowNanos() - startNanos, 1)
+              << "% of the time" << std::endl;
     return 0;
-}
\ No newline at end of file
+}